@@ -1,28 +1,123 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 #include <objc/runtime.h>
 #include <objc/message.h>
 
-typedef struct 
+typedef struct
 {
     const char*     pName;
     const char*     pSignature;
     void*           pFunctionPointer;
 } c_ocoa_class_definition_method_t;
 
+//FK: For static method tables, eg:
+//    static const c_ocoa_class_definition_method_t methods[] = {
+//        C_OCOA_CLASS_METHOD( "drawRect:", my_view_draw_rect, "v@:{CGRect={CGPoint=dd}{CGSize=dd}}" ),
+//    };
+#define C_OCOA_CLASS_METHOD( name, function, signature ) { name, signature, (void*)function }
+
+//FK: Linear allocator for class definitions, the memory is provided by the caller.
+//    Everything that got allocated from the arena is released at once by resetting the arena
+//    (or by releasing the memory of the arena).
+typedef struct
+{
+    unsigned char*  pMemory;
+    size_t          capacityInBytes;
+    size_t          usedInBytes;
+} c_ocoa_class_arena_t;
+
 typedef struct
 {
     Class                               pObjcClass;
     Class                               pParentClass;
     const char*                         pName;
+    c_ocoa_class_arena_t*               pArena; //FK: NULL if the definition has been allocated via malloc
     c_ocoa_class_definition_method_t*   pMethods;
+    const c_ocoa_class_definition_method_t* pLazyMethods;   //FK: installed on first use (see c_ocoa_set_class_definition_lazy_methods())
+    size_t                              payloadSizeInBytes;
+    size_t                              payloadAlignment;
+    ptrdiff_t*                          pPayloadOffset; //FK: caller provided, receives the offset of the payload ivar when the class gets finished
     unsigned int                        methodCount;
     unsigned int                        methodCapacity;
+    unsigned int                        lazyMethodCount;
     unsigned char                       isFinished;
 } c_ocoa_class_definition_t;
 
-c_ocoa_class_definition_t* c_ocoa_create_inherited_class_definition( const char* pClassName, const char* pParentClassName )
+//FK: Name of the ivar that holds the C payload of an instance (see c_ocoa_set_class_definition_payload())
+#define C_OCOA_PAYLOAD_IVAR_NAME "c_ocoa_payload"
+
+//FK: Maximum number of classes that install methods on first use (see c_ocoa_define_lazy_class())
+#ifndef C_OCOA_MAX_LAZY_CLASS_COUNT
+#define C_OCOA_MAX_LAZY_CLASS_COUNT 256
+#endif
+
+typedef struct
+{
+    Class                                   pObjcClass;         //FK: NULL until the entry has been published
+    IMP                                     pParentResolveInstanceMethod;
+    const c_ocoa_class_definition_method_t* pLazyMethods;       //FK: sorted by selector name
+    unsigned int                            lazyMethodCount;
+} c_ocoa_lazy_class_t;
+
+static c_ocoa_lazy_class_t  c_ocoa_lazy_classes[ C_OCOA_MAX_LAZY_CLASS_COUNT ];
+static unsigned int         c_ocoa_lazy_class_count = 0;
+
+void c_ocoa_init_class_arena( c_ocoa_class_arena_t* pArena, void* pMemory, size_t capacityInBytes )
+{
+    pArena->pMemory         = (unsigned char*)pMemory;
+    pArena->capacityInBytes = capacityInBytes;
+    pArena->usedInBytes     = 0;
+}
+
+//FK: Invalidates all class definitions that have been allocated from this arena
+void c_ocoa_reset_class_arena( c_ocoa_class_arena_t* pArena )
+{
+    pArena->usedInBytes = 0;
+}
+
+static void* c_ocoa_class_arena_allocate( c_ocoa_class_arena_t* pArena, size_t sizeInBytes )
+{
+    const size_t alignment = sizeof( void* );
+    const uintptr_t address = (uintptr_t)( pArena->pMemory + pArena->usedInBytes );
+    const size_t padding = ( alignment - ( address & ( alignment - 1 ) ) ) & ( alignment - 1 );
+    if( pArena->capacityInBytes - pArena->usedInBytes < sizeInBytes + padding )
+    {
+        return NULL;
+    }
+
+    void* pAllocation = pArena->pMemory + pArena->usedInBytes + padding;
+    pArena->usedInBytes += padding + sizeInBytes;
+    return pAllocation;
+}
+
+static void* c_ocoa_class_arena_reallocate( c_ocoa_class_arena_t* pArena, void* pMemory, size_t oldSizeInBytes, size_t newSizeInBytes )
+{
+    //FK: The last allocation can simply grow in place
+    unsigned char* pArenaEnd = pArena->pMemory + pArena->usedInBytes;
+    if( (unsigned char*)pMemory + oldSizeInBytes == pArenaEnd )
+    {
+        if( pArena->capacityInBytes - pArena->usedInBytes < newSizeInBytes - oldSizeInBytes )
+        {
+            return NULL;
+        }
+
+        pArena->usedInBytes += newSizeInBytes - oldSizeInBytes;
+        return pMemory;
+    }
+
+    void* pNewMemory = c_ocoa_class_arena_allocate( pArena, newSizeInBytes );
+    if( pNewMemory != NULL )
+    {
+        memcpy( pNewMemory, pMemory, oldSizeInBytes );
+    }
+
+    return pNewMemory;
+}
+
+static c_ocoa_class_definition_t* c_ocoa_allocate_class_definition( c_ocoa_class_arena_t* pArena, const char* pClassName, const char* pParentClassName, unsigned int methodCapacity )
 {
     Class pParentClass = objc_getClass( pParentClassName );
     if( pParentClass == NULL )
@@ -31,37 +126,177 @@ c_ocoa_class_definition_t* c_ocoa_create_inherited_class_definition( const char*
         return NULL;
     }
 
-    //FK: Add custom memory allocation strategy?
-    const size_t initialMethodCapacity = 8;
-    c_ocoa_class_definition_method_t* pMethodsArray = (c_ocoa_class_definition_method_t*)malloc( sizeof( c_ocoa_class_definition_method_t ) * initialMethodCapacity );
+    if( methodCapacity == 0 )
+    {
+        methodCapacity = 8;
+    }
 
-    c_ocoa_class_definition_t* pClassDefinition = (c_ocoa_class_definition_t*)malloc( sizeof( c_ocoa_class_definition_t ) );
-    if( pClassDefinition == NULL || pMethodsArray == NULL )
+    const size_t methodArraySizeInBytes = sizeof( c_ocoa_class_definition_method_t ) * methodCapacity;
+
+    c_ocoa_class_definition_t* pClassDefinition = NULL;
+    c_ocoa_class_definition_method_t* pMethodsArray = NULL;
+    if( pArena != NULL )
+    {
+        //FK: Methods come last so that they can grow in place as long as nothing else got allocated
+        pClassDefinition = (c_ocoa_class_definition_t*)c_ocoa_class_arena_allocate( pArena, sizeof( c_ocoa_class_definition_t ) );
+        pMethodsArray = pClassDefinition == NULL ? NULL : (c_ocoa_class_definition_method_t*)c_ocoa_class_arena_allocate( pArena, methodArraySizeInBytes );
+    }
+    else
     {
-        free( pClassDefinition );
-        free( pMethodsArray );
+        pClassDefinition = (c_ocoa_class_definition_t*)malloc( sizeof( c_ocoa_class_definition_t ) );
+        pMethodsArray = (c_ocoa_class_definition_method_t*)malloc( methodArraySizeInBytes );
+        if( pClassDefinition == NULL || pMethodsArray == NULL )
+        {
+            free( pClassDefinition );
+            free( pMethodsArray );
+            pClassDefinition = NULL;
+        }
+    }
 
-        printf("Error: Out of memory while calling 'cocoa_create_class_definition'.\n");
+    if( pClassDefinition == NULL || pMethodsArray == NULL )
+    {
+        printf("Error: Out of memory while creating class definition '%s'.\n", pClassName );
         return NULL;
     }
 
-    pClassDefinition->isFinished        = 0;
-    pClassDefinition->pObjcClass        = NULL;
-    pClassDefinition->methodCapacity    = initialMethodCapacity;
-    pClassDefinition->methodCount       = 0;
-    pClassDefinition->pMethods          = pMethodsArray;
-    pClassDefinition->pName             = pClassName;
-    pClassDefinition->pParentClass      = pParentClass;
-    
+    pClassDefinition->isFinished         = 0;
+    pClassDefinition->pObjcClass         = NULL;
+    pClassDefinition->pArena             = pArena;
+    pClassDefinition->methodCapacity     = methodCapacity;
+    pClassDefinition->methodCount        = 0;
+    pClassDefinition->pMethods           = pMethodsArray;
+    pClassDefinition->pLazyMethods       = NULL;
+    pClassDefinition->lazyMethodCount    = 0;
+    pClassDefinition->pName              = pClassName;
+    pClassDefinition->pParentClass       = pParentClass;
+    pClassDefinition->payloadSizeInBytes = 0;
+    pClassDefinition->payloadAlignment   = 0;
+    pClassDefinition->pPayloadOffset     = NULL;
+
     return pClassDefinition;
 }
 
+c_ocoa_class_definition_t* c_ocoa_create_inherited_class_definition( const char* pClassName, const char* pParentClassName )
+{
+    return c_ocoa_allocate_class_definition( NULL, pClassName, pParentClassName, 0 );
+}
+
 c_ocoa_class_definition_t* c_ocoa_create_class_definition( const char* pClassName )
 {
     return c_ocoa_create_inherited_class_definition( pClassName, "NSObject" );
 }
 
-int c_ocoa_add_class_definition_method( c_ocoa_class_definition_t* pClassDefinition, const char* pMethodName, void* pFunctionPointer, const char* pObjcFunctionSignature )
+//FK: Allocates the definition and room for 'methodCapacity' methods from pArena (no malloc).
+//    The definition stays valid until the arena gets reset.
+c_ocoa_class_definition_t* c_ocoa_create_inherited_class_definition_in_arena( c_ocoa_class_arena_t* pArena, const char* pClassName, const char* pParentClassName, unsigned int methodCapacity )
+{
+    return c_ocoa_allocate_class_definition( pArena, pClassName, pParentClassName, methodCapacity );
+}
+
+//FK: Releases the memory of the definition. The objc class itself stays registered (classes
+//    can't be removed from the runtime while instances might still exist).
+void c_ocoa_destroy_class_definition( c_ocoa_class_definition_t* pClassDefinition )
+{
+    if( pClassDefinition == NULL || pClassDefinition->pArena != NULL )
+    {
+        //FK: Arena memory is released by resetting the arena
+        return;
+    }
+
+    free( pClassDefinition->pMethods );
+    free( pClassDefinition );
+}
+
+static int c_ocoa_is_payload_alignment_valid( const char* pClassName, size_t payloadSizeInBytes, size_t payloadAlignment )
+{
+    if( payloadSizeInBytes > 0 && ( payloadAlignment == 0 || ( payloadAlignment & ( payloadAlignment - 1 ) ) != 0 ) )
+    {
+        printf("Error: Payload alignment of class '%s' has to be a power of two (got %zu).\n", pClassName, payloadAlignment );
+        return 0;
+    }
+
+    return 1;
+}
+
+//FK: Reserves 'payloadSizeInBytes' bytes of C state in every instance of the class (added as ivar).
+//    The payload gets zeroed by alloc. The offset of the payload gets written to pOutPayloadOffset when the class
+//    gets finished, so the definition doesn't have to be kept around to access it (see c_ocoa_object_payload()).
+int c_ocoa_set_class_definition_payload( c_ocoa_class_definition_t* pClassDefinition, size_t payloadSizeInBytes, size_t payloadAlignment, ptrdiff_t* pOutPayloadOffset )
+{
+    if( pClassDefinition->isFinished )
+    {
+        printf("Warning: Can't set payload of class '%s' because 'cocoa_finish_class_definition' has already been called.\n", pClassDefinition->pName );
+        return 0;
+    }
+
+    if( !c_ocoa_is_payload_alignment_valid( pClassDefinition->pName, payloadSizeInBytes, payloadAlignment ) )
+    {
+        return 0;
+    }
+
+    pClassDefinition->payloadSizeInBytes   = payloadSizeInBytes;
+    pClassDefinition->payloadAlignment     = payloadAlignment;
+    pClassDefinition->pPayloadOffset       = pOutPayloadOffset;
+    return 1;
+}
+
+c_ocoa_class_definition_t* c_ocoa_create_inherited_class_definition_with_payload( const char* pClassName, const char* pParentClassName, size_t payloadSizeInBytes, size_t payloadAlignment, ptrdiff_t* pOutPayloadOffset )
+{
+    c_ocoa_class_definition_t* pClassDefinition = c_ocoa_create_inherited_class_definition( pClassName, pParentClassName );
+    if( pClassDefinition != NULL && !c_ocoa_set_class_definition_payload( pClassDefinition, payloadSizeInBytes, payloadAlignment, pOutPayloadOffset ) )
+    {
+        c_ocoa_destroy_class_definition( pClassDefinition );
+        return NULL;
+    }
+
+    return pClassDefinition;
+}
+
+//FK: Returns the payload of an instance of a class with payload (or of a subclass).
+//    'payloadOffset' is the offset that has been written when the class got defined, so this is a single add.
+static inline void* c_ocoa_object_payload( id pObject, ptrdiff_t payloadOffset )
+{
+    return (char*)pObject + payloadOffset;
+}
+
+static int c_ocoa_reserve_class_definition_methods( c_ocoa_class_definition_t* pClassDefinition, unsigned int methodCount )
+{
+    if( methodCount <= pClassDefinition->methodCapacity )
+    {
+        return 1;
+    }
+
+    unsigned int newMethodCapacity = pClassDefinition->methodCapacity * 2;
+    if( newMethodCapacity < methodCount )
+    {
+        newMethodCapacity = methodCount;
+    }
+
+    const size_t oldMethodArraySizeInBytes = sizeof( c_ocoa_class_definition_method_t ) * pClassDefinition->methodCapacity;
+    const size_t newMethodArraySizeInBytes = sizeof( c_ocoa_class_definition_method_t ) * newMethodCapacity;
+    c_ocoa_class_definition_method_t* pNewMethodsArray = NULL;
+    if( pClassDefinition->pArena != NULL )
+    {
+        pNewMethodsArray = (c_ocoa_class_definition_method_t*)c_ocoa_class_arena_reallocate( pClassDefinition->pArena, pClassDefinition->pMethods, oldMethodArraySizeInBytes, newMethodArraySizeInBytes );
+    }
+    else
+    {
+        pNewMethodsArray = (c_ocoa_class_definition_method_t*)realloc( pClassDefinition->pMethods, newMethodArraySizeInBytes );
+    }
+
+    if( pNewMethodsArray == NULL )
+    {
+        printf("Error: Could not expand methods array of c-ocoa class definition '%s'.\n", pClassDefinition->pName );
+        return 0;
+    }
+
+    pClassDefinition->pMethods          = pNewMethodsArray;
+    pClassDefinition->methodCapacity    = newMethodCapacity;
+    return 1;
+}
+
+//FK: Adds all methods of a (static) method table, the array grows at most once per call
+int c_ocoa_add_class_definition_methods( c_ocoa_class_definition_t* pClassDefinition, const c_ocoa_class_definition_method_t* pMethods, unsigned int methodCount )
 {
     if( pClassDefinition->isFinished )
     {
@@ -69,63 +304,282 @@ int c_ocoa_add_class_definition_method( c_ocoa_class_definition_t* pClassDefinit
         return 0;
     }
 
-    const size_t newMethodCount = pClassDefinition->methodCount + 1;
-    if( newMethodCount == pClassDefinition->methodCapacity )
+    if( !c_ocoa_reserve_class_definition_methods( pClassDefinition, pClassDefinition->methodCount + methodCount ) )
     {
-        const size_t newMethodCapacity = pClassDefinition->methodCapacity * 2;
-        const size_t newMethodArraySizeInBytes = sizeof( c_ocoa_class_definition_method_t ) * newMethodCapacity;
-        c_ocoa_class_definition_method_t* pNewMethodsArray = (c_ocoa_class_definition_method_t*)realloc( pClassDefinition->pMethods, newMethodArraySizeInBytes );
+        return 0;
+    }
+
+    memcpy( pClassDefinition->pMethods + pClassDefinition->methodCount, pMethods, sizeof( c_ocoa_class_definition_method_t ) * methodCount );
+    pClassDefinition->methodCount += methodCount;
+
+    return 1;
+}
 
-        if( pNewMethodsArray == NULL )
+int c_ocoa_add_class_definition_method( c_ocoa_class_definition_t* pClassDefinition, const char* pMethodName, void* pFunctionPointer, const char* pObjcFunctionSignature )
+{
+    const c_ocoa_class_definition_method_t method = { pMethodName, pObjcFunctionSignature, pFunctionPointer };
+    return c_ocoa_add_class_definition_methods( pClassDefinition, &method, 1 );
+}
+
+static int c_ocoa_compare_method_name( const void* pLhs, const void* pRhs )
+{
+    return strcmp( ( (const c_ocoa_class_definition_method_t*)pLhs )->pName, ( (const c_ocoa_class_definition_method_t*)pRhs )->pName );
+}
+
+static int c_ocoa_compare_method_name_key( const void* pKey, const void* pMethod )
+{
+    return strcmp( (const char*)pKey, ( (const c_ocoa_class_definition_method_t*)pMethod )->pName );
+}
+
+static int c_ocoa_is_lazy_method_table_valid( const char* pClassName, const c_ocoa_class_definition_method_t* pLazyMethods, unsigned int lazyMethodCount )
+{
+#ifndef NDEBUG
+    //FK: The methods get looked up via binary search
+    for( unsigned int methodIndex = 1; methodIndex < lazyMethodCount; ++methodIndex )
+    {
+        if( c_ocoa_compare_method_name( pLazyMethods + methodIndex - 1, pLazyMethods + methodIndex ) >= 0 )
         {
-            printf("Error: Could not expand methods array of c-ocoa class definition '%s'.\n", pClassDefinition->pName );
+            printf("Error: Lazy methods of class '%s' have to be sorted by name ('%s' comes before '%s').\n", pClassName, pLazyMethods[ methodIndex - 1 ].pName, pLazyMethods[ methodIndex ].pName );
             return 0;
         }
+    }
+#endif
+    return 1;
+}
 
-        pClassDefinition->pMethods          = pNewMethodsArray;
-        pClassDefinition->methodCapacity    = newMethodCapacity;
+//FK: The methods of pLazyMethods get added to the class on first use (via +resolveInstanceMethod:) instead of
+//    by c_ocoa_finish_class_definition(). The table isn't copied, so it has to be static, sorted by
+//    name (strcmp order) and it must not contain methods that override methods of the parent class
+//    (the runtime only asks for methods that can't be found, so these have to be added as regular methods).
+int c_ocoa_set_class_definition_lazy_methods( c_ocoa_class_definition_t* pClassDefinition, const c_ocoa_class_definition_method_t* pLazyMethods, unsigned int lazyMethodCount )
+{
+    if( pClassDefinition->isFinished )
+    {
+        printf("Warning: Can't set lazy methods of class '%s' because 'cocoa_finish_class_definition' has already been called.\n", pClassDefinition->pName );
+        return 0;
     }
 
-    const unsigned int methodIndex = pClassDefinition->methodCount++;
-    pClassDefinition->pMethods[ methodIndex ].pName             = pMethodName;
-    pClassDefinition->pMethods[ methodIndex ].pFunctionPointer  = pFunctionPointer;
-    pClassDefinition->pMethods[ methodIndex ].pSignature        = pObjcFunctionSignature;
+    if( !c_ocoa_is_lazy_method_table_valid( pClassDefinition->pName, pLazyMethods, lazyMethodCount ) )
+    {
+        return 0;
+    }
 
+    pClassDefinition->pLazyMethods      = pLazyMethods;
+    pClassDefinition->lazyMethodCount   = lazyMethodCount;
     return 1;
 }
 
-int c_ocoa_finish_class_definition( c_ocoa_class_definition_t* pClassDefinition )
+static const c_ocoa_lazy_class_t* c_ocoa_find_lazy_class( Class pObjcClass )
 {
-    if( pClassDefinition->isFinished )
+    unsigned int lazyClassCount = __atomic_load_n( &c_ocoa_lazy_class_count, __ATOMIC_ACQUIRE );
+    if( lazyClassCount > C_OCOA_MAX_LAZY_CLASS_COUNT )
     {
-        printf("Warning: Class '%s' already finished.\n", pClassDefinition->pName);
+        lazyClassCount = C_OCOA_MAX_LAZY_CLASS_COUNT;
+    }
+
+    for( unsigned int lazyClassIndex = 0; lazyClassIndex < lazyClassCount; ++lazyClassIndex )
+    {
+        if( __atomic_load_n( &c_ocoa_lazy_classes[ lazyClassIndex ].pObjcClass, __ATOMIC_ACQUIRE ) == pObjcClass )
+        {
+            return c_ocoa_lazy_classes + lazyClassIndex;
+        }
+    }
+
+    return NULL;
+}
+
+//FK: +resolveInstanceMethod: of all classes with lazy methods. 'self' is the class that misses the method,
+//    which might also be a subclass of a lazy class.
+static BOOL c_ocoa_resolve_lazy_instance_method( id self, SEL selector, SEL missingSelector )
+{
+    const char* pMissingSelectorName = sel_getName( missingSelector );
+    const c_ocoa_lazy_class_t* pTopMostLazyClass = NULL;
+    for( Class pObjcClass = (Class)self; pObjcClass != NULL; pObjcClass = class_getSuperclass( pObjcClass ) )
+    {
+        const c_ocoa_lazy_class_t* pLazyClass = c_ocoa_find_lazy_class( pObjcClass );
+        if( pLazyClass == NULL )
+        {
+            continue;
+        }
+
+        const c_ocoa_class_definition_method_t* pMethod = (const c_ocoa_class_definition_method_t*)bsearch( pMissingSelectorName, pLazyClass->pLazyMethods, pLazyClass->lazyMethodCount, sizeof( c_ocoa_class_definition_method_t ), c_ocoa_compare_method_name_key );
+        if( pMethod != NULL )
+        {
+            //FK: Fails if another thread has been faster, the method is there either way
+            class_addMethod( pLazyClass->pObjcClass, missingSelector, (IMP)pMethod->pFunctionPointer, pMethod->pSignature );
+            return YES;
+        }
+
+        pTopMostLazyClass = pLazyClass;
+    }
+
+    if( pTopMostLazyClass == NULL || pTopMostLazyClass->pParentResolveInstanceMethod == NULL )
+    {
+        return NO;
+    }
+
+    return ((BOOL (*)( id, SEL, SEL ))pTopMostLazyClass->pParentResolveInstanceMethod)( self, selector, missingSelector );
+}
+
+static int c_ocoa_add_lazy_class( Class pParentClass, Class pCustomClass, const c_ocoa_class_definition_method_t* pLazyMethods, unsigned int lazyMethodCount )
+{
+    if( __atomic_load_n( &c_ocoa_lazy_class_count, __ATOMIC_RELAXED ) >= C_OCOA_MAX_LAZY_CLASS_COUNT )
+    {
+        printf("Warning: More than %u classes with lazy methods, methods of class '%s' get added right away (see C_OCOA_MAX_LAZY_CLASS_COUNT).\n", (unsigned int)C_OCOA_MAX_LAZY_CLASS_COUNT, class_getName( pCustomClass ) );
         return 0;
     }
 
-    Class pCustomClass = objc_allocateClassPair( pClassDefinition->pParentClass, pClassDefinition->pName, 0);
-    if( pCustomClass == NULL )
+    SEL resolveInstanceMethodSelector = sel_registerName( "resolveInstanceMethod:" );
+    Method pParentResolveInstanceMethod = class_getClassMethod( pParentClass, resolveInstanceMethodSelector );
+    IMP pParentResolveInstanceMethodImplementation = pParentResolveInstanceMethod != NULL ? method_getImplementation( pParentResolveInstanceMethod ) : NULL;
+    const char* pResolveInstanceMethodSignature = pParentResolveInstanceMethod != NULL ? method_getTypeEncoding( pParentResolveInstanceMethod ) : "c@::";
+    if( !class_addMethod( object_getClass( (id)pCustomClass ), resolveInstanceMethodSelector, (IMP)c_ocoa_resolve_lazy_instance_method, pResolveInstanceMethodSignature ) )
     {
-        printf("Error: Couldn't create new class for c_ocoa class definition '%s'.\n", pClassDefinition->pName);
+        printf("Error: Couldn't add '+resolveInstanceMethod:' to class '%s', methods get added right away.\n", class_getName( pCustomClass ) );
         return 0;
     }
 
-    pClassDefinition->pObjcClass = pCustomClass;
-    pClassDefinition->isFinished = 1;
+    //FK: The slot only gets taken once the resolver is in place, so a failed class_addMethod() doesn't use up the table
+    const unsigned int lazyClassIndex = __atomic_fetch_add( &c_ocoa_lazy_class_count, 1u, __ATOMIC_RELAXED );
+    if( lazyClassIndex >= C_OCOA_MAX_LAZY_CLASS_COUNT )
+    {
+        //FK: Another thread took the last slot. The class isn't registered yet, so the resolver can still be swapped
+        //    for the one of the parent class (without a parent resolver ours returns NO, same as having none)
+        if( pParentResolveInstanceMethodImplementation != NULL )
+        {
+            class_replaceMethod( object_getClass( (id)pCustomClass ), resolveInstanceMethodSelector, pParentResolveInstanceMethodImplementation, pResolveInstanceMethodSignature );
+        }
+
+        printf("Warning: More than %u classes with lazy methods, methods of class '%s' get added right away (see C_OCOA_MAX_LAZY_CLASS_COUNT).\n", (unsigned int)C_OCOA_MAX_LAZY_CLASS_COUNT, class_getName( pCustomClass ) );
+        return 0;
+    }
+
+    c_ocoa_lazy_class_t* pLazyClass = c_ocoa_lazy_classes + lazyClassIndex;
+    pLazyClass->pParentResolveInstanceMethod    = pParentResolveInstanceMethodImplementation;
+    pLazyClass->pLazyMethods                    = pLazyMethods;
+    pLazyClass->lazyMethodCount                 = lazyMethodCount;
+    __atomic_store_n( &pLazyClass->pObjcClass, pCustomClass, __ATOMIC_RELEASE );
+    return 1;
+}
 
-    for( unsigned int methodIndex = 0; methodIndex < pClassDefinition->methodCount; ++methodIndex )
+static void c_ocoa_add_class_methods( Class pCustomClass, const c_ocoa_class_definition_method_t* pMethods, unsigned int methodCount )
+{
+    for( unsigned int methodIndex = 0; methodIndex < methodCount; ++methodIndex )
     {
-        const c_ocoa_class_definition_method_t* pMethodDefinition = pClassDefinition->pMethods + methodIndex;
+        const c_ocoa_class_definition_method_t* pMethodDefinition = pMethods + methodIndex;
         SEL pMethodSelectorName = sel_registerName( pMethodDefinition->pName );
         BOOL methodAdded = class_addMethod( pCustomClass, pMethodSelectorName, (IMP)pMethodDefinition->pFunctionPointer, pMethodDefinition->pSignature );
         if( !methodAdded )
         {
-            printf("Error: Couldn't register method '%s' for c_ocoa class definition '%s'.\n", pMethodDefinition->pName, pClassDefinition->pName );
+            printf("Error: Couldn't register method '%s' for c_ocoa class definition '%s'.\n", pMethodDefinition->pName, class_getName( pCustomClass ) );
             continue;
         }
     }
+}
+
+static Class c_ocoa_register_class( Class pParentClass, const char* pClassName, const c_ocoa_class_definition_method_t* pMethods, unsigned int methodCount, const c_ocoa_class_definition_method_t* pLazyMethods, unsigned int lazyMethodCount, size_t payloadSizeInBytes, size_t payloadAlignment, ptrdiff_t* pOutPayloadOffset )
+{
+    Class pCustomClass = objc_allocateClassPair( pParentClass, pClassName, 0);
+    if( pCustomClass == NULL )
+    {
+        printf("Error: Couldn't create new class for c_ocoa class definition '%s'.\n", pClassName);
+        return NULL;
+    }
+
+    if( payloadSizeInBytes > 0 )
+    {
+        //FK: Plain bytes, so the runtime doesn't treat anything in the payload as object reference
+        char payloadTypeEncoding[ 32 ];
+        snprintf( payloadTypeEncoding, sizeof( payloadTypeEncoding ), "[%zuC]", payloadSizeInBytes );
+
+        uint8_t payloadAlignmentLog2 = 0;
+        while( ( (size_t)1 << payloadAlignmentLog2 ) < payloadAlignment )
+        {
+            ++payloadAlignmentLog2;
+        }
+
+        if( !class_addIvar( pCustomClass, C_OCOA_PAYLOAD_IVAR_NAME, payloadSizeInBytes, payloadAlignmentLog2, payloadTypeEncoding ) )
+        {
+            printf("Error: Couldn't add payload of %zu bytes to c_ocoa class definition '%s'.\n", payloadSizeInBytes, pClassName );
+            objc_disposeClassPair( pCustomClass );
+            return NULL;
+        }
+    }
+
+    c_ocoa_add_class_methods( pCustomClass, pMethods, methodCount );
+
+    //FK: Lazy methods only cost one table entry here, they get added by +resolveInstanceMethod: on first use
+    if( lazyMethodCount > 0 && !c_ocoa_add_lazy_class( pParentClass, pCustomClass, pLazyMethods, lazyMethodCount ) )
+    {
+        c_ocoa_add_class_methods( pCustomClass, pLazyMethods, lazyMethodCount );
+    }
 
     objc_registerClassPair( pCustomClass );
 
+    if( payloadSizeInBytes > 0 && pOutPayloadOffset != NULL )
+    {
+        *pOutPayloadOffset = ivar_getOffset( class_getInstanceVariable( pCustomClass, C_OCOA_PAYLOAD_IVAR_NAME ) );
+    }
+
+    return pCustomClass;
+}
+
+//FK: Defines and registers a class with all methods of a (static) method table in one call.
+//    No definition is needed (and nothing gets allocated besides the class itself).
+//    Pass 0 as payloadSizeInBytes (and NULL as pOutPayloadOffset) for classes without payload (see c_ocoa_set_class_definition_payload()).
+Class c_ocoa_define_class( const char* pClassName, const char* pParentClassName, const c_ocoa_class_definition_method_t* pMethods, unsigned int methodCount, size_t payloadSizeInBytes, size_t payloadAlignment, ptrdiff_t* pOutPayloadOffset )
+{
+    Class pParentClass = objc_getClass( pParentClassName );
+    if( pParentClass == NULL )
+    {
+        printf("Error: Couldn't find parent class '%s'\n", pParentClassName );
+        return NULL;
+    }
+
+    if( !c_ocoa_is_payload_alignment_valid( pClassName, payloadSizeInBytes, payloadAlignment ) )
+    {
+        return NULL;
+    }
+
+    return c_ocoa_register_class( pParentClass, pClassName, pMethods, methodCount, NULL, 0, payloadSizeInBytes, payloadAlignment, pOutPayloadOffset );
+}
+
+//FK: Same as c_ocoa_define_class(), but the methods of pLazyMethods get added on first use
+//    (see c_ocoa_set_class_definition_lazy_methods() for the requirements of the table).
+Class c_ocoa_define_lazy_class( const char* pClassName, const char* pParentClassName, const c_ocoa_class_definition_method_t* pMethods, unsigned int methodCount, const c_ocoa_class_definition_method_t* pLazyMethods, unsigned int lazyMethodCount, size_t payloadSizeInBytes, size_t payloadAlignment, ptrdiff_t* pOutPayloadOffset )
+{
+    Class pParentClass = objc_getClass( pParentClassName );
+    if( pParentClass == NULL )
+    {
+        printf("Error: Couldn't find parent class '%s'\n", pParentClassName );
+        return NULL;
+    }
+
+    if( !c_ocoa_is_lazy_method_table_valid( pClassName, pLazyMethods, lazyMethodCount ) || !c_ocoa_is_payload_alignment_valid( pClassName, payloadSizeInBytes, payloadAlignment ) )
+    {
+        return NULL;
+    }
+
+    return c_ocoa_register_class( pParentClass, pClassName, pMethods, methodCount, pLazyMethods, lazyMethodCount, payloadSizeInBytes, payloadAlignment, pOutPayloadOffset );
+}
+
+int c_ocoa_finish_class_definition( c_ocoa_class_definition_t* pClassDefinition )
+{
+    if( pClassDefinition->isFinished )
+    {
+        printf("Warning: Class '%s' already finished.\n", pClassDefinition->pName);
+        return 0;
+    }
+
+    Class pCustomClass = c_ocoa_register_class( pClassDefinition->pParentClass, pClassDefinition->pName, pClassDefinition->pMethods, pClassDefinition->methodCount, pClassDefinition->pLazyMethods, pClassDefinition->lazyMethodCount, pClassDefinition->payloadSizeInBytes, pClassDefinition->payloadAlignment, pClassDefinition->pPayloadOffset );
+    if( pCustomClass == NULL )
+    {
+        return 0;
+    }
+
+    pClassDefinition->pObjcClass = pCustomClass;
+    pClassDefinition->isFinished = 1;
+
     return 1;
 }
 
@@ -136,7 +590,7 @@ void* c_ocoa_alloc_object_of_class( const c_ocoa_class_definition_t* pClassDefin
         printf("Warning: Can't alloc object of class '%s' because the class isn't finished yet.\n", pClassDefinition->pName);
         return NULL;
     }
-    
+
     SEL allocSelector = sel_registerName("alloc");
     return ((id (*)(id, SEL))objc_msgSend)(pClassDefinition->pObjcClass, allocSelector);
 }
\ No newline at end of file
@@ -3,6 +3,10 @@
 #define C_OCOA_GENERATOR_MAJOR_VERSION 1
 #define C_OCOA_GENERATOR_MINOR_VERSION 0
 
+#if !defined(__APPLE__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE //FK: for dladdr(), see objc_find_class_image_name()
+#endif
+
 #include <stdint.h>
 #include <stdio.h>
 #include <signal.h>
@@ -16,6 +20,10 @@
 
 #include <objc/runtime.h>
 
+#ifndef __APPLE__
+#include <dlfcn.h>
+#endif
+
 typedef enum
 {
     ConvertResult_Success = 0,
@@ -32,14 +40,28 @@ typedef enum
     MethodType_Instance
 } c_ocoa_method_type;
 
+typedef enum
+{
+    ClassFamily_None = 0,
+    ClassFamily_Array,
+    ClassFamily_Set,
+    ClassFamily_Dictionary,
+    ClassFamily_String,
+    ClassFamily_Data,
+    ClassFamily_MutableData
+} c_ocoa_class_family;
+
 typedef uint8_t boolean8_t;
 
+#define C_OCOA_MAX_SNAPSHOT_SPECIFICATION_COUNT 32
+
 typedef struct 
 {
     int32_t length;
     char* pName;
     char* pNameLower;
     char* pNameUpper;
+    const char* pFrameworkIdentifier; //FK: NULL unless the class gets loaded lazily ('--lazy-frameworks')
 } c_ocoa_objc_class_name;
 
 typedef struct
@@ -66,15 +88,18 @@ typedef struct
     char*                   pOriginalFunctionName;
     char*                   pOriginalReturnType;
     char*                   pOriginalArgumentTypes;
+    const char*             pDirectRuntimeFunction; //FK: runtime helper that replaces objc_msgSend for well-known selectors (eg: 'c_ocoa_retain')
     
     c_ocoa_method_type              methodType;
 
     uint32_t                returnValueSizeInBits;
+    uint32_t                largeStructArgumentMask; //FK: bit n is set if argument n is a struct passed in memory (see objc_type_is_large_struct())
     uint8_t                 argumentCount;
     boolean8_t              isVoidFunction          : 1;
     boolean8_t              isAllocFunction         : 1;
     boolean8_t              hasStructReturnValue    : 1;
     boolean8_t              hasFloatReturnValue     : 1;
+    boolean8_t              hasLargeStructReturnValue : 1; //FK: returned via hidden pointer argument (stret)
 } c_ocoa_objc_function_resolve_result;
 
 typedef FILE*(*fopen_fn)(const char* pPath, const char* pMode);
@@ -84,9 +109,22 @@ typedef int(*fflush_fn)(FILE* pStream);
 typedef struct
 {
     boolean8_t  exportTypes;
+    boolean8_t  impCache;       //FK: cache (Class, IMP) per call site and call the IMP directly on a hit
+    boolean8_t  batchVariants;  //FK: emit '<wrapper>_batch()' variants that send the same message to an array of receivers
+    boolean8_t  superVariants;  //FK: emit '<class>_super_<method>()' wrappers that call the superclass implementation via cached IMP
+    boolean8_t  headerOnly;     //FK: define all wrappers as 'static inline' in the header, no source file gets written
+    boolean8_t  cppBackend;     //FK: additionally write C++ headers with typed handles per class ('<class>.hpp')
+    boolean8_t  ivarAccessors;  //FK: emit '<class>_ivar_<property>_ptr()' for properties that are backed by an ivar (fragile!)
+    boolean8_t  registry;       //FK: emit a perfect hashed name -> wrapper table per class ('<class>_registry()')
+    boolean8_t  lazyFrameworks; //FK: resolve classes through per framework loaders that dlopen() the framework on first use
+    boolean8_t  onMainVariants; //FK: emit '<wrapper>_on_main()' variants that enqueue the call to the main thread queue
+    boolean8_t  availabilityChecks; //FK: emit '<wrapper>_available()' predicates (and checked calls if C_OCOA_CHECKED_CALLS is defined)
+    uint8_t     snapshotSpecificationCount;
+    const char* pSnapshotSpecifications[ C_OCOA_MAX_SNAPSHOT_SPECIFICATION_COUNT ]; //FK: '<Class>=<property>,<property>,...' (see '--snapshot')
     const char* pOutputPath;
     const char* pPrefix;
     const char* pClassNameFilter;
+    const char* pProtocolNameFilter; //FK: emit '<protocol>_vtable_t' delegate vtables + '<protocol>_define_class()' for all protocols matching this filter (see '--protocols')
     
     fopen_fn    fopen;
     fclose_fn   fclose;
@@ -178,19 +216,54 @@ typedef struct
 
 typedef struct
 {
+    char*       pName;                  //FK: wrapper name without class prefix, eg: 'setFrame'
+    char*       pSelectorName;
+    char        argumentTypes[ 33 ];    //FK: one objc type code per argument + null terminator
+    const char* pReturnKind;            //FK: name of the c_ocoa_return_kind_t value
+    uint8_t     argumentCount;
+    boolean8_t  isClassMethod;
+} c_ocoa_registry_builder_entry;
+
+typedef struct
+{
+    c_ocoa_registry_builder_entry*  pEntries;
+    uint32_t                        size;
+    uint32_t                        capacity;
+} c_ocoa_registry_builder;
+
+typedef struct
+{
+    const c_ocoa_code_generator_parameter* pParameter;
     c_ocoa_objc_function_collection* pFunctionCollection;
     c_ocoa_objc_type_dictionary*     pTypeDict;
     const c_ocoa_objc_class_name*    pClassName;
     c_ocoa_string_allocator*         pStringAllocator;
     FILE*                            pHeaderFileHandle;
     FILE*                            pSourceFileHandle;
+    FILE*                            pCppHeaderFileHandle;  //FK: NULL if the C++ backend is disabled
+    c_ocoa_registry_builder*         pRegistryBuilder;      //FK: NULL if '--registry' is disabled
 } c_ocoa_source_code_generator_input;
 
+typedef struct
+{
+    char* pName;            //FK: eg: 'AppKit'
+    char* pIdentifier;      //FK: eg: 'appkit', used for 'c_ocoa_framework_appkit'
+    char* pImagePath;
+} c_ocoa_framework_entry;
+
+typedef struct
+{
+    c_ocoa_framework_entry* pEntries;
+    uint32_t                size;
+    uint32_t                capacity;
+} c_ocoa_framework_collection;
+
 typedef struct
 {
     c_ocoa_objc_type_dictionary     typeDict;
     c_ocoa_objc_function_collection functionCollection;
     c_ocoa_string_allocator         stringAllocator;
+    c_ocoa_framework_collection     frameworkCollection;
 } c_ocoa_code_gen_context;
 
 //FK: Some helpful macros
@@ -201,8 +274,38 @@ typedef struct
 
 void c_ocoa_create_source_code_for_objc_methods( c_ocoa_method_type c_ocoa_method_type, Method* ppMethods, const uint32_t methodCount, c_ocoa_source_code_generator_input* pCodeGenInput );
 c_ocoa_convert_result objc_parse_result_convert_to_function_definition( c_ocoa_string_allocator* pStringAllocator, c_ocoa_objc_function_resolve_result* pOutFunctionResolveResult, c_ocoa_objc_function_collection* pFunctionCollection, c_ocoa_objc_type_dictionary* pDict, c_ocoa_parse_result* pParseResult, const c_ocoa_objc_class_name* pClassName );
-void file_write_c_function_implementation( FILE* pSourceFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName );
-void cfunction_write_declaration( FILE* pResultFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+void file_write_c_function_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName );
+void cfunction_write_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+boolean8_t cfunction_has_batch_variant( const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+void cfunction_write_batch_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+void file_write_c_function_batch_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName );
+void cfunction_write_super_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+boolean8_t cfunction_has_callback_variant( const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+boolean8_t cfunction_has_on_main_variant( const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+void cfunction_write_on_main_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+void file_write_c_function_on_main_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult );
+boolean8_t cfunction_has_available_variant( const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+void cfunction_write_available_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+void file_write_c_function_available_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName );
+boolean8_t cfunction_has_by_pointer_variant( const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+void cfunction_write_by_pointer_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+void file_write_c_function_by_pointer_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName );
+void cfunction_write_callback_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition );
+void file_write_c_function_callback_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult );
+void file_write_c_function_super_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName );
+c_ocoa_class_family objc_find_class_family( Class pClass );
+void file_write_c_class_family_helper_declarations( FILE* pHeaderFileHandle, const c_ocoa_code_generator_parameter* pParameter, c_ocoa_class_family classFamily, const c_ocoa_objc_class_name* pClassName );
+void file_write_c_class_family_helper_implementations( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, c_ocoa_class_family classFamily, const c_ocoa_objc_class_name* pClassName );
+void c_ocoa_create_source_code_for_objc_ivar_accessors( const c_ocoa_source_code_generator_input* pInput, Class pClass );
+void file_write_objc_type_encoding_without_names( FILE* pFileHandle, const char* pTypeEncoding, int32_t typeEncodingLength );
+void c_ocoa_create_source_code_for_objc_snapshot( const c_ocoa_source_code_generator_input* pInput, Class pClass );
+void c_ocoa_create_protocols_api( const c_ocoa_code_generator_parameter* pCodeGeneratorParameter, c_ocoa_code_gen_context* pContext );
+void registry_builder_add( c_ocoa_registry_builder* pRegistryBuilder, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult );
+void registry_builder_free( c_ocoa_registry_builder* pRegistryBuilder );
+void file_write_c_registry( const c_ocoa_source_code_generator_input* pInput );
+void file_write_cpp_header_prefix( FILE* pCppHeaderFileHandle, const c_ocoa_objc_class_name* pClassName );
+void file_write_cpp_header_suffix( FILE* pCppHeaderFileHandle );
+void file_write_cpp_member_function( FILE* pCppHeaderFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName );
 boolean8_t objc_create_class_name( c_ocoa_objc_class_name* pOutClassName, const char* pClassNameStart, const int32_t classNameLength );
 void objc_type_dict_resolve_struct_types( c_ocoa_objc_type_dictionary* pTypeDict, FILE* pTypesFileHandle, boolean8_t exportTypes );
 
@@ -536,7 +639,19 @@ void print_help(void)
     printf("-o {path}    set output path (output directory)\n");
     printf("-p {prefix}  set prefix for output source files\n");
     printf("-h           print this help text\n\n");
-    printf("-t           export all objc types (write all objc structs into c_ocoa_types.h)\n\n");
+    printf("-t           export all objc types (write all objc structs into c_ocoa_types.h)\n");
+    printf("-i           cache the (Class, IMP) pair per call site and call the IMP directly on a hit\n");
+    printf("-b           emit '<wrapper>_batch()' variants for instance methods that operate on arrays of receivers\n");
+    printf("-s           emit '<class>_super_<method>()' wrappers that call the superclass implementation (for overrides)\n");
+    printf("--header-only define all wrappers as 'static inline' functions in the generated headers (no .c files)\n");
+    printf("--cpp        additionally generate C++ headers ('<class>.hpp') with typed handles and compile time ABI selection\n");
+    printf("--ivar-accessors emit '<class>_ivar_<property>_ptr()' for properties backed by an ivar (bypasses getters, fragile)\n");
+    printf("--registry   emit a perfect hashed name -> wrapper table per class ('<class>_registry()') for scripting bridges\n");
+    printf("--lazy-frameworks dlopen() the frameworks of the generated classes on first use instead of linking them (see c_ocoa_frameworks.h)\n");
+    printf("--on-main    additionally emit '<wrapper>_on_main()' variants of void wrappers that enqueue the call to the main thread (see c_ocoa_main_queue_drain())\n");
+    printf("--available  emit '<wrapper>_available()' predicates with a cached result per class, wrappers check them if C_OCOA_CHECKED_CALLS is defined\n");
+    printf("--snapshot {class}={property},{property},... emit '<class>_snapshot()' that reads the given properties into '<class>_state_t' (can be repeated)\n");
+    printf("--protocols {filter} emit '<protocol>_vtable_t' function tables for '<protocol>_define_class()' for all protocols matching {filter} (supports wildcard)\n\n");
     printf("FILTER is:\n");
     printf("A filter for the class name to be exported. Supports wildcard.\n\n");
     printf("eg: 'c_ocoa_generator NS*'  - export all classes that start with 'NS'.\n");
@@ -568,7 +683,66 @@ void evaluate_code_generator_argv_arguments( int argc, const char** argv, c_ocoa
 
                 case 't':
                     pOutArguments->exportTypes = true;
-                    ++i;
+                break;
+
+                case 'i':
+                    pOutArguments->impCache = 1;
+                break;
+
+                case 'b':
+                    pOutArguments->batchVariants = 1;
+                break;
+
+                case 's':
+                    pOutArguments->superVariants = 1;
+                break;
+
+                case '-':
+                    if( strcmp( pArg, "--header-only" ) == 0 )
+                    {
+                        pOutArguments->headerOnly = 1;
+                    }
+                    else if( strcmp( pArg, "--cpp" ) == 0 )
+                    {
+                        pOutArguments->cppBackend = 1;
+                    }
+                    else if( strcmp( pArg, "--ivar-accessors" ) == 0 )
+                    {
+                        pOutArguments->ivarAccessors = 1;
+                    }
+                    else if( strcmp( pArg, "--registry" ) == 0 )
+                    {
+                        pOutArguments->registry = 1;
+                    }
+                    else if( strcmp( pArg, "--lazy-frameworks" ) == 0 )
+                    {
+                        pOutArguments->lazyFrameworks = 1;
+                    }
+                    else if( strcmp( pArg, "--on-main" ) == 0 )
+                    {
+                        pOutArguments->onMainVariants = 1;
+                    }
+                    else if( strcmp( pArg, "--available" ) == 0 )
+                    {
+                        pOutArguments->availabilityChecks = 1;
+                    }
+                    else if( strcmp( pArg, "--snapshot" ) == 0 && i + 1 < argc )
+                    {
+                        if( pOutArguments->snapshotSpecificationCount == C_OCOA_MAX_SNAPSHOT_SPECIFICATION_COUNT )
+                        {
+                            printf_stderr( "[error] Ignoring '--snapshot %s', only %d snapshots are supported.\n", argv[i+1], C_OCOA_MAX_SNAPSHOT_SPECIFICATION_COUNT );
+                        }
+                        else
+                        {
+                            pOutArguments->pSnapshotSpecifications[ pOutArguments->snapshotSpecificationCount++ ] = argv[i+1];
+                        }
+                        ++i;
+                    }
+                    else if( strcmp( pArg, "--protocols" ) == 0 && i + 1 < argc )
+                    {
+                        pOutArguments->pProtocolNameFilter = argv[i+1];
+                        ++i;
+                    }
                 break;
             }
         }
@@ -676,12 +850,18 @@ uint32_t djb2_hash( const char* pString, const int32_t stringLength )
     return hash;
 }
 
+//FK: pTypeName doesn't have to be null terminated (eg: struct name inside of a struct type encoding)
+static inline boolean8_t objc_type_dict_entry_has_name( const c_ocoa_objc_type_dictionary_entry* pEntry, const char* pTypeName, const int32_t typeNameLength )
+{
+    return strncmp( pEntry->pHashValue, pTypeName, typeNameLength ) == 0 && pEntry->pHashValue[ typeNameLength ] == 0;
+}
+
 c_ocoa_objc_type_dictionary_entry* objc_type_dict_find_entry( c_ocoa_objc_type_dictionary* pDict, const char* pTypeName, const int32_t typeNameLength )
 {
     const uint32_t hashValue = djb2_hash( pTypeName, typeNameLength );
     const uint32_t entryIndex = hashValue % pDict->typeEntryCapacity;
     c_ocoa_objc_type_dictionary_entry* pEntry = pDict->ppTypeEntries[entryIndex];
-    while( pEntry != NULL && strcmp( pEntry->pHashValue, pTypeName ) != 0 )
+    while( pEntry != NULL && !objc_type_dict_entry_has_name( pEntry, pTypeName, typeNameLength ) )
     {
         pEntry = (c_ocoa_objc_type_dictionary_entry*)pEntry->pNext;
     }
@@ -725,7 +905,7 @@ c_ocoa_objc_type_dictionary_entry* objc_type_dict_insert_or_get_entry( c_ocoa_ob
     
     while( pEntry != NULL )
     {
-        if( strcmp( pEntry->pHashValue, pTypeName ) == 0 )
+        if( objc_type_dict_entry_has_name( pEntry, pTypeName, typeNameLength ) )
         {
             *pOutIsNew = 0;
             return pEntry;
@@ -962,6 +1142,48 @@ boolean8_t objc_type_dict_resolve_base_type( c_ocoa_objc_type_resolve_result* pO
     return 1;
 }
 
+//FK: '@?' (optionally followed by the extended block signature, eg: '@?<v@?@Q^B>')
+boolean8_t objc_is_block_type( const char* pTypeName, const int32_t typeNameLength )
+{
+    return typeNameLength >= 2 && pTypeName[0] == '@' && pTypeName[1] == '?';
+}
+
+boolean8_t objc_type_dict_resolve_block_type( c_ocoa_objc_type_resolve_result* pOutResult, c_ocoa_objc_type_dictionary* pDict )
+{
+    const char* pBlockTypeName = "@?";
+    const int32_t blockTypeNameLength = 2;
+
+    boolean8_t isNewDictEntry = 0;
+    c_ocoa_objc_type_dictionary_entry* pDictEntry = objc_type_dict_insert_or_get_entry( pDict, pBlockTypeName, blockTypeNameLength, &isNewDictEntry );
+    if( pDictEntry == NULL )
+    {
+        printf_stderr( "[error] Could not resolve type name '%s' because we ran out of memory.", pBlockTypeName );
+        return 0;
+    }
+
+    if( !isNewDictEntry )
+    {
+        *pOutResult = pDictEntry->resolveResult;
+        return 1;
+    }
+
+    //FK: Blocks are objects, they're passed like 'id'
+    const char* pResolvedBlockType = "nsblock_t";
+    const int32_t resolvedTypeLength = string_get_length_excl_null_terminator( pResolvedBlockType );
+    pOutResult->isReference              = 0;
+    pOutResult->isBaseType               = 1;
+    pOutResult->isFloatingType           = 0;
+    pOutResult->isConst                  = 0;
+    pOutResult->originalTypeLength       = blockTypeNameLength;
+    pOutResult->pResolvedType            = string_allocate_copy( pResolvedBlockType, resolvedTypeLength );
+    pOutResult->pOriginalType            = string_allocate_copy( pBlockTypeName, blockTypeNameLength );
+    pOutResult->resolvedTypeLength       = resolvedTypeLength;
+    pOutResult->typeSizeInBits           = 64u;
+
+    pDictEntry->resolveResult = *pOutResult;
+    return 1;
+}
+
 boolean8_t objc_type_dict_resolve_struct_type( c_ocoa_objc_type_resolve_result* pOutResult, c_ocoa_objc_type_dictionary* pDict, const char* pTypeName, int32_t typeNameLength );
 
 boolean8_t struct_type_resolve( c_ocoa_objc_type_resolve_result* pOutResult, c_ocoa_objc_type_dictionary* pDict, const char* pTypeName, int32_t typeNameLength )
@@ -1199,10 +1421,27 @@ boolean8_t objc_type_dict_resolve_reference_type( c_ocoa_objc_type_resolve_resul
     return 1;
 }
 
+static inline boolean8_t objc_is_method_type_qualifier( const char character )
+{
+    //FK: in, inout, out, bycopy, byref, oneway ('r' = const is handled by the reference type resolve)
+    return character == 'n' || character == 'N' || character == 'o' || character == 'O' || character == 'R' || character == 'V';
+}
+
 boolean8_t objc_resolve_c_type_name( c_ocoa_objc_type_resolve_result* pOutResult, c_ocoa_objc_type_dictionary* pTypeDict, const char* pTypeName, int32_t typeNameLength )
 {
+    //FK: Strip method type qualifiers, eg: 'Vv' (oneway void) of -[NSObject release]
+    while( typeNameLength > 1 && objc_is_method_type_qualifier( *pTypeName ) )
+    {
+        ++pTypeName;
+        --typeNameLength;
+    }
+
     boolean8_t resolvedSuccessfully = 0;
-    if( objc_is_struct_type( pTypeName ) )
+    if( objc_is_block_type( pTypeName, typeNameLength ) )
+    {
+        resolvedSuccessfully = objc_type_dict_resolve_block_type( pOutResult, pTypeDict );
+    }
+    else if( objc_is_struct_type( pTypeName ) )
     {
         resolvedSuccessfully = objc_type_dict_resolve_struct_type( pOutResult, pTypeDict, pTypeName, typeNameLength );
     }
@@ -1223,6 +1462,14 @@ boolean8_t objc_resolve_c_type_name( c_ocoa_objc_type_resolve_result* pOutResult
     return resolvedSuccessfully;
 }
 
+//FK: Same as objc_resolve_c_type_name() but for a single type of a type encoding.
+//    Object types may name the class (eg: '@"NSString"'), these all resolve to nsobject_t
+boolean8_t objc_resolve_c_type_name_of_type_encoding( c_ocoa_objc_type_resolve_result* pOutResult, c_ocoa_objc_type_dictionary* pTypeDict, const char* pType, int32_t typeLength )
+{
+    const int32_t resolveTypeLength = typeLength > 1 && pType[0] == '@' && pType[1] == '"' ? 1 : typeLength;
+    return objc_resolve_c_type_name( pOutResult, pTypeDict, pType, resolveTypeLength );
+}
+
 const char* newline_find_next( const char* pText )
 {
     while( *pText )
@@ -1413,6 +1660,7 @@ void c_ocoa_create_source_code_for_objc_methods( c_ocoa_method_type c_ocoa_metho
     c_ocoa_objc_type_dictionary*        pTypeDict           = pCodeGenInput->pTypeDict;
     c_ocoa_objc_function_collection*    pFunctionCollection = pCodeGenInput->pFunctionCollection;
     const c_ocoa_objc_class_name*       pClassName          = pCodeGenInput->pClassName;
+    const c_ocoa_code_generator_parameter* pParameter       = pCodeGenInput->pParameter;
     FILE*                               pSourceFileHandle   = pCodeGenInput->pSourceFileHandle;
     FILE*                               pHeaderFileHandle   = pCodeGenInput->pHeaderFileHandle;
 
@@ -1505,8 +1753,56 @@ void c_ocoa_create_source_code_for_objc_methods( c_ocoa_method_type c_ocoa_metho
                 break;
 
             case ConvertResult_Success:
-                cfunction_write_declaration( pHeaderFileHandle, &functionResolveResult );
-                file_write_c_function_implementation( pSourceFileHandle, &functionResolveResult, pClassName );
+                //FK: Written before the wrapper since the checked wrapper calls it (matters for '--header-only')
+                if( pParameter->availabilityChecks && cfunction_has_available_variant( &functionResolveResult ) )
+                {
+                    cfunction_write_available_declaration( pHeaderFileHandle, pParameter, &functionResolveResult );
+                    file_write_c_function_available_implementation( pSourceFileHandle, pParameter, &functionResolveResult, pClassName );
+                }
+
+                cfunction_write_declaration( pHeaderFileHandle, pParameter, &functionResolveResult );
+                file_write_c_function_implementation( pSourceFileHandle, pParameter, &functionResolveResult, pClassName );
+
+                if( pCodeGenInput->pCppHeaderFileHandle != NULL )
+                {
+                    file_write_cpp_member_function( pCodeGenInput->pCppHeaderFileHandle, &functionResolveResult, pClassName );
+                }
+
+                if( pParameter->batchVariants && cfunction_has_batch_variant( &functionResolveResult ) )
+                {
+                    cfunction_write_batch_declaration( pHeaderFileHandle, pParameter, &functionResolveResult );
+                    file_write_c_function_batch_implementation( pSourceFileHandle, pParameter, &functionResolveResult, pClassName );
+                }
+
+                //FK: Same restrictions as for the batch variants (instance methods only)
+                if( pParameter->superVariants && cfunction_has_batch_variant( &functionResolveResult ) )
+                {
+                    cfunction_write_super_declaration( pHeaderFileHandle, pParameter, &functionResolveResult );
+                    file_write_c_function_super_implementation( pSourceFileHandle, pParameter, &functionResolveResult, pClassName );
+                }
+
+                if( cfunction_has_callback_variant( &functionResolveResult ) )
+                {
+                    cfunction_write_callback_declaration( pHeaderFileHandle, pParameter, &functionResolveResult );
+                    file_write_c_function_callback_implementation( pSourceFileHandle, pParameter, &functionResolveResult );
+                }
+
+                if( cfunction_has_by_pointer_variant( &functionResolveResult ) )
+                {
+                    cfunction_write_by_pointer_declaration( pHeaderFileHandle, pParameter, &functionResolveResult );
+                    file_write_c_function_by_pointer_implementation( pSourceFileHandle, pParameter, &functionResolveResult, pClassName );
+                }
+
+                if( pParameter->onMainVariants && cfunction_has_on_main_variant( &functionResolveResult ) )
+                {
+                    cfunction_write_on_main_declaration( pHeaderFileHandle, pParameter, &functionResolveResult );
+                    file_write_c_function_on_main_implementation( pSourceFileHandle, pParameter, &functionResolveResult );
+                }
+
+                if( pCodeGenInput->pRegistryBuilder != NULL )
+                {
+                    registry_builder_add( pCodeGenInput->pRegistryBuilder, &functionResolveResult );
+                }
                 break;
         }
         string_allocator_reset( pStringAllocator );
@@ -1554,10 +1850,12 @@ void file_write_c_type_header_prefix( FILE* pTypesFileHandle )
     file_write_generated_comment( pTypesFileHandle );
     fprintf( pTypesFileHandle, "#ifndef C_OCOA_TYPES_HEADER\n");
     fprintf( pTypesFileHandle, "#define C_OCOA_TYPES_HEADER\n\n");
-    fprintf( pTypesFileHandle, "#include <stdbool.h>\n\n");
+    fprintf( pTypesFileHandle, "#include <stdbool.h>\n");
+    fprintf( pTypesFileHandle, "#include <stddef.h>\n\n");
     fprintf( pTypesFileHandle, "typedef void*\tnsobject_t;\n" );
     fprintf( pTypesFileHandle, "typedef void*\tnsselector_t;\n" );
-    fprintf( pTypesFileHandle, "typedef void*\tnsclass_t;\n\n" );
+    fprintf( pTypesFileHandle, "typedef void*\tnsclass_t;\n" );
+    fprintf( pTypesFileHandle, "typedef void*\tnsblock_t;\n\n" );
 }
 
 void file_write_c_type_header_suffix( FILE* pTypesFileHandle )
@@ -1581,286 +1879,4895 @@ void file_write_c_header_suffix( FILE* pHeaderFileHandle )
     fprintf( pHeaderFileHandle, "#endif");
 }
 
-void file_write_c_source_prefix( FILE* pSourceFileHandle, const char* pHeaderFileName, const c_ocoa_objc_class_name* pClassName)
+void file_write_c_implementation_prefix( FILE* pSourceFileHandle )
 {
-    file_write_generated_comment( pSourceFileHandle );
     fprintf( pSourceFileHandle, "#if defined(__OBJC__) && __has_feature(objc_arc)\n" );
     fprintf( pSourceFileHandle, "#define ARC_AVAILABLE\n" );
     fprintf( pSourceFileHandle, "#endif\n\n" );
 
     fprintf( pSourceFileHandle, "// ABI is a bit different between platforms\n" );
-    fprintf( pSourceFileHandle, "#ifdef __arm64__\n" );
+    fprintf( pSourceFileHandle, "#if defined(__arm64__) || defined(__aarch64__)\n" );
     fprintf( pSourceFileHandle, "#define abi_objc_msgSend_stret objc_msgSend\n" );
     fprintf( pSourceFileHandle, "#else\n" );
     fprintf( pSourceFileHandle, "#define abi_objc_msgSend_stret objc_msgSend_stret\n" );
     fprintf( pSourceFileHandle, "#endif\n" );
+    fprintf( pSourceFileHandle, "#if defined(__arm64__) || defined(__aarch64__)\n" );
+    fprintf( pSourceFileHandle, "#define abi_objc_msgSendSuper_stret objc_msgSendSuper\n" );
+    fprintf( pSourceFileHandle, "#else\n" );
+    fprintf( pSourceFileHandle, "#define abi_objc_msgSendSuper_stret objc_msgSendSuper_stret\n" );
+    fprintf( pSourceFileHandle, "#endif\n" );
     fprintf( pSourceFileHandle, "#ifdef __i386__\n" );
     fprintf( pSourceFileHandle, "#define abi_objc_msgSend_fpret objc_msgSend_fpret\n" );
     fprintf( pSourceFileHandle, "#else\n" );
     fprintf( pSourceFileHandle, "#define abi_objc_msgSend_fpret objc_msgSend\n" );
+    fprintf( pSourceFileHandle, "#endif\n" );
+    fprintf( pSourceFileHandle, "// x86_64 passes the address for large struct return values as hidden first argument\n" );
+    fprintf( pSourceFileHandle, "#ifdef __x86_64__\n" );
+    fprintf( pSourceFileHandle, "#define abi_stret_address_is_first_argument\n" );
     fprintf( pSourceFileHandle, "#endif\n\n" );
-    fprintf( pSourceFileHandle, "#include \"%s\"\n\n", pHeaderFileName );
+    fprintf( pSourceFileHandle, "#include \"c_ocoa_runtime.h\"\n" );
 }
 
-boolean8_t c_ocoa_create_source_code_for_objc_class( const c_ocoa_code_generator_parameter* pParameter, c_ocoa_objc_type_dictionary* pTypeDict, c_ocoa_objc_function_collection* pFunctionCollection, c_ocoa_string_allocator* pStringAllocator, Class pClass, const char* pClassName, int32_t classNameLength )
+void file_write_c_source_prefix( FILE* pSourceFileHandle, const char* pHeaderFileName, const c_ocoa_objc_class_name* pClassName)
 {
-    if( pParameter->pClassNameFilter != NULL )
-    {
-        if( !string_name_matches_filter( pClassName, pParameter->pClassNameFilter ) )
-        {
-            return 0u;
-        }
-    }
-
-    c_ocoa_class_method_collection c_ocoa_class_method_collection = {};
-    if( !objc_runtime_collect_methods_from_class( &c_ocoa_class_method_collection, pClass, pClassName ) )
-    {
-        return 0u;
-    }
+    file_write_generated_comment( pSourceFileHandle );
+    file_write_c_implementation_prefix( pSourceFileHandle );
+    fprintf( pSourceFileHandle, "#include \"%s\"\n\n", pHeaderFileName );
+}
 
-    //FK: TODO: Instead of completely reparsing the base class over-and-over again,
-    //    we should use the type dict to speed up parsing...
+void file_write_c_runtime_header_imp_cache( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Per call site (Class, IMP) cache used by the wrappers when generated with '-i'.\n"
+        "// Readers and writers synchronize through a sequence counter so that a hit can never\n"
+        "// pair the class of one receiver with the IMP of another.\n"
+        "typedef struct\n"
+        "{\n"
+        "\tuint32_t\tsequence;\n"
+        "\tuint32_t\tepoch;\n"
+        "\tClass\t\tpClass;\n"
+        "\tIMP\t\t\tpImp;\n"
+        "} c_ocoa_imp_cache_t;\n\n"
+        "#ifndef C_OCOA_SUPER_IMP_CACHE_ENTRY_COUNT\n"
+        "#define C_OCOA_SUPER_IMP_CACHE_ENTRY_COUNT 4u\n"
+        "#endif\n\n"
+        "// Per call site cache of the '<class>_super_<method>()' wrappers. One wrapper gets called with a different 'cls'\n"
+        "// for every class in a hierarchy that overrides the method, so it keeps a few (Class, IMP) entries.\n"
+        "typedef struct\n"
+        "{\n"
+        "\tc_ocoa_imp_cache_t\tentries[ C_OCOA_SUPER_IMP_CACHE_ENTRY_COUNT ];\n"
+        "\tuint32_t\t\t\tnextEntryIndex;\n"
+        "} c_ocoa_super_imp_cache_t;\n\n"
+        "extern uint32_t c_ocoa_imp_cache_epoch;\n\n"
+        "// Returns the IMP that 'pClass' uses for 'pSelector' or NULL if the message would be forwarded (or pClass is Nil).\n"
+        "IMP\t\tc_ocoa_resolve_imp( Class pClass, SEL pSelector );\n"
+        "IMP\t\tc_ocoa_imp_cache_fill( c_ocoa_imp_cache_t* pCache, Class pClass, SEL pSelector );\n"
+        "// Same as c_ocoa_imp_cache_fill() but caches the IMP of the superclass of 'pClass' (keyed by 'pClass').\n"
+        "IMP\t\tc_ocoa_super_imp_cache_fill( c_ocoa_imp_cache_t* pCache, Class pClass, SEL pSelector );\n\n"
+        "// Call after swizzling (method_setImplementation, method_exchangeImplementations, class_replaceMethod)\n"
+        "// or after adding categories at runtime. Images loaded via dyld invalidate the caches automatically.\n"
+        "void\tc_ocoa_imp_cache_invalidate( void );\n\n"
+        "// Returns the cached IMP if the cache holds an up to date entry for 'pClass', NULL otherwise.\n"
+        "static inline IMP c_ocoa_imp_cache_find( c_ocoa_imp_cache_t* pCache, Class pClass )\n"
+        "{\n"
+        "\tconst uint32_t sequence = __atomic_load_n( &pCache->sequence, __ATOMIC_ACQUIRE );\n"
+        "\tClass pCachedClass = __atomic_load_n( &pCache->pClass, __ATOMIC_RELAXED );\n"
+        "\tIMP pCachedImp = __atomic_load_n( &pCache->pImp, __ATOMIC_RELAXED );\n"
+        "\tconst uint32_t cachedEpoch = __atomic_load_n( &pCache->epoch, __ATOMIC_RELAXED );\n"
+        "\t__atomic_thread_fence( __ATOMIC_ACQUIRE );\n\n"
+        "\tconst int isConsistent = ( sequence & 1u ) == 0u && __atomic_load_n( &pCache->sequence, __ATOMIC_RELAXED ) == sequence;\n"
+        "\tif( isConsistent && pCachedClass == pClass && cachedEpoch == __atomic_load_n( &c_ocoa_imp_cache_epoch, __ATOMIC_RELAXED ) )\n"
+        "\t{\n"
+        "\t\treturn pCachedImp;\n"
+        "\t}\n\n"
+        "\treturn NULL;\n"
+        "}\n\n"
+        "// Returns NULL for nil receivers and for selectors that the receiver class doesn't implement itself\n"
+        "// (eg: forwarded messages), in which case the caller falls back to objc_msgSend.\n"
+        "static inline IMP c_ocoa_imp_cache_lookup( c_ocoa_imp_cache_t* pCache, id pObject, SEL pSelector )\n"
+        "{\n"
+        "\tif( pObject == NULL )\n"
+        "\t{\n"
+        "\t\treturn NULL;\n"
+        "\t}\n\n"
+        "\tClass pClass = object_getClass( pObject );\n"
+        "\tIMP pCachedImp = c_ocoa_imp_cache_find( pCache, pClass );\n"
+        "\treturn pCachedImp != NULL ? pCachedImp : c_ocoa_imp_cache_fill( pCache, pClass, pSelector );\n"
+        "}\n\n"
+        "// Returns the IMP that the superclass of 'pClass' uses for 'pSelector' or NULL if the message would be forwarded.\n"
+        "// 'pClass' has to be the class that implements the calling method, *not* the class of the receiver.\n"
+        "static inline IMP c_ocoa_super_imp_cache_lookup( c_ocoa_super_imp_cache_t* pCache, Class pClass, SEL pSelector )\n"
+        "{\n"
+        "\tfor( uint32_t entryIndex = 0u; entryIndex < C_OCOA_SUPER_IMP_CACHE_ENTRY_COUNT; ++entryIndex )\n"
+        "\t{\n"
+        "\t\tIMP pCachedImp = c_ocoa_imp_cache_find( pCache->entries + entryIndex, pClass );\n"
+        "\t\tif( pCachedImp != NULL )\n"
+        "\t\t{\n"
+        "\t\t\treturn pCachedImp;\n"
+        "\t\t}\n"
+        "\t}\n\n"
+        "\t//FK: Round robin replacement, the fill of each entry is synchronized by its own sequence counter\n"
+        "\tconst uint32_t entryIndex = __atomic_fetch_add( &pCache->nextEntryIndex, 1u, __ATOMIC_RELAXED ) % C_OCOA_SUPER_IMP_CACHE_ENTRY_COUNT;\n"
+        "\treturn c_ocoa_super_imp_cache_fill( pCache->entries + entryIndex, pClass, pSelector );\n"
+        "}\n\n",
+        pRuntimeHeaderFileHandle );
+}
 
-    //FK: Move up the class hiearchy
-    Class pSuperClass = class_getSuperclass( pClass );
-    while( pSuperClass != NULL )
-    {
-        const char* pSuperClassName = class_getName( pSuperClass );
-        if( !objc_runtime_collect_methods_from_class( &c_ocoa_class_method_collection, pSuperClass, pSuperClassName ) )
-        {
-            return 0u;
-        }
+void file_write_c_runtime_header_availability( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Per call site cache of a selector check used by the '<wrapper>_available()' predicates when generated\n"
+        "// with '--available'. Each entry holds the class and the flags in one word (classes are at least 8 byte aligned),\n"
+        "// so a single atomic load per entry is enough to check the cache.\n"
+        "#ifndef C_OCOA_AVAILABILITY_CACHE_ENTRY_COUNT\n"
+        "#define C_OCOA_AVAILABILITY_CACHE_ENTRY_COUNT 4u\n"
+        "#endif\n\n"
+        "#define C_OCOA_AVAILABILITY_RESPONDS\t\t((uintptr_t)1u)\n"
+        "#define C_OCOA_AVAILABILITY_FORWARDS\t\t((uintptr_t)2u)\t// class overrides forwardingTargetForSelector: or forwardInvocation:\n"
+        "#define C_OCOA_AVAILABILITY_FLAG_MASK\t((uintptr_t)7u)\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\tuintptr_t\tclassAndFlags[ C_OCOA_AVAILABILITY_CACHE_ENTRY_COUNT ];\n"
+        "\tuint32_t\tnextEntryIndex;\n"
+        "} c_ocoa_availability_cache_t;\n\n"
+        "int\tc_ocoa_availability_cache_fill( c_ocoa_availability_cache_t* pCache, id pObject, Class pClass, SEL pSelector );\n"
+        "// Asks 'pObject' via respondsToSelector:, used for classes that forward messages.\n"
+        "int\tc_ocoa_availability_ask_object( id pObject, Class pClass, SEL pSelector );\n\n"
+        "// Returns 1 if 'pObject' (object or class object) responds to 'pSelector', 0 otherwise or for nil.\n"
+        "// Only the first check per receiver class asks the runtime, which doesn't send a message.\n"
+        "// Exception: receivers whose class overrides forwardingTargetForSelector: or forwardInvocation: (eg: proxies)\n"
+        "// may handle selectors that their class doesn't implement, for those respondsToSelector: is sent on every check.\n"
+        "static inline int c_ocoa_availability_cache_lookup( c_ocoa_availability_cache_t* pCache, id pObject, SEL pSelector )\n"
+        "{\n"
+        "\tif( pObject == NULL )\n"
+        "\t{\n"
+        "\t\treturn 0;\n"
+        "\t}\n\n"
+        "\tClass pClass = object_getClass( pObject );\n"
+        "\tfor( uint32_t entryIndex = 0u; entryIndex < C_OCOA_AVAILABILITY_CACHE_ENTRY_COUNT; ++entryIndex )\n"
+        "\t{\n"
+        "\t\tconst uintptr_t classAndFlags = __atomic_load_n( &pCache->classAndFlags[ entryIndex ], __ATOMIC_RELAXED );\n"
+        "\t\tif( ( classAndFlags & ~C_OCOA_AVAILABILITY_FLAG_MASK ) != (uintptr_t)pClass )\n"
+        "\t\t{\n"
+        "\t\t\tcontinue;\n"
+        "\t\t}\n\n"
+        "\t\tif( classAndFlags & C_OCOA_AVAILABILITY_FORWARDS )\n"
+        "\t\t{\n"
+        "\t\t\treturn c_ocoa_availability_ask_object( pObject, pClass, pSelector );\n"
+        "\t\t}\n\n"
+        "\t\treturn (int)( classAndFlags & C_OCOA_AVAILABILITY_RESPONDS );\n"
+        "\t}\n\n"
+        "\treturn c_ocoa_availability_cache_fill( pCache, pObject, pClass, pSelector );\n"
+        "}\n\n"
+        "// Calls 'wrapper' only if the method is available, evaluates to 1 if the call has been made ('object' is evaluated twice).\n"
+        "// eg: C_OCOA_CALL_IF_AVAILABLE( nswindow_setTabbingMode, window, 2 )\n"
+        "#define C_OCOA_CALL_IF_AVAILABLE( wrapper, object, ... ) ( wrapper##_available( object ) ? ( wrapper( object, ## __VA_ARGS__ ), 1 ) : 0 )\n"
+        "#define C_OCOA_CALL_CLASS_METHOD_IF_AVAILABLE( wrapper, ... ) ( wrapper##_available() ? ( wrapper( __VA_ARGS__ ), 1 ) : 0 )\n\n",
+        pRuntimeHeaderFileHandle );
+}
 
-        pSuperClass = class_getSuperclass( pSuperClass );
-    }
+void file_write_c_runtime_source_availability( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "//FK: Returns 1 if the method of pClass differs from the one of its root class (NSObject/NSProxy)\n"
+        "static int c_ocoa_availability_class_overrides( Class pClass, SEL pSelector )\n"
+        "{\n"
+        "\tif( class_getInstanceMethod( pClass, pSelector ) == NULL )\n"
+        "\t{\n"
+        "\t\treturn 0;\n"
+        "\t}\n\n"
+        "\t//FK: The superclass of the root metaclass is the root class, stay on the same side of the hierarchy\n"
+        "\tClass pRootClass = pClass;\n"
+        "\tClass pSuperclass = class_getSuperclass( pRootClass );\n"
+        "\twhile( pSuperclass != NULL && class_isMetaClass( pSuperclass ) == class_isMetaClass( pClass ) )\n"
+        "\t{\n"
+        "\t\tpRootClass = pSuperclass;\n"
+        "\t\tpSuperclass = class_getSuperclass( pRootClass );\n"
+        "\t}\n\n"
+        "\treturn pRootClass != pClass && class_getMethodImplementation( pClass, pSelector ) != class_getMethodImplementation( pRootClass, pSelector );\n"
+        "}\n\n"
+        "int c_ocoa_availability_ask_object( id pObject, Class pClass, SEL pSelector )\n"
+        "{\n"
+        "\tstatic SEL respondsToSelectorSelector = NULL;\n"
+        "\tif( respondsToSelectorSelector == NULL )\n"
+        "\t{\n"
+        "\t\trespondsToSelectorSelector = sel_registerName( \"respondsToSelector:\" );\n"
+        "\t}\n\n"
+        "\tif( !class_respondsToSelector( pClass, respondsToSelectorSelector ) )\n"
+        "\t{\n"
+        "\t\treturn class_respondsToSelector( pClass, pSelector ) ? 1 : 0;\n"
+        "\t}\n\n"
+        "\treturn ((BOOL (*)( id, SEL, SEL ))objc_msgSend)( pObject, respondsToSelectorSelector, pSelector ) ? 1 : 0;\n"
+        "}\n\n"
+        "int c_ocoa_availability_cache_fill( c_ocoa_availability_cache_t* pCache, id pObject, Class pClass, SEL pSelector )\n"
+        "{\n"
+        "\tstatic SEL forwardingTargetSelector = NULL;\n"
+        "\tstatic SEL forwardInvocationSelector = NULL;\n"
+        "\tif( forwardingTargetSelector == NULL )\n"
+        "\t{\n"
+        "\t\tforwardInvocationSelector = sel_registerName( \"forwardInvocation:\" );\n"
+        "\t\tforwardingTargetSelector = sel_registerName( \"forwardingTargetForSelector:\" );\n"
+        "\t}\n\n"
+        "\tuintptr_t flags = 0u;\n"
+        "\tint result = 0;\n"
+        "\tif( class_respondsToSelector( pClass, pSelector ) )\n"
+        "\t{\n"
+        "\t\tflags = C_OCOA_AVAILABILITY_RESPONDS;\n"
+        "\t\tresult = 1;\n"
+        "\t}\n"
+        "\telse if( c_ocoa_availability_class_overrides( pClass, forwardingTargetSelector ) || c_ocoa_availability_class_overrides( pClass, forwardInvocationSelector ) )\n"
+        "\t{\n"
+        "\t\t//FK: Implemented selectors stay cached, only the others depend on the (per object) forwarding\n"
+        "\t\tflags = C_OCOA_AVAILABILITY_FORWARDS;\n"
+        "\t\tresult = c_ocoa_availability_ask_object( pObject, pClass, pSelector );\n"
+        "\t}\n\n"
+        "\t//FK: Round robin replacement, an entry is a single word so readers never see a torn entry\n"
+        "\tconst uint32_t entryIndex = __atomic_fetch_add( &pCache->nextEntryIndex, 1u, __ATOMIC_RELAXED ) % C_OCOA_AVAILABILITY_CACHE_ENTRY_COUNT;\n"
+        "\t__atomic_store_n( &pCache->classAndFlags[ entryIndex ], (uintptr_t)pClass | flags, __ATOMIC_RELAXED );\n"
+        "\treturn result;\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
 
-    c_ocoa_objc_class_name className;
-    if( !objc_create_class_name( &className, pClassName, classNameLength ) )
-    {
-        return 0u;
-    }
+void file_write_c_runtime_source_imp_cache( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "uint32_t c_ocoa_imp_cache_epoch = 0u;\n\n"
+        "void c_ocoa_imp_cache_invalidate( void )\n"
+        "{\n"
+        "\t__atomic_fetch_add( &c_ocoa_imp_cache_epoch, 1u, __ATOMIC_RELEASE );\n"
+        "}\n\n"
+        "#ifdef __APPLE__\n"
+        "#include <mach-o/dyld.h>\n\n"
+        "static void c_ocoa_imp_cache_on_image_added( const struct mach_header* pHeader, intptr_t slide )\n"
+        "{\n"
+        "\t//FK: Newly loaded images may contain categories that replace cached IMPs\n"
+        "\t(void)pHeader;\n"
+        "\t(void)slide;\n"
+        "\tc_ocoa_imp_cache_invalidate();\n"
+        "}\n"
+        "#else\n"
+        "#include <objc/hooks.h>\n\n"
+        "static void (*c_ocoa_imp_cache_previous_load_callback)( Class, struct objc_category* ) = NULL;\n\n"
+        "static void c_ocoa_imp_cache_on_load( Class pClass, struct objc_category* pCategory )\n"
+        "{\n"
+        "\t//FK: libobjc2 calls this for every class and category that gets loaded (eg: via dlopen()), categories may replace cached IMPs\n"
+        "\tc_ocoa_imp_cache_invalidate();\n"
+        "\tif( c_ocoa_imp_cache_previous_load_callback != NULL )\n"
+        "\t{\n"
+        "\t\tc_ocoa_imp_cache_previous_load_callback( pClass, pCategory );\n"
+        "\t}\n"
+        "}\n"
+        "#endif\n\n"
+        "IMP c_ocoa_resolve_imp( Class pClass, SEL pSelector )\n"
+        "{\n"
+        "\t//FK: Don't hand out the forwarding IMP, let objc_msgSend handle message forwarding\n"
+        "\tif( pClass == NULL || class_getInstanceMethod( pClass, pSelector ) == NULL )\n"
+        "\t{\n"
+        "\t\treturn NULL;\n"
+        "\t}\n\n"
+        "\treturn class_getMethodImplementation( pClass, pSelector );\n"
+        "}\n\n"
+        "static IMP c_ocoa_imp_cache_fill_from_class( c_ocoa_imp_cache_t* pCache, Class pClass, Class pResolveClass, SEL pSelector )\n"
+        "{\n"
+        "\tstatic uint32_t imageCallbackRegistered = 0u;\n"
+        "\tif( __atomic_exchange_n( &imageCallbackRegistered, 1u, __ATOMIC_ACQ_REL ) == 0u )\n"
+        "\t{\n"
+        "#ifdef __APPLE__\n"
+        "\t\t_dyld_register_func_for_add_image( c_ocoa_imp_cache_on_image_added );\n"
+        "#else\n"
+        "\t\tc_ocoa_imp_cache_previous_load_callback = _objc_load_callback;\n"
+        "\t\t_objc_load_callback = c_ocoa_imp_cache_on_load;\n"
+        "#endif\n"
+        "\t}\n\n"
+        "\tconst uint32_t epoch = __atomic_load_n( &c_ocoa_imp_cache_epoch, __ATOMIC_ACQUIRE );\n"
+        "\tIMP pImp = c_ocoa_resolve_imp( pResolveClass, pSelector );\n"
+        "\tif( pImp == NULL )\n"
+        "\t{\n"
+        "\t\treturn NULL;\n"
+        "\t}\n\n"
+        "\t//FK: If another thread is currently writing to this cache we simply don't cache this time\n"
+        "\tuint32_t sequence = __atomic_load_n( &pCache->sequence, __ATOMIC_RELAXED );\n"
+        "\tif( ( sequence & 1u ) == 0u && __atomic_compare_exchange_n( &pCache->sequence, &sequence, sequence + 1u, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) )\n"
+        "\t{\n"
+        "\t\t__atomic_store_n( &pCache->pClass, pClass, __ATOMIC_RELAXED );\n"
+        "\t\t__atomic_store_n( &pCache->pImp, pImp, __ATOMIC_RELAXED );\n"
+        "\t\t__atomic_store_n( &pCache->epoch, epoch, __ATOMIC_RELAXED );\n"
+        "\t\t__atomic_store_n( &pCache->sequence, sequence + 2u, __ATOMIC_RELEASE );\n"
+        "\t}\n\n"
+        "\treturn pImp;\n"
+        "}\n\n"
+        "IMP c_ocoa_imp_cache_fill( c_ocoa_imp_cache_t* pCache, Class pClass, SEL pSelector )\n"
+        "{\n"
+        "\treturn c_ocoa_imp_cache_fill_from_class( pCache, pClass, pClass, pSelector );\n"
+        "}\n\n"
+        "IMP c_ocoa_super_imp_cache_fill( c_ocoa_imp_cache_t* pCache, Class pClass, SEL pSelector )\n"
+        "{\n"
+        "\treturn c_ocoa_imp_cache_fill_from_class( pCache, pClass, pClass == NULL ? NULL : class_getSuperclass( pClass ), pSelector );\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
 
-    const char* pOutputPath = pParameter->pOutputPath == NULL ? "" : pParameter->pOutputPath;
-    const char* pFilePrefix = pParameter->pPrefix == NULL ? "" : pParameter->pPrefix;
-    const int32_t outputPathLength = string_get_length_excl_null_terminator( pOutputPath );
-    const int32_t filePrefixLength = string_get_length_excl_null_terminator( pFilePrefix );
+void file_write_c_runtime_header_ivars( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Returns the offset of ivar 'pIvarName' of 'pClass' if it exists and has the type 'pTypeEncoding', 0 otherwise\n"
+        "// (offset 0 is always 'isa'). Quoted names in the ivar encoding (eg: '@\"NSString\"', '{CGPoint=\"x\"d\"y\"d}') are ignored,\n"
+        "// 'pTypeEncoding' must not contain any. Used by the '<class>_ivar_<property>_ptr()' accessors generated with '--ivar-accessors'.\n"
+        "ptrdiff_t\tc_ocoa_find_ivar_offset( Class pClass, const char* pIvarName, const char* pTypeEncoding );\n\n",
+        pRuntimeHeaderFileHandle );
+}
 
-    //FK: +2 for file extension (.c/.h) +1 for null terminator
-    char* pHeaderFileName = string_allocator_allocate( pStringAllocator, outputPathLength + filePrefixLength + classNameLength + 2 + 1 );
-    char* pSourceFileName = string_allocator_allocate( pStringAllocator, outputPathLength + filePrefixLength + classNameLength + 2 + 1 );
+void file_write_c_runtime_source_ivars( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "#include <string.h>\n\n"
+        "ptrdiff_t c_ocoa_find_ivar_offset( Class pClass, const char* pIvarName, const char* pTypeEncoding )\n"
+        "{\n"
+        "\tIvar pIvar = pClass == NULL ? NULL : class_getInstanceVariable( pClass, pIvarName );\n"
+        "\tconst char* pIvarTypeEncoding = pIvar == NULL ? NULL : ivar_getTypeEncoding( pIvar );\n"
+        "\tif( pIvarTypeEncoding == NULL )\n"
+        "\t{\n"
+        "\t\treturn 0;\n"
+        "\t}\n\n"
+        "\twhile( 1 )\n"
+        "\t{\n"
+        "\t\twhile( *pIvarTypeEncoding == '\"' )\n"
+        "\t\t{\n"
+        "\t\t\tconst char* pNameEnd = strchr( pIvarTypeEncoding + 1, '\"' );\n"
+        "\t\t\tif( pNameEnd == NULL )\n"
+        "\t\t\t{\n"
+        "\t\t\t\treturn 0;\n"
+        "\t\t\t}\n\n"
+        "\t\t\tpIvarTypeEncoding = pNameEnd + 1;\n"
+        "\t\t}\n\n"
+        "\t\tif( *pIvarTypeEncoding != *pTypeEncoding )\n"
+        "\t\t{\n"
+        "\t\t\treturn 0;\n"
+        "\t\t}\n\n"
+        "\t\tif( *pTypeEncoding == 0 )\n"
+        "\t\t{\n"
+        "\t\t\treturn ivar_getOffset( pIvar );\n"
+        "\t\t}\n\n"
+        "\t\t++pIvarTypeEncoding;\n"
+        "\t\t++pTypeEncoding;\n"
+        "\t}\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
 
-    sprintf( pHeaderFileName, "%s%s%s.h", pOutputPath, pFilePrefix, className.pNameLower );
-    sprintf( pSourceFileName, "%s%s%s.c", pOutputPath, pFilePrefix, className.pNameLower );
+void file_write_c_runtime_header_direct_entry_points( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Dedicated runtime entry points for retain/release/autorelease/alloc that skip the regular message lookup.\n"
+        "// objc_retain/objc_release/objc_autorelease are exported by Apple's runtime (OS X 10.7+) and by GNUstep libobjc2.\n"
+        "// objc_alloc/objc_alloc_init need macOS 10.14.4/iOS 12.2 or libobjc2 2.2, define C_OCOA_HAS_DIRECT_ALLOC to 1\n"
+        "// when targeting a GNUstep runtime that provides them.\n"
+        "#ifndef C_OCOA_HAS_DIRECT_RETAIN_RELEASE\n"
+        "#define C_OCOA_HAS_DIRECT_RETAIN_RELEASE 1\n"
+        "#endif\n\n"
+        "#ifndef C_OCOA_HAS_DIRECT_ALLOC\n"
+        "#if defined(__MAC_OS_X_VERSION_MIN_REQUIRED) && __MAC_OS_X_VERSION_MIN_REQUIRED >= 101404\n"
+        "#define C_OCOA_HAS_DIRECT_ALLOC 1\n"
+        "#elif defined(__IPHONE_OS_VERSION_MIN_REQUIRED) && __IPHONE_OS_VERSION_MIN_REQUIRED >= 120200\n"
+        "#define C_OCOA_HAS_DIRECT_ALLOC 1\n"
+        "#else\n"
+        "#define C_OCOA_HAS_DIRECT_ALLOC 0\n"
+        "#endif\n"
+        "#endif\n\n"
+        "#if C_OCOA_HAS_DIRECT_RETAIN_RELEASE\n"
+        "id\t\tobjc_retain( id pObject );\n"
+        "void\tobjc_release( id pObject );\n"
+        "id\t\tobjc_autorelease( id pObject );\n"
+        "#endif\n\n"
+        "#if C_OCOA_HAS_DIRECT_ALLOC\n"
+        "id\t\tobjc_alloc( Class pClass );\n"
+        "id\t\tobjc_alloc_init( Class pClass );\n"
+        "#endif\n\n"
+        "static inline id c_ocoa_retain( id pObject )\n"
+        "{\n"
+        "#if C_OCOA_HAS_DIRECT_RETAIN_RELEASE\n"
+        "\treturn objc_retain( pObject );\n"
+        "#else\n"
+        "\tstatic SEL retainSelector = NULL;\n"
+        "\tif( retainSelector == NULL )\n"
+        "\t{\n"
+        "\t\tretainSelector = sel_registerName( \"retain\" );\n"
+        "\t}\n"
+        "\treturn ((id (*)( id, SEL ))objc_msgSend)( pObject, retainSelector );\n"
+        "#endif\n"
+        "}\n\n"
+        "static inline void c_ocoa_release( id pObject )\n"
+        "{\n"
+        "#if C_OCOA_HAS_DIRECT_RETAIN_RELEASE\n"
+        "\tobjc_release( pObject );\n"
+        "#else\n"
+        "\tstatic SEL releaseSelector = NULL;\n"
+        "\tif( releaseSelector == NULL )\n"
+        "\t{\n"
+        "\t\treleaseSelector = sel_registerName( \"release\" );\n"
+        "\t}\n"
+        "\t((void (*)( id, SEL ))objc_msgSend)( pObject, releaseSelector );\n"
+        "#endif\n"
+        "}\n\n"
+        "static inline id c_ocoa_autorelease( id pObject )\n"
+        "{\n"
+        "#if C_OCOA_HAS_DIRECT_RETAIN_RELEASE\n"
+        "\treturn objc_autorelease( pObject );\n"
+        "#else\n"
+        "\tstatic SEL autoreleaseSelector = NULL;\n"
+        "\tif( autoreleaseSelector == NULL )\n"
+        "\t{\n"
+        "\t\tautoreleaseSelector = sel_registerName( \"autorelease\" );\n"
+        "\t}\n"
+        "\treturn ((id (*)( id, SEL ))objc_msgSend)( pObject, autoreleaseSelector );\n"
+        "#endif\n"
+        "}\n\n"
+        "static inline id c_ocoa_alloc( Class pClass )\n"
+        "{\n"
+        "#if C_OCOA_HAS_DIRECT_ALLOC\n"
+        "\treturn objc_alloc( pClass );\n"
+        "#else\n"
+        "\tstatic SEL allocSelector = NULL;\n"
+        "\tif( allocSelector == NULL )\n"
+        "\t{\n"
+        "\t\tallocSelector = sel_registerName( \"alloc\" );\n"
+        "\t}\n"
+        "\treturn ((id (*)( id, SEL ))objc_msgSend)( (id)pClass, allocSelector );\n"
+        "#endif\n"
+        "}\n\n"
+        "// Same as '[[pClass alloc] init]'\n"
+        "static inline id c_ocoa_alloc_init( Class pClass )\n"
+        "{\n"
+        "#if C_OCOA_HAS_DIRECT_ALLOC\n"
+        "\treturn objc_alloc_init( pClass );\n"
+        "#else\n"
+        "\tstatic SEL initSelector = NULL;\n"
+        "\tif( initSelector == NULL )\n"
+        "\t{\n"
+        "\t\tinitSelector = sel_registerName( \"init\" );\n"
+        "\t}\n"
+        "\treturn ((id (*)( id, SEL ))objc_msgSend)( c_ocoa_alloc( pClass ), initSelector );\n"
+        "#endif\n"
+        "}\n\n"
+        "// Releases 'count' objects, NULL entries are skipped.\n"
+        "void\tc_ocoa_release_array( void* const* ppObjects, size_t count );\n\n",
+        pRuntimeHeaderFileHandle );
+}
 
-    FILE* pSourceFileHandle = pParameter->fopen( pSourceFileName, "w" );
-    FILE* pHeaderFileHandle = pParameter->fopen( pHeaderFileName, "w" );
+void file_write_c_runtime_source_direct_entry_points( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "void c_ocoa_release_array( void* const* ppObjects, size_t count )\n"
+        "{\n"
+        "\tfor( size_t objectIndex = 0u; objectIndex < count; ++objectIndex )\n"
+        "\t{\n"
+        "\t\tif( ppObjects[ objectIndex ] != NULL )\n"
+        "\t\t{\n"
+        "\t\t\tc_ocoa_release( (id)ppObjects[ objectIndex ] );\n"
+        "\t\t}\n"
+        "\t}\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
 
-    if( pSourceFileHandle == NULL )
-    {
-        printf_stderr( "[error] Couldn't open '%s' for writing.\n", pSourceFileName );
-        return 0u;
-    }
+void file_write_c_runtime_header_autorelease_pool( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Autorelease pools without going through NSAutoreleasePool, same as what '@autoreleasepool' compiles to.\n"
+        "// Exported by Apple's runtime (OS X 10.7+) and by GNUstep libobjc2.\n"
+        "void*\tobjc_autoreleasePoolPush( void );\n"
+        "void\tobjc_autoreleasePoolPop( void* pPool );\n\n"
+        "static inline void* c_ocoa_autoreleasepool_push( void )\n"
+        "{\n"
+        "\treturn objc_autoreleasePoolPush();\n"
+        "}\n\n"
+        "// Releases all objects that have been autoreleased since the matching push. Pools have to be popped in reverse order.\n"
+        "static inline void c_ocoa_autoreleasepool_pop( void* pPool )\n"
+        "{\n"
+        "\tobjc_autoreleasePoolPop( pPool );\n"
+        "}\n\n"
+        "static inline void c_ocoa_autoreleasepool_scope_exit( void** ppPool )\n"
+        "{\n"
+        "\tc_ocoa_autoreleasepool_pop( *ppPool );\n"
+        "}\n\n"
+        "// Scoped form, usage: 'c_ocoa_autoreleasepool { ... }'.\n"
+        "// The pool is popped when the scope is left (including via return/goto).\n"
+        "// Note: 'break'/'continue' inside the scope leave the scope and not the surrounding loop.\n"
+        "#define c_ocoa_autoreleasepool c_ocoa_autoreleasepool_scope( __COUNTER__ )\n"
+        "#define c_ocoa_autoreleasepool_scope( counter ) c_ocoa_autoreleasepool_scope_impl( counter )\n"
+        "#define c_ocoa_autoreleasepool_scope_impl( counter ) \\\n"
+        "\tfor( void *c_ocoa_autoreleasepool_handle##counter __attribute__((cleanup(c_ocoa_autoreleasepool_scope_exit))) = c_ocoa_autoreleasepool_push(), \\\n"
+        "\t\t*c_ocoa_autoreleasepool_once##counter = (void*)1; c_ocoa_autoreleasepool_once##counter != NULL; c_ocoa_autoreleasepool_once##counter = NULL )\n\n",
+        pRuntimeHeaderFileHandle );
+}
 
-    if( pHeaderFileName == NULL )
-    {
-        printf_stderr( "[error] Couldn't open '%s' for writing.\n", pHeaderFileName );
-        return 0u;
-    }
+void file_write_c_runtime_header_blocks( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Block literals that get built on the stack (see clang's Block ABI), used by the '<wrapper>_callback()' variants\n"
+        "// of methods that take blocks. 'pInvoke' gets called with the block as first argument followed by the arguments\n"
+        "// of the block, eg: for 'void (^)( id object, NSUInteger index, BOOL* pStop )' of 'enumerateObjectsUsingBlock:':\n"
+        "// void callback( c_ocoa_block_t* pBlock, nsobject_t object, unsigned long long index, char* pStop )\n"
+        "// Use c_ocoa_block_get_context() to get the context. Blocks that the callee keeps around are copied to the heap\n"
+        "// by the callee (context pointer included), in that case the context has to outlive the call.\n"
+        "// The block signature (eg: 'v@?@Q^B') is only known if the runtime reports the extended type encoding of the\n"
+        "// method, in that case the block is flagged with C_OCOA_BLOCK_HAS_SIGNATURE (see c_ocoa_block_init_with_descriptor()).\n"
+        "extern void* _NSConcreteStackBlock[32];\n\n"
+        "#define C_OCOA_BLOCK_HAS_SIGNATURE\t(1 << 30)\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\tunsigned long\treserved;\n"
+        "\tunsigned long\tsize;\n"
+        "\tconst char*\t\tpSignature;\t// only read if the block has C_OCOA_BLOCK_HAS_SIGNATURE set\n"
+        "} c_ocoa_block_descriptor_t;\n\n"
+        "// Has to be cast to the actual signature of the callback.\n"
+        "typedef void (*c_ocoa_block_invoke_fn)( void );\n\n"
+        "typedef struct c_ocoa_block\n"
+        "{\n"
+        "\tvoid*\t\t\t\t\t\t\t\tpIsa;\n"
+        "\tint\t\t\t\t\t\t\t\t\tflags;\n"
+        "\tint\t\t\t\t\t\t\t\t\treserved;\n"
+        "\tc_ocoa_block_invoke_fn\t\t\t\tpInvoke;\n"
+        "\tconst c_ocoa_block_descriptor_t*\tpDescriptor;\n"
+        "\tvoid*\t\t\t\t\t\t\t\tpContext;\n"
+        "} c_ocoa_block_t;\n\n"
+        "extern const c_ocoa_block_descriptor_t c_ocoa_block_descriptor;\n\n"
+        "//FK: No copy/dispose helpers needed, the captured function and context are plain pointers\n"
+        "static inline void c_ocoa_block_init_with_descriptor( c_ocoa_block_t* pBlock, c_ocoa_block_invoke_fn pInvoke, void* pContext, const c_ocoa_block_descriptor_t* pDescriptor )\n"
+        "{\n"
+        "\tpBlock->pIsa\t\t\t= (void*)_NSConcreteStackBlock;\n"
+        "\tpBlock->flags\t\t\t= pDescriptor->pSignature != NULL ? C_OCOA_BLOCK_HAS_SIGNATURE : 0;\n"
+        "\tpBlock->reserved\t\t= 0;\n"
+        "\tpBlock->pInvoke\t\t\t= pInvoke;\n"
+        "\tpBlock->pDescriptor\t\t= pDescriptor;\n"
+        "\tpBlock->pContext\t\t= pContext;\n"
+        "}\n\n"
+        "// Builds a block without signature.\n"
+        "static inline void c_ocoa_block_init( c_ocoa_block_t* pBlock, c_ocoa_block_invoke_fn pInvoke, void* pContext )\n"
+        "{\n"
+        "\tc_ocoa_block_init_with_descriptor( pBlock, pInvoke, pContext, &c_ocoa_block_descriptor );\n"
+        "}\n\n"
+        "static inline void* c_ocoa_block_get_context( const void* pBlock )\n"
+        "{\n"
+        "\treturn ((const c_ocoa_block_t*)pBlock)->pContext;\n"
+        "}\n\n",
+        pRuntimeHeaderFileHandle );
+}
 
-    file_write_c_header_prefix( pHeaderFileHandle, &className );
-    file_write_c_source_prefix( pSourceFileHandle, pHeaderFileName, &className );
+void file_write_c_runtime_source_blocks( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "const c_ocoa_block_descriptor_t c_ocoa_block_descriptor = { 0u, sizeof( c_ocoa_block_t ), NULL };\n\n",
+        pRuntimeSourceFileHandle );
+}
 
-    c_ocoa_source_code_generator_input codeGenInput;
-    codeGenInput.pHeaderFileHandle      = pHeaderFileHandle;
-    codeGenInput.pSourceFileHandle      = pSourceFileHandle;
-    codeGenInput.pStringAllocator       = pStringAllocator;
-    codeGenInput.pTypeDict              = pTypeDict;
-    codeGenInput.pFunctionCollection    = pFunctionCollection;
-    codeGenInput.pClassName             = &className;
-    c_ocoa_create_source_code_for_objc_method_collection( &c_ocoa_class_method_collection, &codeGenInput );
-    
-    file_write_c_header_suffix( pHeaderFileHandle );
-    
-    pParameter->fclose( pHeaderFileHandle );
-    pParameter->fclose( pSourceFileHandle );
+void file_write_c_runtime_header_collections( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Same layout as NSFastEnumerationState\n"
+        "typedef struct\n"
+        "{\n"
+        "\tunsigned long\tstate;\n"
+        "\tid*\t\t\t\tppItems;\n"
+        "\tunsigned long*\tpMutations;\n"
+        "\tunsigned long\textra[5];\n"
+        "} c_ocoa_fast_enumeration_state_t;\n\n"
+        "#define C_OCOA_COLLECTION_ITERATOR_BATCH_SIZE 64\n\n"
+        "// Iterates over NSArray/NSSet objects and NSDictionary keys via 'countByEnumeratingWithState:objects:count:'.\n"
+        "// Only one message is sent per batch of objects instead of one per object.\n"
+        "typedef struct\n"
+        "{\n"
+        "\tc_ocoa_fast_enumeration_state_t\tstate;\n"
+        "\tid\t\t\t\t\t\t\t\tpCollection;\n"
+        "\tunsigned long\t\t\t\t\tmutations;\n"
+        "\tsize_t\t\t\t\t\t\t\titemIndex;\n"
+        "\tsize_t\t\t\t\t\t\t\titemCount;\n"
+        "\tid\t\t\t\t\t\t\t\tbuffer[ C_OCOA_COLLECTION_ITERATOR_BATCH_SIZE ];\n"
+        "} c_ocoa_collection_iterator_t;\n\n"
+        "// Same layout as NSRange\n"
+        "typedef struct\n"
+        "{\n"
+        "\tuintptr_t\tlocation;\n"
+        "\tuintptr_t\tlength;\n"
+        "} c_ocoa_range_t;\n\n"
+        "void\tobjc_enumerationMutation( id pObject );\n\n"
+        "void\tc_ocoa_collection_iterator_begin( c_ocoa_collection_iterator_t* pIterator, id pCollection );\n"
+        "int\t\tc_ocoa_collection_iterator_refill( c_ocoa_collection_iterator_t* pIterator );\n\n"
+        "// Returns 0 once all objects have been enumerated. Mutating the collection while iterating raises an exception.\n"
+        "static inline int c_ocoa_collection_iterator_next( c_ocoa_collection_iterator_t* pIterator, void** ppOutObject )\n"
+        "{\n"
+        "\tif( pIterator->itemIndex == pIterator->itemCount && !c_ocoa_collection_iterator_refill( pIterator ) )\n"
+        "\t{\n"
+        "\t\treturn 0;\n"
+        "\t}\n\n"
+        "\tif( *pIterator->state.pMutations != pIterator->mutations )\n"
+        "\t{\n"
+        "\t\tobjc_enumerationMutation( pIterator->pCollection );\n"
+        "\t}\n\n"
+        "\t*ppOutObject = pIterator->state.ppItems[ pIterator->itemIndex++ ];\n"
+        "\treturn 1;\n"
+        "}\n\n"
+        "// Copies 'length' objects starting at 'location' using a single 'getObjects:range:' message.\n"
+        "void\tc_ocoa_array_get_objects( id pArray, size_t location, size_t length, void** ppOutObjects );\n\n"
+        "// Copies up to 'count' objects and their keys using a single 'getObjects:andKeys:count:' message.\n"
+        "// Either 'ppOutObjects' or 'ppOutKeys' may be NULL.\n"
+        "void\tc_ocoa_dictionary_get_objects_and_keys( id pDictionary, void** ppOutObjects, void** ppOutKeys, size_t count );\n\n",
+        pRuntimeHeaderFileHandle );
+}
 
-    return 1u;
-};
+void file_write_c_runtime_source_collections( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "void c_ocoa_collection_iterator_begin( c_ocoa_collection_iterator_t* pIterator, id pCollection )\n"
+        "{\n"
+        "\tconst c_ocoa_fast_enumeration_state_t initialState = { 0 };\n"
+        "\tpIterator->state\t\t= initialState;\n"
+        "\tpIterator->pCollection\t= pCollection;\n"
+        "\tpIterator->mutations\t= 0u;\n"
+        "\tpIterator->itemIndex\t= 0u;\n"
+        "\tpIterator->itemCount\t= 0u;\n"
+        "}\n\n"
+        "int c_ocoa_collection_iterator_refill( c_ocoa_collection_iterator_t* pIterator )\n"
+        "{\n"
+        "\tstatic SEL enumerateSelector = NULL;\n"
+        "\tif( enumerateSelector == NULL )\n"
+        "\t{\n"
+        "\t\tenumerateSelector = sel_registerName( \"countByEnumeratingWithState:objects:count:\" );\n"
+        "\t}\n\n"
+        "\tif( pIterator->pCollection == NULL )\n"
+        "\t{\n"
+        "\t\treturn 0;\n"
+        "\t}\n\n"
+        "\tconst int isFirstBatch = pIterator->state.state == 0u;\n"
+        "\tconst unsigned long itemCount = ((unsigned long (*)( id, SEL, c_ocoa_fast_enumeration_state_t*, id*, unsigned long ))objc_msgSend)( pIterator->pCollection, enumerateSelector, &pIterator->state, pIterator->buffer, C_OCOA_COLLECTION_ITERATOR_BATCH_SIZE );\n"
+        "\tif( itemCount == 0u )\n"
+        "\t{\n"
+        "\t\tpIterator->pCollection = NULL;\n"
+        "\t\treturn 0;\n"
+        "\t}\n\n"
+        "\tif( isFirstBatch )\n"
+        "\t{\n"
+        "\t\tpIterator->mutations = *pIterator->state.pMutations;\n"
+        "\t}\n\n"
+        "\tpIterator->itemIndex = 0u;\n"
+        "\tpIterator->itemCount = itemCount;\n"
+        "\treturn 1;\n"
+        "}\n\n"
+        "void c_ocoa_array_get_objects( id pArray, size_t location, size_t length, void** ppOutObjects )\n"
+        "{\n"
+        "\tstatic SEL getObjectsSelector = NULL;\n"
+        "\tif( getObjectsSelector == NULL )\n"
+        "\t{\n"
+        "\t\tgetObjectsSelector = sel_registerName( \"getObjects:range:\" );\n"
+        "\t}\n\n"
+        "\tif( pArray == NULL || length == 0u )\n"
+        "\t{\n"
+        "\t\treturn;\n"
+        "\t}\n\n"
+        "\tconst c_ocoa_range_t range = { location, length };\n"
+        "\t((void (*)( id, SEL, void**, c_ocoa_range_t ))objc_msgSend)( pArray, getObjectsSelector, ppOutObjects, range );\n"
+        "}\n\n"
+        "void c_ocoa_dictionary_get_objects_and_keys( id pDictionary, void** ppOutObjects, void** ppOutKeys, size_t count )\n"
+        "{\n"
+        "\tstatic SEL getObjectsAndKeysSelector = NULL;\n"
+        "\tif( getObjectsAndKeysSelector == NULL )\n"
+        "\t{\n"
+        "\t\tgetObjectsAndKeysSelector = sel_registerName( \"getObjects:andKeys:count:\" );\n"
+        "\t}\n\n"
+        "\tif( pDictionary == NULL || count == 0u )\n"
+        "\t{\n"
+        "\t\treturn;\n"
+        "\t}\n\n"
+        "\t((void (*)( id, SEL, void**, void**, uintptr_t ))objc_msgSend)( pDictionary, getObjectsAndKeysSelector, ppOutObjects, ppOutKeys, count );\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
 
-int c_ocoa_create_classes_api( const c_ocoa_code_generator_parameter* pCodeGeneratorParameter, c_ocoa_code_gen_context* pContext )
+void file_write_c_runtime_header_strings( FILE* pRuntimeHeaderFileHandle )
 {
-    const int totalClassCount = objc_getClassList( NULL, 0 );
-    const size_t totalClassBufferSizeInBytes = totalClassCount * sizeof( Class );
-    Class* ppClasses = ( Class* )malloc( totalClassBufferSizeInBytes );
-    if( ppClasses == NULL )
-    {
-        printf_stderr( "Out of memory - Couldn't allocate %.3fkB.", (float)totalClassBufferSizeInBytes/1024.f );
-        return 2;
-    }
-    
-    objc_getClassList(ppClasses, totalClassCount);
-    
-    const uint32_t maxClasses = totalClassCount;
-    for( uint32_t classIndex = 0u; classIndex < maxClasses; ++classIndex )
-    {
-        Class pClass = ppClasses[ classIndex ];
-        const char* pClassName = class_getName( pClass );
-        const int32_t classNameLength = string_get_length_incl_null_terminator( pClassName );
+    fputs(
+        "#define C_OCOA_UTF8_STRING_ENCODING 4u // NSUTF8StringEncoding\n\n"
+        "// Creates a string of class 'pStringClass' that references the UTF-8 text in 'pUTF8String' without copying it.\n"
+        "// The buffer has to outlive the string unless 'freeWhenDone' is set, in which case the string takes ownership\n"
+        "// of the buffer and frees it using free(). The returned string is retained (+1).\n"
+        "id\t\tc_ocoa_string_create_no_copy( Class pStringClass, const char* pUTF8String, size_t length, int freeWhenDone );\n\n"
+        "// Copies the string as null terminated UTF-8 into 'pBuffer'. Returns 0 if 'bufferSize' is too small.\n"
+        "int\t\tc_ocoa_string_get_utf8( id pString, char* pBuffer, size_t bufferSize );\n\n"
+        "// Converts the first 'length' UTF-16 code units of the string to UTF-8 without null terminator.\n"
+        "// Conversion stops once 'pBuffer' is full. Returns the number of bytes written.\n"
+        "size_t\tc_ocoa_string_get_utf8_bytes( id pString, size_t length, char* pBuffer, size_t bufferSize );\n\n"
+        "// Copies 'length' UTF-16 code units starting at 'location' into 'pOutCharacters'.\n"
+        "void\tc_ocoa_string_get_utf16( id pString, size_t location, size_t length, uint16_t* pOutCharacters );\n\n",
+        pRuntimeHeaderFileHandle );
+}
 
-        c_ocoa_create_source_code_for_objc_class( pCodeGeneratorParameter, &pContext->typeDict, &pContext->functionCollection, &pContext->stringAllocator, pClass, pClassName, classNameLength );
-        string_allocator_reset( &pContext->stringAllocator );
-    }
+void file_write_c_runtime_source_strings( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "id c_ocoa_string_create_no_copy( Class pStringClass, const char* pUTF8String, size_t length, int freeWhenDone )\n"
+        "{\n"
+        "\tstatic SEL initSelector = NULL;\n"
+        "\tif( initSelector == NULL )\n"
+        "\t{\n"
+        "\t\tinitSelector = sel_registerName( \"initWithBytesNoCopy:length:encoding:freeWhenDone:\" );\n"
+        "\t}\n\n"
+        "\tid pString = c_ocoa_alloc( pStringClass );\n"
+        "\treturn ((id (*)( id, SEL, void*, uintptr_t, uintptr_t, BOOL ))objc_msgSend)( pString, initSelector, (void*)pUTF8String, length, C_OCOA_UTF8_STRING_ENCODING, freeWhenDone ? YES : NO );\n"
+        "}\n\n"
+        "int c_ocoa_string_get_utf8( id pString, char* pBuffer, size_t bufferSize )\n"
+        "{\n"
+        "\tstatic SEL getCStringSelector = NULL;\n"
+        "\tif( getCStringSelector == NULL )\n"
+        "\t{\n"
+        "\t\tgetCStringSelector = sel_registerName( \"getCString:maxLength:encoding:\" );\n"
+        "\t}\n\n"
+        "\tif( pString == NULL || bufferSize == 0u )\n"
+        "\t{\n"
+        "\t\treturn 0;\n"
+        "\t}\n\n"
+        "\treturn ((BOOL (*)( id, SEL, char*, uintptr_t, uintptr_t ))objc_msgSend)( pString, getCStringSelector, pBuffer, bufferSize, C_OCOA_UTF8_STRING_ENCODING ) ? 1 : 0;\n"
+        "}\n\n"
+        "size_t c_ocoa_string_get_utf8_bytes( id pString, size_t length, char* pBuffer, size_t bufferSize )\n"
+        "{\n"
+        "\tstatic SEL getBytesSelector = NULL;\n"
+        "\tif( getBytesSelector == NULL )\n"
+        "\t{\n"
+        "\t\tgetBytesSelector = sel_registerName( \"getBytes:maxLength:usedLength:encoding:options:range:remainingRange:\" );\n"
+        "\t}\n\n"
+        "\tif( pString == NULL || length == 0u || bufferSize == 0u )\n"
+        "\t{\n"
+        "\t\treturn 0u;\n"
+        "\t}\n\n"
+        "\tuintptr_t usedLength = 0u;\n"
+        "\tconst c_ocoa_range_t range = { 0u, length };\n"
+        "\t((BOOL (*)( id, SEL, void*, uintptr_t, uintptr_t*, uintptr_t, uintptr_t, c_ocoa_range_t, c_ocoa_range_t* ))objc_msgSend)( pString, getBytesSelector, pBuffer, bufferSize, &usedLength, C_OCOA_UTF8_STRING_ENCODING, 0u, range, NULL );\n"
+        "\treturn usedLength;\n"
+        "}\n\n"
+        "void c_ocoa_string_get_utf16( id pString, size_t location, size_t length, uint16_t* pOutCharacters )\n"
+        "{\n"
+        "\tstatic SEL getCharactersSelector = NULL;\n"
+        "\tif( getCharactersSelector == NULL )\n"
+        "\t{\n"
+        "\t\tgetCharactersSelector = sel_registerName( \"getCharacters:range:\" );\n"
+        "\t}\n\n"
+        "\tif( pString == NULL || length == 0u )\n"
+        "\t{\n"
+        "\t\treturn;\n"
+        "\t}\n\n"
+        "\tconst c_ocoa_range_t range = { location, length };\n"
+        "\t((void (*)( id, SEL, uint16_t*, c_ocoa_range_t ))objc_msgSend)( pString, getCharactersSelector, pOutCharacters, range );\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
 
-    free( ppClasses );
+void file_write_c_runtime_header_data( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "typedef struct\n"
+        "{\n"
+        "\tconst void*\tpBytes;\n"
+        "\tsize_t\t\tlength;\n"
+        "} c_ocoa_data_view_t;\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\tvoid*\t\tpBytes;\n"
+        "\tsize_t\t\tlength;\n"
+        "} c_ocoa_mutable_data_view_t;\n\n"
+        "// Called once the data object doesn't reference 'pBytes' anymore.\n"
+        "typedef void (*c_ocoa_data_deallocator_fn)( void* pBytes, size_t length, void* pUserData );\n\n"
+        "// Creates a data object of class 'pDataClass' that references 'pBytes' without copying.\n"
+        "// If 'pDeallocator' is NULL the caller keeps ownership and 'pBytes' has to outlive the data object.\n"
+        "// The deallocator is passed as block (needs macOS 10.9/iOS 7 or GNUstep base 1.25). Returns a retained (+1) object.\n"
+        "id\t\t\t\t\t\t\tc_ocoa_data_create_no_copy( Class pDataClass, void* pBytes, size_t length, c_ocoa_data_deallocator_fn pDeallocator, void* pUserData );\n"
+        "c_ocoa_data_view_t\t\t\tc_ocoa_data_get_view( id pData );\n"
+        "c_ocoa_mutable_data_view_t\tc_ocoa_mutable_data_get_view( id pMutableData );\n\n"
+        "// Copies 'length' bytes starting at 'location' into 'pOutBytes'.\n"
+        "void\t\t\t\t\t\tc_ocoa_data_get_bytes( id pData, size_t location, size_t length, void* pOutBytes );\n\n",
+        pRuntimeHeaderFileHandle );
+}
 
-    FILE* pTypesFileHandle = pCodeGeneratorParameter->fopen( "c_ocoa_types.h", "w" );
-    if( pTypesFileHandle == NULL )
-    {
-        printf_stderr( "Could not open '%s' for writing.", "c_ocoa_types.h" );
-        return 0;
-    }
+void file_write_c_runtime_source_data( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "//FK: Hand-built block literal for 'void (^)( void* bytes, NSUInteger length )' (see clang's Block ABI).\n"
+        "//    The block is created on the stack, NSData copies it (including the captured function and user data)\n"
+        "//    to the heap if it needs to keep it around.\n"
+        "typedef struct c_ocoa_data_deallocator_block\n"
+        "{\n"
+        "\tvoid*\t\t\t\t\t\t\t\tpIsa;\n"
+        "\tint\t\t\t\t\t\t\t\t\tflags;\n"
+        "\tint\t\t\t\t\t\t\t\t\treserved;\n"
+        "\tvoid\t\t\t\t\t\t\t\t(*pInvoke)( struct c_ocoa_data_deallocator_block* pBlock, void* pBytes, uintptr_t length );\n"
+        "\tconst c_ocoa_block_descriptor_t*\tpDescriptor;\n"
+        "\tc_ocoa_data_deallocator_fn\t\t\tpDeallocator;\n"
+        "\tvoid*\t\t\t\t\t\t\t\tpUserData;\n"
+        "} c_ocoa_data_deallocator_block_t;\n\n"
+        "static void c_ocoa_data_deallocator_block_invoke( c_ocoa_data_deallocator_block_t* pBlock, void* pBytes, uintptr_t length )\n"
+        "{\n"
+        "\tpBlock->pDeallocator( pBytes, length, pBlock->pUserData );\n"
+        "}\n\n"
+        "#ifdef __LP64__\n"
+        "static const c_ocoa_block_descriptor_t c_ocoa_data_deallocator_block_descriptor = { 0u, sizeof( c_ocoa_data_deallocator_block_t ), \"v@?^vQ\" };\n"
+        "#else\n"
+        "static const c_ocoa_block_descriptor_t c_ocoa_data_deallocator_block_descriptor = { 0u, sizeof( c_ocoa_data_deallocator_block_t ), \"v@?^vI\" };\n"
+        "#endif\n\n"
+        "id c_ocoa_data_create_no_copy( Class pDataClass, void* pBytes, size_t length, c_ocoa_data_deallocator_fn pDeallocator, void* pUserData )\n"
+        "{\n"
+        "\tstatic SEL initDeallocatorSelector = NULL;\n"
+        "\tstatic SEL initFreeWhenDoneSelector = NULL;\n"
+        "\tif( initDeallocatorSelector == NULL )\n"
+        "\t{\n"
+        "\t\tinitDeallocatorSelector = sel_registerName( \"initWithBytesNoCopy:length:deallocator:\" );\n"
+        "\t\tinitFreeWhenDoneSelector = sel_registerName( \"initWithBytesNoCopy:length:freeWhenDone:\" );\n"
+        "\t}\n\n"
+        "\tid pData = c_ocoa_alloc( pDataClass );\n"
+        "\tif( pDeallocator == NULL )\n"
+        "\t{\n"
+        "\t\treturn ((id (*)( id, SEL, void*, uintptr_t, BOOL ))objc_msgSend)( pData, initFreeWhenDoneSelector, pBytes, length, NO );\n"
+        "\t}\n\n"
+        "\tc_ocoa_data_deallocator_block_t deallocatorBlock;\n"
+        "\tdeallocatorBlock.pIsa\t\t\t= (void*)_NSConcreteStackBlock;\n"
+        "\tdeallocatorBlock.flags\t\t\t= C_OCOA_BLOCK_HAS_SIGNATURE;\n"
+        "\tdeallocatorBlock.reserved\t\t= 0;\n"
+        "\tdeallocatorBlock.pInvoke\t\t= c_ocoa_data_deallocator_block_invoke;\n"
+        "\tdeallocatorBlock.pDescriptor\t= &c_ocoa_data_deallocator_block_descriptor;\n"
+        "\tdeallocatorBlock.pDeallocator\t= pDeallocator;\n"
+        "\tdeallocatorBlock.pUserData\t\t= pUserData;\n\n"
+        "\treturn ((id (*)( id, SEL, void*, uintptr_t, void* ))objc_msgSend)( pData, initDeallocatorSelector, pBytes, length, &deallocatorBlock );\n"
+        "}\n\n"
+        "c_ocoa_data_view_t c_ocoa_data_get_view( id pData )\n"
+        "{\n"
+        "\tstatic SEL bytesSelector = NULL;\n"
+        "\tstatic SEL lengthSelector = NULL;\n"
+        "\tif( bytesSelector == NULL )\n"
+        "\t{\n"
+        "\t\tbytesSelector = sel_registerName( \"bytes\" );\n"
+        "\t\tlengthSelector = sel_registerName( \"length\" );\n"
+        "\t}\n\n"
+        "\tc_ocoa_data_view_t view = { NULL, 0u };\n"
+        "\tif( pData != NULL )\n"
+        "\t{\n"
+        "\t\tview.length = ((uintptr_t (*)( id, SEL ))objc_msgSend)( pData, lengthSelector );\n"
+        "\t\tview.pBytes = ((const void* (*)( id, SEL ))objc_msgSend)( pData, bytesSelector );\n"
+        "\t}\n\n"
+        "\treturn view;\n"
+        "}\n\n"
+        "c_ocoa_mutable_data_view_t c_ocoa_mutable_data_get_view( id pMutableData )\n"
+        "{\n"
+        "\tstatic SEL mutableBytesSelector = NULL;\n"
+        "\tstatic SEL lengthSelector = NULL;\n"
+        "\tif( mutableBytesSelector == NULL )\n"
+        "\t{\n"
+        "\t\tmutableBytesSelector = sel_registerName( \"mutableBytes\" );\n"
+        "\t\tlengthSelector = sel_registerName( \"length\" );\n"
+        "\t}\n\n"
+        "\tc_ocoa_mutable_data_view_t view = { NULL, 0u };\n"
+        "\tif( pMutableData != NULL )\n"
+        "\t{\n"
+        "\t\tview.length = ((uintptr_t (*)( id, SEL ))objc_msgSend)( pMutableData, lengthSelector );\n"
+        "\t\tview.pBytes = ((void* (*)( id, SEL ))objc_msgSend)( pMutableData, mutableBytesSelector );\n"
+        "\t}\n\n"
+        "\treturn view;\n"
+        "}\n\n"
+        "void c_ocoa_data_get_bytes( id pData, size_t location, size_t length, void* pOutBytes )\n"
+        "{\n"
+        "\tstatic SEL getBytesSelector = NULL;\n"
+        "\tif( getBytesSelector == NULL )\n"
+        "\t{\n"
+        "\t\tgetBytesSelector = sel_registerName( \"getBytes:range:\" );\n"
+        "\t}\n\n"
+        "\tif( pData == NULL || length == 0u )\n"
+        "\t{\n"
+        "\t\treturn;\n"
+        "\t}\n\n"
+        "\tconst c_ocoa_range_t range = { location, length };\n"
+        "\t((void (*)( id, SEL, void*, c_ocoa_range_t ))objc_msgSend)( pData, getBytesSelector, pOutBytes, range );\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
 
-    objc_type_dict_resolve_struct_types( &pContext->typeDict, pTypesFileHandle, pCodeGeneratorParameter->exportTypes );
-    
-    pCodeGeneratorParameter->fflush( pTypesFileHandle );
-    pCodeGeneratorParameter->fclose( pTypesFileHandle );
-    
-    return 0;
+void file_write_c_runtime_header_event_pump( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Pre-decoded NSEvent, only the fields that are valid for the event type are set - everything else is 0.\n"
+        "typedef struct\n"
+        "{\n"
+        "\tdouble\t\tlocationX;\t\t\t\t\t// locationInWindow (mouse and scroll wheel events)\n"
+        "\tdouble\t\tlocationY;\n"
+        "\tdouble\t\tdeltaX;\t\t\t\t\t\t// deltaX/deltaY (mouse events), scrollingDeltaX/scrollingDeltaY (scroll wheel events)\n"
+        "\tdouble\t\tdeltaY;\n"
+        "\tdouble\t\ttimestamp;\n"
+        "\tuint64_t\tmodifierFlags;\n"
+        "\tuint32_t\ttype;\t\t\t\t\t\t// NSEventType\n"
+        "\tuint16_t\tkeyCode;\t\t\t\t\t// key down/up and flags changed events\n"
+        "\tuint8_t\t\thasPreciseScrollingDeltas;\n"
+        "\tuint8_t\t\tisRepeat;\t\t\t\t\t// key down events\n"
+        "\tchar\t\tcharacters[ 16 ];\t\t\t// null terminated UTF-8 (key down/up events), empty if it doesn't fit\n"
+        "} c_ocoa_event_t;\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\tid\t\t\tpApplication;\n"
+        "\tid\t\t\tpRunLoopMode;\n"
+        "\tid\t\t\tpDistantPast;\t\t\t\t// retained, reused for every drain\n"
+        "\tSEL\t\t\tnextEventSelector;\n"
+        "\tSEL\t\t\tsendEventSelector;\n"
+        "\tSEL\t\t\ttypeSelector;\n"
+        "\tSEL\t\t\tlocationInWindowSelector;\n"
+        "\tSEL\t\t\tdeltaXSelector;\n"
+        "\tSEL\t\t\tdeltaYSelector;\n"
+        "\tSEL\t\t\tscrollingDeltaXSelector;\n"
+        "\tSEL\t\t\tscrollingDeltaYSelector;\n"
+        "\tSEL\t\t\thasPreciseScrollingDeltasSelector;\n"
+        "\tSEL\t\t\tkeyCodeSelector;\n"
+        "\tSEL\t\t\tisARepeatSelector;\n"
+        "\tSEL\t\t\tcharactersSelector;\n"
+        "\tSEL\t\t\tmodifierFlagsSelector;\n"
+        "\tSEL\t\t\ttimestampSelector;\n"
+        "} c_ocoa_event_pump_t;\n\n"
+        "// Looks up all selectors and the distant past date once. 'pApplication' is the shared NSApplication,\n"
+        "// 'pRunLoopMode' is usually NSDefaultRunLoopMode. Returns 0 if NSDate isn't available.\n"
+        "int\t\tc_ocoa_event_pump_create( c_ocoa_event_pump_t* pOutPump, id pApplication, id pRunLoopMode );\n"
+        "void\tc_ocoa_event_pump_destroy( c_ocoa_event_pump_t* pPump );\n\n"
+        "// Dequeues up to 'maxEventCount' pending events without waiting. Every event gets decoded into 'pOutEvents' and\n"
+        "// forwarded to the application (sendEvent:) before the next one gets dequeued, so tracking loops that run inside of\n"
+        "// sendEvent: (buttons, sliders, window drags, menus) still find the following events in the queue. Everything that\n"
+        "// gets autoreleased in the process is released by one pool per drain. Returns the number of decoded events.\n"
+        "size_t\tc_ocoa_event_pump_drain( c_ocoa_event_pump_t* pPump, c_ocoa_event_t* pOutEvents, size_t maxEventCount );\n\n",
+        pRuntimeHeaderFileHandle );
 }
 
+void file_write_c_runtime_source_event_pump( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "typedef struct\n"
+        "{\n"
+        "\tdouble x;\n"
+        "\tdouble y;\n"
+        "} c_ocoa_event_point_t;\n\n"
+        "int c_ocoa_event_pump_create( c_ocoa_event_pump_t* pOutPump, id pApplication, id pRunLoopMode )\n"
+        "{\n"
+        "\tClass pDateClass = objc_getClass( \"NSDate\" );\n"
+        "\tif( pDateClass == NULL )\n"
+        "\t{\n"
+        "\t\treturn 0;\n"
+        "\t}\n\n"
+        "\tid pDistantPast = ((id (*)( id, SEL ))objc_msgSend)( (id)pDateClass, sel_registerName( \"distantPast\" ) );\n"
+        "\tpOutPump->pApplication\t\t\t\t\t\t= pApplication;\n"
+        "\tpOutPump->pRunLoopMode\t\t\t\t\t\t= pRunLoopMode;\n"
+        "\tpOutPump->pDistantPast\t\t\t\t\t\t= ((id (*)( id, SEL ))objc_msgSend)( pDistantPast, sel_registerName( \"retain\" ) );\n"
+        "\tpOutPump->nextEventSelector\t\t\t\t\t= sel_registerName( \"nextEventMatchingMask:untilDate:inMode:dequeue:\" );\n"
+        "\tpOutPump->sendEventSelector\t\t\t\t\t= sel_registerName( \"sendEvent:\" );\n"
+        "\tpOutPump->typeSelector\t\t\t\t\t\t= sel_registerName( \"type\" );\n"
+        "\tpOutPump->locationInWindowSelector\t\t\t= sel_registerName( \"locationInWindow\" );\n"
+        "\tpOutPump->deltaXSelector\t\t\t\t\t= sel_registerName( \"deltaX\" );\n"
+        "\tpOutPump->deltaYSelector\t\t\t\t\t= sel_registerName( \"deltaY\" );\n"
+        "\tpOutPump->scrollingDeltaXSelector\t\t\t= sel_registerName( \"scrollingDeltaX\" );\n"
+        "\tpOutPump->scrollingDeltaYSelector\t\t\t= sel_registerName( \"scrollingDeltaY\" );\n"
+        "\tpOutPump->hasPreciseScrollingDeltasSelector\t= sel_registerName( \"hasPreciseScrollingDeltas\" );\n"
+        "\tpOutPump->keyCodeSelector\t\t\t\t\t= sel_registerName( \"keyCode\" );\n"
+        "\tpOutPump->isARepeatSelector\t\t\t\t\t= sel_registerName( \"isARepeat\" );\n"
+        "\tpOutPump->charactersSelector\t\t\t\t= sel_registerName( \"characters\" );\n"
+        "\tpOutPump->modifierFlagsSelector\t\t\t\t= sel_registerName( \"modifierFlags\" );\n"
+        "\tpOutPump->timestampSelector\t\t\t\t\t= sel_registerName( \"timestamp\" );\n"
+        "\treturn 1;\n"
+        "}\n\n"
+        "void c_ocoa_event_pump_destroy( c_ocoa_event_pump_t* pPump )\n"
+        "{\n"
+        "\t((void (*)( id, SEL ))objc_msgSend)( pPump->pDistantPast, sel_registerName( \"release\" ) );\n"
+        "\tpPump->pDistantPast = NULL;\n"
+        "}\n\n"
+        "static void c_ocoa_event_pump_decode( const c_ocoa_event_pump_t* pPump, id pEvent, c_ocoa_event_t* pOutEvent )\n"
+        "{\n"
+        "\tconst uint32_t type = (uint32_t)((uintptr_t (*)( id, SEL ))objc_msgSend)( pEvent, pPump->typeSelector );\n"
+        "\tconst c_ocoa_event_t emptyEvent = { 0 };\n"
+        "\t*pOutEvent = emptyEvent;\n"
+        "\tpOutEvent->type\t\t\t= type;\n"
+        "\tpOutEvent->timestamp\t\t= ((double (*)( id, SEL ))objc_msgSend)( pEvent, pPump->timestampSelector );\n"
+        "\tpOutEvent->modifierFlags\t= (uint64_t)((uintptr_t (*)( id, SEL ))objc_msgSend)( pEvent, pPump->modifierFlagsSelector );\n\n"
+        "\t//FK: AppKit raises an exception when asking an event for a property that isn't valid for its type,\n"
+        "\t//    so only decode what the type supports (1-9 and 25-27 are mouse events, 22 is scroll wheel)\n"
+        "\tconst int isMouseEvent = ( type >= 1u && type <= 9u ) || ( type >= 25u && type <= 27u );\n"
+        "\tconst int isScrollWheelEvent = type == 22u;\n"
+        "\tif( isMouseEvent || isScrollWheelEvent )\n"
+        "\t{\n"
+        "\t\tconst c_ocoa_event_point_t location = ((c_ocoa_event_point_t (*)( id, SEL ))objc_msgSend)( pEvent, pPump->locationInWindowSelector );\n"
+        "\t\tpOutEvent->locationX = location.x;\n"
+        "\t\tpOutEvent->locationY = location.y;\n"
+        "\t}\n\n"
+        "\tif( isScrollWheelEvent )\n"
+        "\t{\n"
+        "\t\tpOutEvent->deltaX\t\t\t\t\t\t= ((double (*)( id, SEL ))objc_msgSend)( pEvent, pPump->scrollingDeltaXSelector );\n"
+        "\t\tpOutEvent->deltaY\t\t\t\t\t\t= ((double (*)( id, SEL ))objc_msgSend)( pEvent, pPump->scrollingDeltaYSelector );\n"
+        "\t\tpOutEvent->hasPreciseScrollingDeltas\t= ((BOOL (*)( id, SEL ))objc_msgSend)( pEvent, pPump->hasPreciseScrollingDeltasSelector ) ? 1u : 0u;\n"
+        "\t}\n"
+        "\telse if( isMouseEvent )\n"
+        "\t{\n"
+        "\t\tpOutEvent->deltaX = ((double (*)( id, SEL ))objc_msgSend)( pEvent, pPump->deltaXSelector );\n"
+        "\t\tpOutEvent->deltaY = ((double (*)( id, SEL ))objc_msgSend)( pEvent, pPump->deltaYSelector );\n"
+        "\t}\n"
+        "\telse if( type >= 10u && type <= 12u )\n"
+        "\t{\n"
+        "\t\tpOutEvent->keyCode = ((uint16_t (*)( id, SEL ))objc_msgSend)( pEvent, pPump->keyCodeSelector );\n"
+        "\t\tif( type == 10u )\n"
+        "\t\t{\n"
+        "\t\t\tpOutEvent->isRepeat = ((BOOL (*)( id, SEL ))objc_msgSend)( pEvent, pPump->isARepeatSelector ) ? 1u : 0u;\n"
+        "\t\t}\n\n"
+        "\t\tif( type != 12u && !c_ocoa_string_get_utf8( ((id (*)( id, SEL ))objc_msgSend)( pEvent, pPump->charactersSelector ), pOutEvent->characters, sizeof( pOutEvent->characters ) ) )\n"
+        "\t\t{\n"
+        "\t\t\tpOutEvent->characters[ 0 ] = '\\0';\n"
+        "\t\t}\n"
+        "\t}\n"
+        "}\n\n"
+        "size_t c_ocoa_event_pump_drain( c_ocoa_event_pump_t* pPump, c_ocoa_event_t* pOutEvents, size_t maxEventCount )\n"
+        "{\n"
+        "\tC_OCOA_PROFILE_SCOPE( \"c_ocoa_event_pump_drain\" );\n"
+        "\tvoid* pPool = c_ocoa_autoreleasepool_push();\n\n"
+        "\t//FK: Every event has to be sent before the next one gets dequeued. Tracking loops inside of sendEvent: (eg: a button\n"
+        "\t//    waiting for mouseUp) call nextEventMatchingMask: themselves and would miss events that are already dequeued here\n"
+        "\tsize_t eventCount = 0u;\n"
+        "\twhile( eventCount < maxEventCount )\n"
+        "\t{\n"
+        "\t\tid pEvent = ((id (*)( id, SEL, uint64_t, id, id, BOOL ))objc_msgSend)( pPump->pApplication, pPump->nextEventSelector, UINT64_MAX, pPump->pDistantPast, pPump->pRunLoopMode, YES );\n"
+        "\t\tif( pEvent == NULL )\n"
+        "\t\t{\n"
+        "\t\t\tbreak;\n"
+        "\t\t}\n\n"
+        "\t\tc_ocoa_event_pump_decode( pPump, pEvent, pOutEvents + eventCount );\n"
+        "\t\t((void (*)( id, SEL, id ))objc_msgSend)( pPump->pApplication, pPump->sendEventSelector, pEvent );\n"
+        "\t\t++eventCount;\n"
+        "\t}\n\n"
+        "\tc_ocoa_autoreleasepool_pop( pPool );\n"
+        "\treturn eventCount;\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
+
+void file_write_c_runtime_header_main_queue( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Bounded lock-free multi producer/single consumer queue of calls for the main thread, used by the '<wrapper>_on_main()'\n"
+        "// variants. Any thread can push, only the main thread drains (eg: once per frame next to c_ocoa_event_pump_drain()).\n"
+        "#ifndef C_OCOA_MAIN_QUEUE_CAPACITY\n"
+        "#define C_OCOA_MAIN_QUEUE_CAPACITY 4096u\t\t\t// has to be a power of 2\n"
+        "#endif\n\n"
+        "// Arguments that don't fit into a slot get copied to the heap instead.\n"
+        "#ifndef C_OCOA_MAIN_QUEUE_ARGUMENT_SIZE\n"
+        "#define C_OCOA_MAIN_QUEUE_ARGUMENT_SIZE 64u\n"
+        "#endif\n\n"
+        "typedef void (*c_ocoa_main_call_fn)( void* pArguments );\n\n"
+        "// Copies 'argumentSize' bytes of 'pArguments' into the queue. Returns 0 if the queue is full (or if the arguments\n"
+        "// don't fit into a slot and can't be copied to the heap).\n"
+        "int\t\tc_ocoa_main_queue_push( c_ocoa_main_call_fn pFunction, const void* pArguments, size_t argumentSize );\n\n"
+        "// Same as c_ocoa_main_queue_push() but waits until there's space in the queue. Called from the main thread the queue\n"
+        "// gets drained right away instead.\n"
+        "void\tc_ocoa_main_queue_push_wait( c_ocoa_main_call_fn pFunction, const void* pArguments, size_t argumentSize );\n\n"
+        "// Executes up to 'maxCallCount' queued calls in the order they have been pushed. Returns the number of executed calls.\n"
+        "// Must only be called from the main thread.\n"
+        "size_t\tc_ocoa_main_queue_drain( size_t maxCallCount );\n\n",
+        pRuntimeHeaderFileHandle );
+}
+
+void file_write_c_runtime_source_main_queue( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "#include <sched.h>\n"
+        "#ifdef __APPLE__\n"
+        "#include <pthread.h>\n"
+        "#else\n"
+        "#include <unistd.h>\n"
+        "#include <sys/syscall.h>\n"
+        "#endif\n\n"
+        "#define C_OCOA_MAIN_QUEUE_MASK ( C_OCOA_MAIN_QUEUE_CAPACITY - 1u )\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\t//FK: Stored relative to the slot index so that the zero initialized queue is valid:\n"
+        "\t//    free for the push at 'position' if sequence == position, ready for the drain if sequence == position + 1\n"
+        "\tuint64_t\t\t\tsequence;\n"
+        "\tc_ocoa_main_call_fn\tpFunction;\n"
+        "\tvoid*\t\t\t\tpHeapArguments;\n"
+        "\tuint64_t\t\t\targuments[ ( C_OCOA_MAIN_QUEUE_ARGUMENT_SIZE + 7u ) / 8u ];\n"
+        "} c_ocoa_main_queue_slot_t;\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\t//FK: Producers and consumer write different cache lines\n"
+        "\tuint64_t\t\t\t\t\tpushPosition __attribute__((aligned(64)));\n"
+        "\tuint64_t\t\t\t\t\tdrainPosition __attribute__((aligned(64)));\n"
+        "\tc_ocoa_main_queue_slot_t\tslots[ C_OCOA_MAIN_QUEUE_CAPACITY ];\n"
+        "} c_ocoa_main_queue_t;\n\n"
+        "static c_ocoa_main_queue_t c_ocoa_main_queue;\n\n"
+        "static int c_ocoa_main_queue_is_main_thread( void )\n"
+        "{\n"
+        "#ifdef __APPLE__\n"
+        "\treturn pthread_main_np() != 0;\n"
+        "#else\n"
+        "\t//FK: The thread id of the main thread equals the process id\n"
+        "\treturn (pid_t)syscall( SYS_gettid ) == getpid();\n"
+        "#endif\n"
+        "}\n\n"
+        "int c_ocoa_main_queue_push( c_ocoa_main_call_fn pFunction, const void* pArguments, size_t argumentSize )\n"
+        "{\n"
+        "\t//FK: Allocate before claiming a slot, the drain stops at claimed slots until they are published\n"
+        "\tvoid* pHeapArguments = NULL;\n"
+        "\tif( argumentSize > sizeof( c_ocoa_main_queue.slots[ 0 ].arguments ) )\n"
+        "\t{\n"
+        "\t\tpHeapArguments = malloc( argumentSize );\n"
+        "\t\tif( pHeapArguments == NULL )\n"
+        "\t\t{\n"
+        "\t\t\treturn 0;\n"
+        "\t\t}\n\n"
+        "\t\tmemcpy( pHeapArguments, pArguments, argumentSize );\n"
+        "\t}\n\n"
+        "\tc_ocoa_main_queue_slot_t* pSlot = NULL;\n"
+        "\tuint64_t position = __atomic_load_n( &c_ocoa_main_queue.pushPosition, __ATOMIC_RELAXED );\n"
+        "\twhile( 1 )\n"
+        "\t{\n"
+        "\t\tpSlot = c_ocoa_main_queue.slots + ( position & C_OCOA_MAIN_QUEUE_MASK );\n"
+        "\t\tconst uint64_t sequence = __atomic_load_n( &pSlot->sequence, __ATOMIC_ACQUIRE ) + ( position & C_OCOA_MAIN_QUEUE_MASK );\n"
+        "\t\tconst int64_t difference = (int64_t)( sequence - position );\n"
+        "\t\tif( difference == 0 )\n"
+        "\t\t{\n"
+        "\t\t\tif( __atomic_compare_exchange_n( &c_ocoa_main_queue.pushPosition, &position, position + 1u, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )\n"
+        "\t\t\t{\n"
+        "\t\t\t\tbreak;\n"
+        "\t\t\t}\n"
+        "\t\t}\n"
+        "\t\telse if( difference < 0 )\n"
+        "\t\t{\n"
+        "\t\t\t//FK: The slot still holds the call from one lap ago\n"
+        "\t\t\tfree( pHeapArguments );\n"
+        "\t\t\treturn 0;\n"
+        "\t\t}\n"
+        "\t\telse\n"
+        "\t\t{\n"
+        "\t\t\tposition = __atomic_load_n( &c_ocoa_main_queue.pushPosition, __ATOMIC_RELAXED );\n"
+        "\t\t}\n"
+        "\t}\n\n"
+        "\tpSlot->pFunction = pFunction;\n"
+        "\tpSlot->pHeapArguments = pHeapArguments;\n"
+        "\tif( pHeapArguments == NULL && argumentSize > 0u )\n"
+        "\t{\n"
+        "\t\tmemcpy( pSlot->arguments, pArguments, argumentSize );\n"
+        "\t}\n\n"
+        "\t__atomic_store_n( &pSlot->sequence, position + 1u - ( position & C_OCOA_MAIN_QUEUE_MASK ), __ATOMIC_RELEASE );\n"
+        "\treturn 1;\n"
+        "}\n\n"
+        "void c_ocoa_main_queue_push_wait( c_ocoa_main_call_fn pFunction, const void* pArguments, size_t argumentSize )\n"
+        "{\n"
+        "\twhile( !c_ocoa_main_queue_push( pFunction, pArguments, argumentSize ) )\n"
+        "\t{\n"
+        "\t\t//FK: The main thread would wait for itself (also if it pushes before its first drain)\n"
+        "\t\tif( c_ocoa_main_queue_is_main_thread() )\n"
+        "\t\t{\n"
+        "\t\t\tc_ocoa_main_queue_drain( C_OCOA_MAIN_QUEUE_CAPACITY );\n"
+        "\t\t}\n"
+        "\t\telse\n"
+        "\t\t{\n"
+        "\t\t\tsched_yield();\n"
+        "\t\t}\n"
+        "\t}\n"
+        "}\n\n"
+        "size_t c_ocoa_main_queue_drain( size_t maxCallCount )\n"
+        "{\n"
+        "\tsize_t callCount = 0u;\n"
+        "\twhile( callCount < maxCallCount )\n"
+        "\t{\n"
+        "\t\tconst uint64_t position = c_ocoa_main_queue.drainPosition;\n"
+        "\t\tc_ocoa_main_queue_slot_t* pSlot = c_ocoa_main_queue.slots + ( position & C_OCOA_MAIN_QUEUE_MASK );\n"
+        "\t\tconst uint64_t sequence = __atomic_load_n( &pSlot->sequence, __ATOMIC_ACQUIRE ) + ( position & C_OCOA_MAIN_QUEUE_MASK );\n"
+        "\t\tif( sequence != position + 1u )\n"
+        "\t\t{\n"
+        "\t\t\t//FK: Empty (or the producer of this slot hasn't finished copying yet)\n"
+        "\t\t\tbreak;\n"
+        "\t\t}\n\n"
+        "\t\t//FK: Copy the call out and release the slot before calling, the call might push (or drain) itself\n"
+        "\t\tuint64_t arguments[ ( C_OCOA_MAIN_QUEUE_ARGUMENT_SIZE + 7u ) / 8u ];\n"
+        "\t\tc_ocoa_main_call_fn pFunction = pSlot->pFunction;\n"
+        "\t\tvoid* pHeapArguments = pSlot->pHeapArguments;\n"
+        "\t\tmemcpy( arguments, pSlot->arguments, sizeof( arguments ) );\n\n"
+        "\t\tc_ocoa_main_queue.drainPosition = position + 1u;\n"
+        "\t\t__atomic_store_n( &pSlot->sequence, position + C_OCOA_MAIN_QUEUE_CAPACITY - ( position & C_OCOA_MAIN_QUEUE_MASK ), __ATOMIC_RELEASE );\n\n"
+        "\t\tpFunction( pHeapArguments != NULL ? pHeapArguments : (void*)arguments );\n"
+        "\t\tfree( pHeapArguments );\n"
+        "\t\t++callCount;\n"
+        "\t}\n\n"
+        "\treturn callCount;\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
+
+void file_write_c_runtime_header_registry( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Name -> wrapper lookup for scripting bridges, every class generated with '--registry' has a '<class>_registry()'.\n"
+        "// The tables are indexed by a minimal perfect hash that is computed by the generator, so a lookup is\n"
+        "// two hashes + one string compare without any runtime introspection or allocation.\n"
+        "typedef enum\n"
+        "{\n"
+        "\tC_OCOA_RETURN_KIND_VOID = 0,\n"
+        "\tC_OCOA_RETURN_KIND_INTEGER,\n"
+        "\tC_OCOA_RETURN_KIND_FLOAT,\n"
+        "\tC_OCOA_RETURN_KIND_OBJECT,\n"
+        "\tC_OCOA_RETURN_KIND_POINTER,\n"
+        "\tC_OCOA_RETURN_KIND_STRUCT\n"
+        "} c_ocoa_return_kind_t;\n\n"
+        "// Has to be cast to the signature of the wrapper before calling it.\n"
+        "typedef void (*c_ocoa_wrapper_fn)( void );\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\tconst char*\t\t\tpName;\t\t\t\t// wrapper name without class prefix, eg: 'setFrame'\n"
+        "\tconst char*\t\t\tpSelectorName;\t\t// eg: 'setFrame:'\n"
+        "\tc_ocoa_wrapper_fn\tpWrapper;\n"
+        "\tconst char*\t\t\tpArgumentTypes;\t\t// one objc type code per argument (excluding object/class), eg: \"{\" for 'setFrame:'\n"
+        "\tuint32_t\t\t\tnameLength;\n"
+        "\tuint8_t\t\t\t\targumentCount;\n"
+        "\tuint8_t\t\t\t\treturnKind;\t\t\t// c_ocoa_return_kind_t\n"
+        "\tuint8_t\t\t\t\tisClassMethod;\t\t// class method wrappers don't take the object as first argument\n"
+        "} c_ocoa_registry_entry_t;\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\tconst char*\t\t\t\t\t\tpClassName;\n"
+        "\tconst c_ocoa_registry_entry_t*\tpEntries;\n"
+        "\tconst uint32_t*\t\t\t\t\tpSeeds;\n"
+        "\tuint32_t\t\t\t\t\t\tentryCount;\n"
+        "\tuint32_t\t\t\t\t\t\tbucketCount;\n"
+        "} c_ocoa_registry_t;\n\n"
+        "//FK: FNV-1a + murmur3 finalizer, the generator uses the same function to build the tables\n"
+        "static inline uint32_t c_ocoa_registry_hash( const char* pName, size_t nameLength, uint32_t seed )\n"
+        "{\n"
+        "\tuint32_t hash = 2166136261u ^ seed;\n"
+        "\tfor( size_t charIndex = 0u; charIndex < nameLength; ++charIndex )\n"
+        "\t{\n"
+        "\t\thash ^= (uint8_t)pName[ charIndex ];\n"
+        "\t\thash *= 16777619u;\n"
+        "\t}\n\n"
+        "\thash ^= hash >> 16;\n"
+        "\thash *= 0x85ebca6bu;\n"
+        "\thash ^= hash >> 13;\n"
+        "\treturn hash;\n"
+        "}\n\n"
+        "// Returns the entry of the wrapper called 'pName' (without class prefix) or NULL if there's none.\n"
+        "const c_ocoa_registry_entry_t* c_ocoa_registry_find( const c_ocoa_registry_t* pRegistry, const char* pName, size_t nameLength );\n\n",
+        pRuntimeHeaderFileHandle );
+}
+
+void file_write_c_runtime_source_registry( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "#include <string.h>\n\n"
+        "const c_ocoa_registry_entry_t* c_ocoa_registry_find( const c_ocoa_registry_t* pRegistry, const char* pName, size_t nameLength )\n"
+        "{\n"
+        "\tif( pRegistry->entryCount == 0u )\n"
+        "\t{\n"
+        "\t\treturn NULL;\n"
+        "\t}\n\n"
+        "\tconst uint32_t bucketIndex = c_ocoa_registry_hash( pName, nameLength, 0u ) % pRegistry->bucketCount;\n"
+        "\tconst uint32_t entryIndex = c_ocoa_registry_hash( pName, nameLength, pRegistry->pSeeds[ bucketIndex ] ) % pRegistry->entryCount;\n"
+        "\tconst c_ocoa_registry_entry_t* pEntry = pRegistry->pEntries + entryIndex;\n\n"
+        "\t//FK: The hash is only perfect for the known names, everything else has to be rejected by comparing the name\n"
+        "\tif( pEntry->nameLength != nameLength || memcmp( pEntry->pName, pName, nameLength ) != 0 )\n"
+        "\t{\n"
+        "\t\treturn NULL;\n"
+        "\t}\n\n"
+        "\treturn pEntry;\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
+
+void file_write_c_runtime_header_delegates( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Description of a protocol, written by the generator for every protocol that matches '--protocols' ('<protocol>_protocol').\n"
+        "// The selectors and the protocol object are looked up once, when the first delegate class of the protocol gets defined.\n"
+        "typedef struct\n"
+        "{\n"
+        "\tconst char*\t\t\tpName;\t\t\t\t// eg: 'NSApplicationDelegate'\n"
+        "\tconst char* const*\tppSelectorNames;\n"
+        "\tconst char* const*\tppTypeEncodings;\t// objc method type encoding per selector, eg: \"c24@0:8@16\"\n"
+        "\tSEL*\t\t\t\tpSelectors;\n"
+        "\tProtocol*\t\t\tpObjcProtocol;\t\t// NULL if the protocol isn't known to the runtime\n"
+        "\tuint32_t\t\t\tmethodCount;\n"
+        "\tuint32_t\t\t\tisResolved;\n"
+        "} c_ocoa_protocol_t;\n\n"
+        "// Internal, call the generated '<protocol>_define_class()' instead (which checks the type of the vtable).\n"
+        "// Defines and registers the class 'pClassName' that conforms to the protocol of pVTable and implements all of its non-NULL functions.\n"
+        "// pVTable has to point to a generated '<protocol>_vtable_t' (protocol description followed by one function per selector).\n"
+        "Class c_ocoa_define_delegate_class_internal( const char* pClassName, const char* pParentClassName, const void* pVTable );\n\n",
+        pRuntimeHeaderFileHandle );
+}
+
+void file_write_c_runtime_source_delegates( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "static void c_ocoa_protocol_resolve( c_ocoa_protocol_t* pProtocol )\n"
+        "{\n"
+        "\t//FK: Threads that race here write the same values\n"
+        "\tfor( uint32_t methodIndex = 0u; methodIndex < pProtocol->methodCount; ++methodIndex )\n"
+        "\t{\n"
+        "\t\tpProtocol->pSelectors[ methodIndex ] = sel_registerName( pProtocol->ppSelectorNames[ methodIndex ] );\n"
+        "\t}\n\n"
+        "\tpProtocol->pObjcProtocol = objc_getProtocol( pProtocol->pName );\n"
+        "\t__atomic_store_n( &pProtocol->isResolved, 1u, __ATOMIC_RELEASE );\n"
+        "}\n\n"
+        "Class c_ocoa_define_delegate_class_internal( const char* pClassName, const char* pParentClassName, const void* pVTable )\n"
+        "{\n"
+        "\tc_ocoa_protocol_t* pProtocol = *(c_ocoa_protocol_t* const*)pVTable;\n"
+        "\tconst IMP* pImplementations = (const IMP*)( (const char*)pVTable + sizeof( c_ocoa_protocol_t* ) );\n"
+        "\tif( !__atomic_load_n( &pProtocol->isResolved, __ATOMIC_ACQUIRE ) )\n"
+        "\t{\n"
+        "\t\tc_ocoa_protocol_resolve( pProtocol );\n"
+        "\t}\n\n"
+        "\tClass pParentClass = (Class)objc_getClass( pParentClassName );\n"
+        "\tif( pParentClass == NULL )\n"
+        "\t{\n"
+        "\t\treturn NULL;\n"
+        "\t}\n\n"
+        "\tClass pClass = objc_allocateClassPair( pParentClass, pClassName, 0u );\n"
+        "\tif( pClass == NULL )\n"
+        "\t{\n"
+        "\t\treturn NULL;\n"
+        "\t}\n\n"
+        "\t//FK: Protocols that are never referenced by compiled code may be unknown to the runtime, the methods still get added\n"
+        "\tif( pProtocol->pObjcProtocol != NULL )\n"
+        "\t{\n"
+        "\t\tclass_addProtocol( pClass, pProtocol->pObjcProtocol );\n"
+        "\t}\n\n"
+        "\tfor( uint32_t methodIndex = 0u; methodIndex < pProtocol->methodCount; ++methodIndex )\n"
+        "\t{\n"
+        "\t\tif( pImplementations[ methodIndex ] != NULL )\n"
+        "\t\t{\n"
+        "\t\t\tclass_addMethod( pClass, pProtocol->pSelectors[ methodIndex ], pImplementations[ methodIndex ], pProtocol->ppTypeEncodings[ methodIndex ] );\n"
+        "\t\t}\n"
+        "\t}\n\n"
+        "\tobjc_registerClassPair( pClass );\n"
+        "\treturn pClass;\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
+
+void file_write_c_runtime_header_frameworks( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Lazy framework loading, used by code that has been generated with '--lazy-frameworks'.\n"
+        "// The frameworks of the generated classes are listed in c_ocoa_frameworks.h.\n"
+        "#include <stdio.h>\n\n"
+        "typedef enum\n"
+        "{\n"
+        "\tC_OCOA_FRAMEWORK_STATE_UNTOUCHED = 0,\n"
+        "\tC_OCOA_FRAMEWORK_STATE_LOADING,\t\t// claimed by the thread that calls dlopen()\n"
+        "\tC_OCOA_FRAMEWORK_STATE_LOADED,\n"
+        "\tC_OCOA_FRAMEWORK_STATE_FAILED\n"
+        "} c_ocoa_framework_state_t;\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\tconst char*\tpName;\n"
+        "\tconst char*\tpPath;\n"
+        "\tvoid*\t\tpHandle;\t\t\t\t\t// only written by the thread that claimed the load, read after 'state' is LOADED/FAILED\n"
+        "\tuint64_t\tloadTimeInNanoseconds;\n"
+        "\tuint32_t\tstate;\t\t\t\t\t// c_ocoa_framework_state_t\n"
+        "} c_ocoa_framework_t;\n\n"
+        "// dlopen()s the framework on first use and returns the class (NULL if it doesn't exist).\n"
+        "// Categories that a framework adds to classes of other frameworks are only available after one of its own classes has been used.\n"
+        "Class\tc_ocoa_framework_get_class( c_ocoa_framework_t* pFramework, const char* pClassName );\n\n"
+        "// Writes which of the frameworks have been touched so far and how long loading them took.\n"
+        "void\tc_ocoa_framework_report( FILE* pFile, c_ocoa_framework_t* const* ppFrameworks, size_t frameworkCount );\n\n",
+        pRuntimeHeaderFileHandle );
+}
+
+void file_write_c_runtime_source_frameworks( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "#include <dlfcn.h>\n"
+        "#include <sched.h>\n"
+        "#include <time.h>\n\n"
+        "static void c_ocoa_framework_load( c_ocoa_framework_t* pFramework )\n"
+        "{\n"
+        "\t//FK: Only the thread that moves the state from UNTOUCHED to LOADING opens the framework and writes the\n"
+        "\t//    handle + load time, all other threads wait until the state is LOADED/FAILED\n"
+        "\tuint32_t state = C_OCOA_FRAMEWORK_STATE_UNTOUCHED;\n"
+        "\tif( !__atomic_compare_exchange_n( &pFramework->state, &state, C_OCOA_FRAMEWORK_STATE_LOADING, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE ) )\n"
+        "\t{\n"
+        "\t\twhile( state == C_OCOA_FRAMEWORK_STATE_LOADING )\n"
+        "\t\t{\n"
+        "\t\t\tsched_yield();\n"
+        "\t\t\tstate = __atomic_load_n( &pFramework->state, __ATOMIC_ACQUIRE );\n"
+        "\t\t}\n"
+        "\t\treturn;\n"
+        "\t}\n\n"
+        "\tstruct timespec startTime;\n"
+        "\tstruct timespec endTime;\n"
+        "\tclock_gettime( CLOCK_MONOTONIC, &startTime );\n"
+        "\tvoid* pHandle = dlopen( pFramework->pPath, RTLD_LAZY | RTLD_GLOBAL );\n"
+        "\tclock_gettime( CLOCK_MONOTONIC, &endTime );\n\n"
+        "\t//FK: Categories of the framework may replace IMPs that are already cached (-i, -s, --snapshot). Runs once per framework\n"
+        "\tif( pHandle != NULL )\n"
+        "\t{\n"
+        "\t\tc_ocoa_imp_cache_invalidate();\n"
+        "\t}\n\n"
+        "\tpFramework->pHandle = pHandle;\n"
+        "\tpFramework->loadTimeInNanoseconds = (uint64_t)( endTime.tv_sec - startTime.tv_sec ) * 1000000000ull + (uint64_t)endTime.tv_nsec - (uint64_t)startTime.tv_nsec;\n"
+        "\t__atomic_store_n( &pFramework->state, pHandle != NULL ? C_OCOA_FRAMEWORK_STATE_LOADED : C_OCOA_FRAMEWORK_STATE_FAILED, __ATOMIC_RELEASE );\n"
+        "}\n\n"
+        "Class c_ocoa_framework_get_class( c_ocoa_framework_t* pFramework, const char* pClassName )\n"
+        "{\n"
+        "\tconst uint32_t state = __atomic_load_n( &pFramework->state, __ATOMIC_ACQUIRE );\n"
+        "\tif( state == C_OCOA_FRAMEWORK_STATE_UNTOUCHED || state == C_OCOA_FRAMEWORK_STATE_LOADING )\n"
+        "\t{\n"
+        "\t\tc_ocoa_framework_load( pFramework );\n"
+        "\t}\n\n"
+        "\treturn (Class)objc_getClass( pClassName );\n"
+        "}\n\n"
+        "void c_ocoa_framework_report( FILE* pFile, c_ocoa_framework_t* const* ppFrameworks, size_t frameworkCount )\n"
+        "{\n"
+        "\tsize_t touchedCount = 0u;\n"
+        "\tuint64_t totalLoadTimeInNanoseconds = 0u;\n"
+        "\tfor( size_t frameworkIndex = 0u; frameworkIndex < frameworkCount; ++frameworkIndex )\n"
+        "\t{\n"
+        "\t\tconst c_ocoa_framework_t* pFramework = ppFrameworks[ frameworkIndex ];\n"
+        "\t\tconst uint32_t state = __atomic_load_n( &pFramework->state, __ATOMIC_ACQUIRE );\n"
+        "\t\tconst char* pState = state == C_OCOA_FRAMEWORK_STATE_LOADED ? \"loaded\" : ( state == C_OCOA_FRAMEWORK_STATE_FAILED ? \"failed\" : ( state == C_OCOA_FRAMEWORK_STATE_LOADING ? \"loading\" : \"untouched\" ) );\n"
+        "\t\tif( state == C_OCOA_FRAMEWORK_STATE_UNTOUCHED || state == C_OCOA_FRAMEWORK_STATE_LOADING )\n"
+        "\t\t{\n"
+        "\t\t\tfprintf( pFile, \"%-32s %s\\n\", pFramework->pName, pState );\n"
+        "\t\t\tcontinue;\n"
+        "\t\t}\n\n"
+        "\t\t++touchedCount;\n"
+        "\t\ttotalLoadTimeInNanoseconds += pFramework->loadTimeInNanoseconds;\n"
+        "\t\tfprintf( pFile, \"%-32s %-10s %10.3f ms\\n\", pFramework->pName, pState, (double)pFramework->loadTimeInNanoseconds / 1000000.0 );\n"
+        "\t}\n\n"
+        "\tfprintf( pFile, \"%zu of %zu frameworks touched, %.3f ms spent loading\\n\", touchedCount, frameworkCount, (double)totalLoadTimeInNanoseconds / 1000000.0 );\n"
+        "}\n\n",
+        pRuntimeSourceFileHandle );
+}
+
+void file_write_c_runtime_header_profile( FILE* pRuntimeHeaderFileHandle )
+{
+    fputs(
+        "// Per wrapper call counting + timing, enabled by compiling everything with C_OCOA_PROFILE defined.\n"
+        "// Without C_OCOA_PROFILE, C_OCOA_PROFILE_SCOPE() expands to nothing.\n"
+        "#ifdef C_OCOA_PROFILE\n"
+        "#ifdef __APPLE__\n"
+        "#include <mach/mach_time.h>\n"
+        "#else\n"
+        "#include <time.h>\n"
+        "#endif\n"
+        "#include <stdio.h>\n\n"
+        "#ifndef C_OCOA_PROFILE_MAX_SITES\n"
+        "#define C_OCOA_PROFILE_MAX_SITES 4096u\n"
+        "#endif\n\n"
+        "typedef enum\n"
+        "{\n"
+        "\tC_OCOA_PROFILE_FORMAT_TABLE = 0,\n"
+        "\tC_OCOA_PROFILE_FORMAT_JSON\n"
+        "} c_ocoa_profile_format;\n\n"
+        "// One per wrapper, 'index' gets assigned on the first call (0 = not yet registered).\n"
+        "typedef struct\n"
+        "{\n"
+        "\tconst char*\tpName;\n"
+        "\tuint32_t\tindex;\n"
+        "} c_ocoa_profile_site_t;\n\n"
+        "// Only ever written by the owning thread, so no atomic read-modify-write is needed.\n"
+        "typedef struct\n"
+        "{\n"
+        "\tuint64_t\tcallCount;\n"
+        "\tuint64_t\tticks;\n"
+        "} c_ocoa_profile_counter_t;\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\tc_ocoa_profile_site_t*\tpSite;\n"
+        "\tuint64_t\t\t\t\tstartTicks;\n"
+        "} c_ocoa_profile_scope_t;\n\n"
+        "extern __thread c_ocoa_profile_counter_t* c_ocoa_profile_thread_counters;\n\n"
+        "c_ocoa_profile_counter_t*\tc_ocoa_profile_find_counter_slow( c_ocoa_profile_site_t* pSite );\n\n"
+        "// Writes all recorded wrappers sorted by total time (descending).\n"
+        "void\tc_ocoa_profile_dump( FILE* pFile, c_ocoa_profile_format format );\n\n"
+        "static inline uint64_t c_ocoa_profile_now( void )\n"
+        "{\n"
+        "#ifdef __APPLE__\n"
+        "\treturn mach_absolute_time();\n"
+        "#else\n"
+        "\tstruct timespec time;\n"
+        "\tclock_gettime( CLOCK_MONOTONIC, &time );\n"
+        "\treturn (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;\n"
+        "#endif\n"
+        "}\n\n"
+        "static inline c_ocoa_profile_scope_t c_ocoa_profile_scope_enter( c_ocoa_profile_site_t* pSite )\n"
+        "{\n"
+        "\tc_ocoa_profile_scope_t scope = { pSite, c_ocoa_profile_now() };\n"
+        "\treturn scope;\n"
+        "}\n\n"
+        "static inline void c_ocoa_profile_scope_exit( c_ocoa_profile_scope_t* pScope )\n"
+        "{\n"
+        "\tconst uint64_t elapsedTicks = c_ocoa_profile_now() - pScope->startTicks;\n"
+        "\tconst uint32_t siteIndex = __atomic_load_n( &pScope->pSite->index, __ATOMIC_ACQUIRE );\n"
+        "\tc_ocoa_profile_counter_t* pCounter = ( siteIndex != 0u && siteIndex <= C_OCOA_PROFILE_MAX_SITES && c_ocoa_profile_thread_counters != NULL ) ?\n"
+        "\t\tc_ocoa_profile_thread_counters + ( siteIndex - 1u ) : c_ocoa_profile_find_counter_slow( pScope->pSite );\n\n"
+        "\tif( pCounter != NULL )\n"
+        "\t{\n"
+        "\t\t//FK: relaxed stores so that c_ocoa_profile_dump() never sees torn values\n"
+        "\t\t__atomic_store_n( &pCounter->callCount, pCounter->callCount + 1u, __ATOMIC_RELAXED );\n"
+        "\t\t__atomic_store_n( &pCounter->ticks, pCounter->ticks + elapsedTicks, __ATOMIC_RELAXED );\n"
+        "\t}\n"
+        "}\n\n"
+        "#define C_OCOA_PROFILE_SCOPE( name ) \\\n"
+        "\tstatic c_ocoa_profile_site_t c_ocoa_profile_site = { name, 0u }; \\\n"
+        "\tc_ocoa_profile_scope_t c_ocoa_profile_scope __attribute__((cleanup(c_ocoa_profile_scope_exit))) = c_ocoa_profile_scope_enter( &c_ocoa_profile_site )\n"
+        "#else\n"
+        "#define C_OCOA_PROFILE_SCOPE( name )\n"
+        "#endif\n\n",
+        pRuntimeHeaderFileHandle );
+}
+
+void file_write_c_runtime_source_profile( FILE* pRuntimeSourceFileHandle )
+{
+    fputs(
+        "#ifdef C_OCOA_PROFILE\n"
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n\n"
+        "// Counter blocks of all threads, blocks are never freed so that counts of finished threads still show up in the dump.\n"
+        "typedef struct c_ocoa_profile_thread_block\n"
+        "{\n"
+        "\tstruct c_ocoa_profile_thread_block*\tpNext;\n"
+        "\tc_ocoa_profile_counter_t\t\t\t\tcounters[ C_OCOA_PROFILE_MAX_SITES ];\n"
+        "} c_ocoa_profile_thread_block_t;\n\n"
+        "typedef struct\n"
+        "{\n"
+        "\tconst char*\tpName;\n"
+        "\tuint64_t\tcallCount;\n"
+        "\tuint64_t\tticks;\n"
+        "} c_ocoa_profile_entry_t;\n\n"
+        "__thread c_ocoa_profile_counter_t* c_ocoa_profile_thread_counters = NULL;\n\n"
+        "static c_ocoa_profile_site_t*\t\t\tc_ocoa_profile_sites[ C_OCOA_PROFILE_MAX_SITES ];\n"
+        "static uint32_t\t\t\t\t\t\t\tc_ocoa_profile_site_count = 0u;\n"
+        "static c_ocoa_profile_thread_block_t*\tc_ocoa_profile_thread_blocks = NULL;\n\n"
+        "static void c_ocoa_profile_dump_at_exit( void )\n"
+        "{\n"
+        "\t//FK: C_OCOA_PROFILE_OUTPUT=<path> writes to a file instead of stderr, JSON if the path ends with '.json'\n"
+        "\tconst char* pOutputPath = getenv( \"C_OCOA_PROFILE_OUTPUT\" );\n"
+        "\tif( pOutputPath == NULL )\n"
+        "\t{\n"
+        "\t\tc_ocoa_profile_dump( stderr, C_OCOA_PROFILE_FORMAT_TABLE );\n"
+        "\t\treturn;\n"
+        "\t}\n\n"
+        "\tFILE* pFile = fopen( pOutputPath, \"w\" );\n"
+        "\tif( pFile == NULL )\n"
+        "\t{\n"
+        "\t\treturn;\n"
+        "\t}\n\n"
+        "\tconst size_t pathLength = strlen( pOutputPath );\n"
+        "\tconst int isJson = pathLength >= 5u && strcmp( pOutputPath + pathLength - 5u, \".json\" ) == 0;\n"
+        "\tc_ocoa_profile_dump( pFile, isJson ? C_OCOA_PROFILE_FORMAT_JSON : C_OCOA_PROFILE_FORMAT_TABLE );\n"
+        "\tfclose( pFile );\n"
+        "}\n\n"
+        "static uint32_t c_ocoa_profile_register_site( c_ocoa_profile_site_t* pSite )\n"
+        "{\n"
+        "\t//FK: 0 = not registered, UINT32_MAX = registration in progress (by another thread)\n"
+        "\tuint32_t siteIndex = 0u;\n"
+        "\tif( __atomic_compare_exchange_n( &pSite->index, &siteIndex, UINT32_MAX, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )\n"
+        "\t{\n"
+        "\t\tsiteIndex = __atomic_fetch_add( &c_ocoa_profile_site_count, 1u, __ATOMIC_RELAXED ) + 1u;\n"
+        "\t\tif( siteIndex == 1u )\n"
+        "\t\t{\n"
+        "\t\t\tatexit( c_ocoa_profile_dump_at_exit );\n"
+        "\t\t}\n\n"
+        "\t\tif( siteIndex <= C_OCOA_PROFILE_MAX_SITES )\n"
+        "\t\t{\n"
+        "\t\t\t__atomic_store_n( &c_ocoa_profile_sites[ siteIndex - 1u ], pSite, __ATOMIC_RELEASE );\n"
+        "\t\t}\n\n"
+        "\t\t__atomic_store_n( &pSite->index, siteIndex, __ATOMIC_RELEASE );\n"
+        "\t}\n\n"
+        "\treturn siteIndex;\n"
+        "}\n\n"
+        "c_ocoa_profile_counter_t* c_ocoa_profile_find_counter_slow( c_ocoa_profile_site_t* pSite )\n"
+        "{\n"
+        "\tuint32_t siteIndex = __atomic_load_n( &pSite->index, __ATOMIC_ACQUIRE );\n"
+        "\tif( siteIndex == 0u )\n"
+        "\t{\n"
+        "\t\tsiteIndex = c_ocoa_profile_register_site( pSite );\n"
+        "\t}\n\n"
+        "\t//FK: Sites that don't fit anymore (or that are still being registered) aren't recorded\n"
+        "\tif( siteIndex == 0u || siteIndex > C_OCOA_PROFILE_MAX_SITES )\n"
+        "\t{\n"
+        "\t\treturn NULL;\n"
+        "\t}\n\n"
+        "\tif( c_ocoa_profile_thread_counters == NULL )\n"
+        "\t{\n"
+        "\t\tc_ocoa_profile_thread_block_t* pBlock = (c_ocoa_profile_thread_block_t*)calloc( 1u, sizeof( c_ocoa_profile_thread_block_t ) );\n"
+        "\t\tif( pBlock == NULL )\n"
+        "\t\t{\n"
+        "\t\t\treturn NULL;\n"
+        "\t\t}\n\n"
+        "\t\tpBlock->pNext = __atomic_load_n( &c_ocoa_profile_thread_blocks, __ATOMIC_RELAXED );\n"
+        "\t\twhile( !__atomic_compare_exchange_n( &c_ocoa_profile_thread_blocks, &pBlock->pNext, pBlock, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) );\n\n"
+        "\t\tc_ocoa_profile_thread_counters = pBlock->counters;\n"
+        "\t}\n\n"
+        "\treturn c_ocoa_profile_thread_counters + ( siteIndex - 1u );\n"
+        "}\n\n"
+        "static int c_ocoa_profile_compare_entry_name( const void* pA, const void* pB )\n"
+        "{\n"
+        "\treturn strcmp( ( (const c_ocoa_profile_entry_t*)pA )->pName, ( (const c_ocoa_profile_entry_t*)pB )->pName );\n"
+        "}\n\n"
+        "static int c_ocoa_profile_compare_entry_ticks( const void* pA, const void* pB )\n"
+        "{\n"
+        "\tconst uint64_t ticksA = ( (const c_ocoa_profile_entry_t*)pA )->ticks;\n"
+        "\tconst uint64_t ticksB = ( (const c_ocoa_profile_entry_t*)pB )->ticks;\n"
+        "\treturn ticksA < ticksB ? 1 : ( ticksA > ticksB ? -1 : 0 );\n"
+        "}\n\n"
+        "static uint64_t c_ocoa_profile_ticks_to_nanoseconds( uint64_t ticks )\n"
+        "{\n"
+        "#ifdef __APPLE__\n"
+        "\tmach_timebase_info_data_t timebase;\n"
+        "\tmach_timebase_info( &timebase );\n"
+        "\treturn (uint64_t)( (double)ticks * (double)timebase.numer / (double)timebase.denom );\n"
+        "#else\n"
+        "\treturn ticks;\n"
+        "#endif\n"
+        "}\n\n"
+        "void c_ocoa_profile_dump( FILE* pFile, c_ocoa_profile_format format )\n"
+        "{\n"
+        "\tuint32_t siteCount = __atomic_load_n( &c_ocoa_profile_site_count, __ATOMIC_ACQUIRE );\n"
+        "\tsiteCount = siteCount > C_OCOA_PROFILE_MAX_SITES ? C_OCOA_PROFILE_MAX_SITES : siteCount;\n\n"
+        "\tc_ocoa_profile_entry_t* pEntries = (c_ocoa_profile_entry_t*)calloc( siteCount + 1u, sizeof( c_ocoa_profile_entry_t ) );\n"
+        "\tif( pEntries == NULL )\n"
+        "\t{\n"
+        "\t\treturn;\n"
+        "\t}\n\n"
+        "\tuint32_t entryCount = 0u;\n"
+        "\tfor( uint32_t siteIndex = 0u; siteIndex < siteCount; ++siteIndex )\n"
+        "\t{\n"
+        "\t\tconst c_ocoa_profile_site_t* pSite = __atomic_load_n( &c_ocoa_profile_sites[ siteIndex ], __ATOMIC_ACQUIRE );\n"
+        "\t\tif( pSite == NULL )\n"
+        "\t\t{\n"
+        "\t\t\tcontinue;\n"
+        "\t\t}\n\n"
+        "\t\tc_ocoa_profile_entry_t* pEntry = pEntries + entryCount++;\n"
+        "\t\tpEntry->pName = pSite->pName;\n"
+        "\t\tfor( c_ocoa_profile_thread_block_t* pBlock = __atomic_load_n( &c_ocoa_profile_thread_blocks, __ATOMIC_ACQUIRE ); pBlock != NULL; pBlock = pBlock->pNext )\n"
+        "\t\t{\n"
+        "\t\t\tpEntry->callCount\t+= __atomic_load_n( &pBlock->counters[ siteIndex ].callCount, __ATOMIC_RELAXED );\n"
+        "\t\t\tpEntry->ticks\t\t+= __atomic_load_n( &pBlock->counters[ siteIndex ].ticks, __ATOMIC_RELAXED );\n"
+        "\t\t}\n"
+        "\t}\n\n"
+        "\t//FK: Header-only wrappers have one site per translation unit, merge sites with the same name\n"
+        "\tqsort( pEntries, entryCount, sizeof( c_ocoa_profile_entry_t ), c_ocoa_profile_compare_entry_name );\n"
+        "\tuint32_t mergedEntryCount = 0u;\n"
+        "\tfor( uint32_t entryIndex = 0u; entryIndex < entryCount; ++entryIndex )\n"
+        "\t{\n"
+        "\t\tif( mergedEntryCount > 0u && strcmp( pEntries[ mergedEntryCount - 1u ].pName, pEntries[ entryIndex ].pName ) == 0 )\n"
+        "\t\t{\n"
+        "\t\t\tpEntries[ mergedEntryCount - 1u ].callCount\t+= pEntries[ entryIndex ].callCount;\n"
+        "\t\t\tpEntries[ mergedEntryCount - 1u ].ticks\t\t+= pEntries[ entryIndex ].ticks;\n"
+        "\t\t\tcontinue;\n"
+        "\t\t}\n\n"
+        "\t\tpEntries[ mergedEntryCount++ ] = pEntries[ entryIndex ];\n"
+        "\t}\n\n"
+        "\tqsort( pEntries, mergedEntryCount, sizeof( c_ocoa_profile_entry_t ), c_ocoa_profile_compare_entry_ticks );\n\n"
+        "\tif( format == C_OCOA_PROFILE_FORMAT_JSON )\n"
+        "\t{\n"
+        "\t\tfprintf( pFile, \"[\\n\" );\n"
+        "\t}\n"
+        "\telse\n"
+        "\t{\n"
+        "\t\tfprintf( pFile, \"%-64s %14s %16s %12s\\n\", \"wrapper\", \"calls\", \"total ns\", \"ns/call\" );\n"
+        "\t}\n\n"
+        "\tfor( uint32_t entryIndex = 0u; entryIndex < mergedEntryCount; ++entryIndex )\n"
+        "\t{\n"
+        "\t\tconst c_ocoa_profile_entry_t* pEntry = pEntries + entryIndex;\n"
+        "\t\tconst uint64_t totalNanoseconds = c_ocoa_profile_ticks_to_nanoseconds( pEntry->ticks );\n"
+        "\t\tconst double nanosecondsPerCall = pEntry->callCount > 0u ? (double)totalNanoseconds / (double)pEntry->callCount : 0.0;\n\n"
+        "\t\tif( format == C_OCOA_PROFILE_FORMAT_JSON )\n"
+        "\t\t{\n"
+        "\t\t\tfprintf( pFile, \"\\t{ \\\"name\\\": \\\"%s\\\", \\\"calls\\\": %llu, \\\"total_ns\\\": %llu, \\\"ns_per_call\\\": %.1f }%s\\n\",\n"
+        "\t\t\t\tpEntry->pName, (unsigned long long)pEntry->callCount, (unsigned long long)totalNanoseconds, nanosecondsPerCall, entryIndex + 1u < mergedEntryCount ? \",\" : \"\" );\n"
+        "\t\t}\n"
+        "\t\telse\n"
+        "\t\t{\n"
+        "\t\t\tfprintf( pFile, \"%-64s %14llu %16llu %12.1f\\n\", pEntry->pName, (unsigned long long)pEntry->callCount, (unsigned long long)totalNanoseconds, nanosecondsPerCall );\n"
+        "\t\t}\n"
+        "\t}\n\n"
+        "\tif( format == C_OCOA_PROFILE_FORMAT_JSON )\n"
+        "\t{\n"
+        "\t\tfprintf( pFile, \"]\\n\" );\n"
+        "\t}\n\n"
+        "\tfree( pEntries );\n"
+        "}\n"
+        "#endif\n\n",
+        pRuntimeSourceFileHandle );
+}
+
+void file_write_c_runtime_header( FILE* pRuntimeHeaderFileHandle )
+{
+    file_write_generated_comment( pRuntimeHeaderFileHandle );
+    fprintf( pRuntimeHeaderFileHandle, "#ifndef C_OCOA_RUNTIME_HEADER\n" );
+    fprintf( pRuntimeHeaderFileHandle, "#define C_OCOA_RUNTIME_HEADER\n\n" );
+    fprintf( pRuntimeHeaderFileHandle, "#include <stdint.h>\n" );
+    fprintf( pRuntimeHeaderFileHandle, "#include <stddef.h>\n" );
+    fprintf( pRuntimeHeaderFileHandle, "#include <objc/runtime.h>\n" );
+    fprintf( pRuntimeHeaderFileHandle, "#include <objc/message.h>\n\n" );
+    fprintf( pRuntimeHeaderFileHandle, "#ifdef __cplusplus\n" );
+    fprintf( pRuntimeHeaderFileHandle, "extern \"C\" {\n" );
+    fprintf( pRuntimeHeaderFileHandle, "#endif\n\n" );
+
+    file_write_c_runtime_header_imp_cache( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_availability( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_ivars( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_direct_entry_points( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_autorelease_pool( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_blocks( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_collections( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_strings( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_data( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_event_pump( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_main_queue( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_registry( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_delegates( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_frameworks( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_header_profile( pRuntimeHeaderFileHandle );
+
+    fprintf( pRuntimeHeaderFileHandle, "#ifdef __cplusplus\n" );
+    fprintf( pRuntimeHeaderFileHandle, "}\n" );
+    fprintf( pRuntimeHeaderFileHandle, "#endif\n\n" );
+    fprintf( pRuntimeHeaderFileHandle, "#endif" );
+}
+
+void file_write_c_runtime_source( FILE* pRuntimeSourceFileHandle )
+{
+    file_write_generated_comment( pRuntimeSourceFileHandle );
+    fprintf( pRuntimeSourceFileHandle, "#include \"c_ocoa_runtime.h\"\n\n" );
+
+    file_write_c_runtime_source_imp_cache( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_availability( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_ivars( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_direct_entry_points( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_blocks( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_collections( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_strings( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_data( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_event_pump( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_main_queue( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_registry( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_delegates( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_frameworks( pRuntimeSourceFileHandle );
+    file_write_c_runtime_source_profile( pRuntimeSourceFileHandle );
+}
+
+void file_write_cpp_runtime_header( FILE* pRuntimeCppHeaderFileHandle )
+{
+    file_write_generated_comment( pRuntimeCppHeaderFileHandle );
+    fputs(
+        "#ifndef C_OCOA_RUNTIME_HPP\n"
+        "#define C_OCOA_RUNTIME_HPP\n\n"
+        "#include <type_traits>\n"
+        "#include \"c_ocoa_types.h\"\n"
+        "#include \"c_ocoa_runtime.h\"\n\n"
+        "namespace c_ocoa\n"
+        "{\n"
+        "\tenum class abi_class\n"
+        "\t{\n"
+        "\t\tregular,\t// objc_msgSend\n"
+        "\t\tstret,\t\t// objc_msgSend_stret, struct is returned via hidden pointer argument\n"
+        "\t\tfpret\t\t// objc_msgSend_fpret, return value is on the x87 FPU stack\n"
+        "\t};\n\n"
+        "\t// Only structs and unions can be returned via hidden pointer argument (split so that sizeof() isn't used on void)\n"
+        "\ttemplate<class R, bool IsAggregate = std::is_class<R>::value || std::is_union<R>::value>\n"
+        "\tstruct returns_in_memory : std::false_type {};\n\n"
+        "\ttemplate<class R>\n"
+        "\tstruct returns_in_memory<R, true> : std::integral_constant<bool,\n"
+        "#if defined(__x86_64__)\n"
+        "\t\t( sizeof( R ) > 16u )\n"
+        "#elif defined(__i386__)\n"
+        "\t\t( sizeof( R ) != 1u && sizeof( R ) != 2u && sizeof( R ) != 4u && sizeof( R ) != 8u )\n"
+        "#elif defined(__arm__)\n"
+        "\t\t( sizeof( R ) > 4u )\n"
+        "#else\n"
+        "\t\tfalse\n"
+        "#endif\n"
+        "\t> {};\n\n"
+        "\ttemplate<class R>\n"
+        "\tstruct returns_on_fpu_stack : std::integral_constant<bool,\n"
+        "#if defined(__i386__)\n"
+        "\t\tstd::is_floating_point<R>::value\n"
+        "#elif defined(__x86_64__)\n"
+        "\t\tstd::is_same<R, long double>::value\n"
+        "#else\n"
+        "\t\tfalse\n"
+        "#endif\n"
+        "\t> {};\n\n"
+        "\ttemplate<class R>\n"
+        "\tstruct abi_class_of : std::integral_constant<abi_class, returns_in_memory<R>::value ? abi_class::stret : ( returns_on_fpu_stack<R>::value ? abi_class::fpret : abi_class::regular )> {};\n\n"
+        "\ttemplate<abi_class ABI>\n"
+        "\tstruct msg_send;\n\n"
+        "\ttemplate<>\n"
+        "\tstruct msg_send<abi_class::regular>\n"
+        "\t{\n"
+        "\t\ttemplate<class R, class... A>\n"
+        "\t\tstatic inline R send( id pObject, SEL pSelector, A... arguments )\n"
+        "\t\t{\n"
+        "\t\t\treturn reinterpret_cast<R (*)( id, SEL, A... )>( objc_msgSend )( pObject, pSelector, arguments... );\n"
+        "\t\t}\n"
+        "\t};\n\n"
+        "#if !defined(__arm64__) && !defined(__aarch64__)\n"
+        "\ttemplate<>\n"
+        "\tstruct msg_send<abi_class::stret>\n"
+        "\t{\n"
+        "\t\ttemplate<class R, class... A>\n"
+        "\t\tstatic inline R send( id pObject, SEL pSelector, A... arguments )\n"
+        "\t\t{\n"
+        "\t\t\treturn reinterpret_cast<R (*)( id, SEL, A... )>( objc_msgSend_stret )( pObject, pSelector, arguments... );\n"
+        "\t\t}\n"
+        "\t};\n"
+        "#endif\n\n"
+        "#if defined(__i386__) || defined(__x86_64__)\n"
+        "\ttemplate<>\n"
+        "\tstruct msg_send<abi_class::fpret>\n"
+        "\t{\n"
+        "\t\ttemplate<class R, class... A>\n"
+        "\t\tstatic inline R send( id pObject, SEL pSelector, A... arguments )\n"
+        "\t\t{\n"
+        "\t\t\treturn reinterpret_cast<R (*)( id, SEL, A... )>( objc_msgSend_fpret )( pObject, pSelector, arguments... );\n"
+        "\t\t}\n"
+        "\t};\n"
+        "#endif\n\n"
+        "\t// The objc_msgSend variant is picked at compile time based on the return type,\n"
+        "\t// this compiles to the same code as a hand written objc_msgSend cast.\n"
+        "\ttemplate<class R, class... A>\n"
+        "\tinline R send( id pObject, SEL pSelector, A... arguments )\n"
+        "\t{\n"
+        "\t\treturn msg_send<abi_class_of<R>::value>::template send<R, A...>( pObject, pSelector, arguments... );\n"
+        "\t}\n\n"
+        "\t// Thin handle for any Objective-C object, the generated classes derive from this.\n"
+        "\tstruct object\n"
+        "\t{\n"
+        "\t\tid pObject = nullptr;\n\n"
+        "\t\tobject() = default;\n"
+        "\t\texplicit object( id pObjectToWrap ) : pObject( pObjectToWrap ) {}\n"
+        "\t\texplicit object( void* pObjectToWrap ) : pObject( (id)pObjectToWrap ) {}\n\n"
+        "\t\toperator id() const { return pObject; }\n"
+        "\t\texplicit operator bool() const { return pObject != nullptr; }\n"
+        "\t};\n"
+        "}\n\n"
+        "#endif",
+        pRuntimeCppHeaderFileHandle );
+}
+
+const char* objc_find_class_image_name( Class pClass )
+{
+#ifdef __APPLE__
+    return class_getImageName( pClass );
+#else
+    //FK: GNUstep libobjc2 doesn't implement class_getImageName(). Compiled classes are used in place, so the class
+    //    structure itself lives in the image that defines the class. Classes that have been registered at runtime
+    //    live on the heap and aren't part of any image.
+    Dl_info imageInfo;
+    if( dladdr( (void*)pClass, &imageInfo ) != 0 && imageInfo.dli_fname != NULL )
+    {
+        return imageInfo.dli_fname;
+    }
+
+    //FK: Fall back to the class symbol, '._OBJC_CLASS_<name>' (gnustep-2.0 ABI) or '_OBJC_CLASS_<name>' (gnustep-1.x ABI)
+    const char* pClassSymbolPrefixes[] = { "._OBJC_CLASS_", "_OBJC_CLASS_" };
+    for( size_t prefixIndex = 0u; prefixIndex < array_count( pClassSymbolPrefixes ); ++prefixIndex )
+    {
+        char classSymbolName[ 256 ];
+        if( snprintf( classSymbolName, sizeof( classSymbolName ), "%s%s", pClassSymbolPrefixes[ prefixIndex ], class_getName( pClass ) ) >= (int)sizeof( classSymbolName ) )
+        {
+            continue;
+        }
+
+        void* pClassSymbol = dlsym( RTLD_DEFAULT, classSymbolName );
+        if( pClassSymbol != NULL && dladdr( pClassSymbol, &imageInfo ) != 0 && imageInfo.dli_fname != NULL )
+        {
+            return imageInfo.dli_fname;
+        }
+    }
+
+    return NULL;
+#endif
+}
+
+//FK: Only frameworks and shared libraries can be loaded lazily, classes of the executable itself
+//    (or classes that have been registered at runtime) are looked up via objc_getClass()
+boolean8_t framework_image_is_loadable( const char* pImagePath )
+{
+    if( strstr( pImagePath, ".framework/" ) != NULL )
+    {
+        return 1;
+    }
+
+    const char* pFileName = strrchr( pImagePath, '/' );
+    pFileName = pFileName == NULL ? pImagePath : pFileName + 1;
+
+    const size_t fileNameLength = strlen( pFileName );
+    if( fileNameLength > 6u && strcmp( pFileName + fileNameLength - 6u, ".dylib" ) == 0 )
+    {
+        return 1;
+    }
+
+    //FK: 'libfoo.so' or versioned 'libfoo.so.0.29', but not 'foo.sock' or 'my.solver/app'
+    const char* pSharedObjectExtension = strstr( pFileName, ".so" );
+    while( pSharedObjectExtension != NULL )
+    {
+        const char* pVersion = pSharedObjectExtension + 3;
+        while( *pVersion == '.' && pVersion[ 1 ] >= '0' && pVersion[ 1 ] <= '9' )
+        {
+            ++pVersion;
+            while( *pVersion >= '0' && *pVersion <= '9' )
+            {
+                ++pVersion;
+            }
+        }
+
+        if( *pVersion == 0 )
+        {
+            return pSharedObjectExtension > pFileName;
+        }
+
+        pSharedObjectExtension = strstr( pSharedObjectExtension + 1, ".so" );
+    }
+
+    return 0;
+}
+
+//FK: '/System/Library/Frameworks/AppKit.framework/Versions/C/AppKit' -> 'AppKit'
+//    '/usr/lib/libgnustep-gui.so.0.29' -> 'gnustep-gui'
+char* framework_create_name( const char* pImagePath )
+{
+    const char* pFrameworkExtension = strstr( pImagePath, ".framework/" );
+    const char* pNameEnd = pFrameworkExtension;
+    if( pNameEnd == NULL )
+    {
+        pNameEnd = pImagePath + strlen( pImagePath );
+    }
+
+    const char* pNameStart = pNameEnd;
+    while( pNameStart > pImagePath && pNameStart[ -1 ] != '/' )
+    {
+        --pNameStart;
+    }
+
+    if( pFrameworkExtension == NULL )
+    {
+        if( strncmp( pNameStart, "lib", 3 ) == 0 )
+        {
+            pNameStart += 3;
+        }
+
+        pNameEnd = strchr( pNameStart, '.' );
+        if( pNameEnd == NULL )
+        {
+            pNameEnd = pNameStart + strlen( pNameStart );
+        }
+    }
+
+    return string_allocate_copy( pNameStart, cast_size_to_int32( pNameEnd - pNameStart ) );
+}
+
+const char* framework_collection_find_or_add( c_ocoa_framework_collection* pFrameworkCollection, const char* pImagePath )
+{
+    if( pImagePath == NULL || !framework_image_is_loadable( pImagePath ) )
+    {
+        return NULL;
+    }
+
+    for( uint32_t frameworkIndex = 0u; frameworkIndex < pFrameworkCollection->size; ++frameworkIndex )
+    {
+        if( strcmp( pFrameworkCollection->pEntries[ frameworkIndex ].pImagePath, pImagePath ) == 0 )
+        {
+            return pFrameworkCollection->pEntries[ frameworkIndex ].pIdentifier;
+        }
+    }
+
+    if( pFrameworkCollection->size == pFrameworkCollection->capacity )
+    {
+        const uint32_t newCapacity = pFrameworkCollection->capacity == 0u ? 16u : pFrameworkCollection->capacity * 2u;
+        c_ocoa_framework_entry* pNewEntries = (c_ocoa_framework_entry*)realloc( pFrameworkCollection->pEntries, sizeof( c_ocoa_framework_entry ) * newCapacity );
+        if( pNewEntries == NULL )
+        {
+            printf_stderr( "[error] Out of memory - Couldn't add framework '%s', classes of it won't be loaded lazily.\n", pImagePath );
+            return NULL;
+        }
+
+        pFrameworkCollection->pEntries = pNewEntries;
+        pFrameworkCollection->capacity = newCapacity;
+    }
+
+    char* pName = framework_create_name( pImagePath );
+    char* pImagePathCopy = string_allocate_copy( pImagePath, string_get_length_excl_null_terminator( pImagePath ) );
+
+    //FK: +12 for a '_<index>' suffix in case two images end up with the same identifier
+    const int32_t nameLength = pName == NULL ? 0 : string_get_length_excl_null_terminator( pName );
+    char* pIdentifier = (char*)malloc( nameLength + 12 + 1 );
+    if( pName == NULL || pImagePathCopy == NULL || pIdentifier == NULL )
+    {
+        free( pName );
+        free( pImagePathCopy );
+        free( pIdentifier );
+        return NULL;
+    }
+
+    for( int32_t charIndex = 0; charIndex < nameLength; ++charIndex )
+    {
+        const char character = pName[ charIndex ];
+        const boolean8_t isAlphaNumeric = ( character >= 'a' && character <= 'z' ) || ( character >= 'A' && character <= 'Z' ) || ( character >= '0' && character <= '9' );
+        pIdentifier[ charIndex ] = isAlphaNumeric ? convertCharacterToLower( character ) : '_';
+    }
+    pIdentifier[ nameLength ] = 0;
+
+    for( uint32_t frameworkIndex = 0u; frameworkIndex < pFrameworkCollection->size; ++frameworkIndex )
+    {
+        if( strcmp( pFrameworkCollection->pEntries[ frameworkIndex ].pIdentifier, pIdentifier ) == 0 )
+        {
+            sprintf( pIdentifier + nameLength, "_%u", pFrameworkCollection->size );
+            break;
+        }
+    }
+
+    c_ocoa_framework_entry* pEntry = pFrameworkCollection->pEntries + pFrameworkCollection->size;
+    pEntry->pName       = pName;
+    pEntry->pIdentifier = pIdentifier;
+    pEntry->pImagePath  = pImagePathCopy;
+    ++pFrameworkCollection->size;
+
+    return pIdentifier;
+}
+
+void file_write_c_frameworks_header( FILE* pFrameworksHeaderFileHandle, const c_ocoa_framework_collection* pFrameworkCollection )
+{
+    file_write_generated_comment( pFrameworksHeaderFileHandle );
+    fprintf( pFrameworksHeaderFileHandle, "#ifndef C_OCOA_FRAMEWORKS_HEADER\n" );
+    fprintf( pFrameworksHeaderFileHandle, "#define C_OCOA_FRAMEWORKS_HEADER\n\n" );
+    fprintf( pFrameworksHeaderFileHandle, "#include \"c_ocoa_runtime.h\"\n\n" );
+    fprintf( pFrameworksHeaderFileHandle, "#ifdef __cplusplus\n" );
+    fprintf( pFrameworksHeaderFileHandle, "extern \"C\" {\n" );
+    fprintf( pFrameworksHeaderFileHandle, "#endif\n\n" );
+    fprintf( pFrameworksHeaderFileHandle, "// Frameworks of the generated classes, each one gets dlopen()ed when the first class of it is looked up.\n" );
+
+    for( uint32_t frameworkIndex = 0u; frameworkIndex < pFrameworkCollection->size; ++frameworkIndex )
+    {
+        fprintf( pFrameworksHeaderFileHandle, "extern c_ocoa_framework_t c_ocoa_framework_%s;\n", pFrameworkCollection->pEntries[ frameworkIndex ].pIdentifier );
+    }
+
+    fprintf( pFrameworksHeaderFileHandle, "\nextern c_ocoa_framework_t* const\tc_ocoa_frameworks[];\n" );
+    fprintf( pFrameworksHeaderFileHandle, "extern const size_t\t\t\t\t\tc_ocoa_framework_count;\n\n" );
+    fprintf( pFrameworksHeaderFileHandle, "// Writes which frameworks have been touched so far, eg: call it once the first frame has been presented.\n" );
+    fprintf( pFrameworksHeaderFileHandle, "void c_ocoa_frameworks_report( FILE* pFile );\n\n" );
+    fprintf( pFrameworksHeaderFileHandle, "#ifdef __cplusplus\n" );
+    fprintf( pFrameworksHeaderFileHandle, "}\n" );
+    fprintf( pFrameworksHeaderFileHandle, "#endif\n\n" );
+    fprintf( pFrameworksHeaderFileHandle, "#endif" );
+}
+
+void file_write_c_frameworks_source( FILE* pFrameworksSourceFileHandle, const c_ocoa_framework_collection* pFrameworkCollection )
+{
+    file_write_generated_comment( pFrameworksSourceFileHandle );
+    fprintf( pFrameworksSourceFileHandle, "#include \"c_ocoa_frameworks.h\"\n\n" );
+
+    for( uint32_t frameworkIndex = 0u; frameworkIndex < pFrameworkCollection->size; ++frameworkIndex )
+    {
+        const c_ocoa_framework_entry* pEntry = pFrameworkCollection->pEntries + frameworkIndex;
+        fprintf( pFrameworksSourceFileHandle, "c_ocoa_framework_t c_ocoa_framework_%s = { \"%s\", \"%s\", NULL, 0u, C_OCOA_FRAMEWORK_STATE_UNTOUCHED };\n", pEntry->pIdentifier, pEntry->pName, pEntry->pImagePath );
+    }
+
+    fprintf( pFrameworksSourceFileHandle, "\nc_ocoa_framework_t* const c_ocoa_frameworks[] =\n{\n" );
+    for( uint32_t frameworkIndex = 0u; frameworkIndex < pFrameworkCollection->size; ++frameworkIndex )
+    {
+        fprintf( pFrameworksSourceFileHandle, "\t&c_ocoa_framework_%s,\n", pFrameworkCollection->pEntries[ frameworkIndex ].pIdentifier );
+    }
+
+    //FK: Keep the array non-empty, zero sized arrays aren't valid C
+    if( pFrameworkCollection->size == 0u )
+    {
+        fprintf( pFrameworksSourceFileHandle, "\tNULL\n" );
+    }
+    fprintf( pFrameworksSourceFileHandle, "};\n\n" );
+    fprintf( pFrameworksSourceFileHandle, "const size_t c_ocoa_framework_count = %uu;\n\n", pFrameworkCollection->size );
+    fprintf( pFrameworksSourceFileHandle, "void c_ocoa_frameworks_report( FILE* pFile )\n" );
+    fprintf( pFrameworksSourceFileHandle, "{\n" );
+    fprintf( pFrameworksSourceFileHandle, "\tc_ocoa_framework_report( pFile, c_ocoa_frameworks, c_ocoa_framework_count );\n" );
+    fprintf( pFrameworksSourceFileHandle, "}\n" );
+}
+
+boolean8_t c_ocoa_create_framework_files( const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_framework_collection* pFrameworkCollection, c_ocoa_string_allocator* pStringAllocator )
+{
+    const char* pOutputPath = pParameter->pOutputPath == NULL ? "" : pParameter->pOutputPath;
+    const int32_t outputPathLength = string_get_length_excl_null_terminator( pOutputPath );
+
+    //FK: Same as the runtime files, no file prefix. +19 for "c_ocoa_frameworks.x" +1 for null terminator
+    char* pFrameworksHeaderFileName = string_allocator_allocate( pStringAllocator, outputPathLength + 19 + 1 );
+    char* pFrameworksSourceFileName = string_allocator_allocate( pStringAllocator, outputPathLength + 19 + 1 );
+
+    sprintf( pFrameworksHeaderFileName, "%sc_ocoa_frameworks.h", pOutputPath );
+    sprintf( pFrameworksSourceFileName, "%sc_ocoa_frameworks.c", pOutputPath );
+
+    FILE* pFrameworksHeaderFileHandle = pParameter->fopen( pFrameworksHeaderFileName, "w" );
+    if( pFrameworksHeaderFileHandle == NULL )
+    {
+        printf_stderr( "[error] Couldn't open '%s' for writing.\n", pFrameworksHeaderFileName );
+        return 0u;
+    }
+
+    FILE* pFrameworksSourceFileHandle = pParameter->fopen( pFrameworksSourceFileName, "w" );
+    if( pFrameworksSourceFileHandle == NULL )
+    {
+        printf_stderr( "[error] Couldn't open '%s' for writing.\n", pFrameworksSourceFileName );
+        pParameter->fclose( pFrameworksHeaderFileHandle );
+        return 0u;
+    }
+
+    file_write_c_frameworks_header( pFrameworksHeaderFileHandle, pFrameworkCollection );
+    file_write_c_frameworks_source( pFrameworksSourceFileHandle, pFrameworkCollection );
+
+    pParameter->fclose( pFrameworksHeaderFileHandle );
+    pParameter->fclose( pFrameworksSourceFileHandle );
+    return 1u;
+}
+
+boolean8_t c_ocoa_create_runtime_files( const c_ocoa_code_generator_parameter* pParameter, c_ocoa_string_allocator* pStringAllocator )
+{
+    const char* pOutputPath = pParameter->pOutputPath == NULL ? "" : pParameter->pOutputPath;
+    const int32_t outputPathLength = string_get_length_excl_null_terminator( pOutputPath );
+
+    //FK: The generated files include "c_ocoa_runtime.h" without prefix, so the file prefix isn't applied here
+    //    +16 for "c_ocoa_runtime.x" +1 for null terminator
+    char* pRuntimeHeaderFileName = string_allocator_allocate( pStringAllocator, outputPathLength + 16 + 1 );
+    char* pRuntimeSourceFileName = string_allocator_allocate( pStringAllocator, outputPathLength + 16 + 1 );
+
+    sprintf( pRuntimeHeaderFileName, "%sc_ocoa_runtime.h", pOutputPath );
+    sprintf( pRuntimeSourceFileName, "%sc_ocoa_runtime.c", pOutputPath );
+
+    FILE* pRuntimeHeaderFileHandle = pParameter->fopen( pRuntimeHeaderFileName, "w" );
+    if( pRuntimeHeaderFileHandle == NULL )
+    {
+        printf_stderr( "[error] Couldn't open '%s' for writing.\n", pRuntimeHeaderFileName );
+        return 0u;
+    }
+
+    FILE* pRuntimeSourceFileHandle = pParameter->fopen( pRuntimeSourceFileName, "w" );
+    if( pRuntimeSourceFileHandle == NULL )
+    {
+        printf_stderr( "[error] Couldn't open '%s' for writing.\n", pRuntimeSourceFileName );
+        pParameter->fclose( pRuntimeHeaderFileHandle );
+        return 0u;
+    }
+
+    file_write_c_runtime_header( pRuntimeHeaderFileHandle );
+    file_write_c_runtime_source( pRuntimeSourceFileHandle );
+
+    pParameter->fclose( pRuntimeHeaderFileHandle );
+    pParameter->fclose( pRuntimeSourceFileHandle );
+
+    if( pParameter->cppBackend )
+    {
+        //FK: +18 for "c_ocoa_runtime.hpp" +1 for null terminator
+        char* pRuntimeCppHeaderFileName = string_allocator_allocate( pStringAllocator, outputPathLength + 18 + 1 );
+        sprintf( pRuntimeCppHeaderFileName, "%sc_ocoa_runtime.hpp", pOutputPath );
+
+        FILE* pRuntimeCppHeaderFileHandle = pParameter->fopen( pRuntimeCppHeaderFileName, "w" );
+        if( pRuntimeCppHeaderFileHandle == NULL )
+        {
+            printf_stderr( "[error] Couldn't open '%s' for writing.\n", pRuntimeCppHeaderFileName );
+            return 0u;
+        }
+
+        file_write_cpp_runtime_header( pRuntimeCppHeaderFileHandle );
+        pParameter->fclose( pRuntimeCppHeaderFileHandle );
+    }
+
+    return 1u;
+}
+
+boolean8_t c_ocoa_create_source_code_for_objc_class( const c_ocoa_code_generator_parameter* pParameter, c_ocoa_objc_type_dictionary* pTypeDict, c_ocoa_objc_function_collection* pFunctionCollection, c_ocoa_framework_collection* pFrameworkCollection, c_ocoa_string_allocator* pStringAllocator, Class pClass, const char* pClassName, int32_t classNameLength )
+{
+    if( pParameter->pClassNameFilter != NULL )
+    {
+        if( !string_name_matches_filter( pClassName, pParameter->pClassNameFilter ) )
+        {
+            return 0u;
+        }
+    }
+
+    c_ocoa_class_method_collection c_ocoa_class_method_collection = {};
+    if( !objc_runtime_collect_methods_from_class( &c_ocoa_class_method_collection, pClass, pClassName ) )
+    {
+        return 0u;
+    }
+
+    //FK: TODO: Instead of completely reparsing the base class over-and-over again,
+    //    we should use the type dict to speed up parsing...
+
+    //FK: Move up the class hiearchy
+    Class pSuperClass = class_getSuperclass( pClass );
+    while( pSuperClass != NULL )
+    {
+        const char* pSuperClassName = class_getName( pSuperClass );
+        if( !objc_runtime_collect_methods_from_class( &c_ocoa_class_method_collection, pSuperClass, pSuperClassName ) )
+        {
+            return 0u;
+        }
+
+        pSuperClass = class_getSuperclass( pSuperClass );
+    }
+
+    c_ocoa_objc_class_name className;
+    if( !objc_create_class_name( &className, pClassName, classNameLength ) )
+    {
+        return 0u;
+    }
+
+    if( pFrameworkCollection != NULL )
+    {
+        className.pFrameworkIdentifier = framework_collection_find_or_add( pFrameworkCollection, objc_find_class_image_name( pClass ) );
+    }
+
+    const char* pOutputPath = pParameter->pOutputPath == NULL ? "" : pParameter->pOutputPath;
+    const char* pFilePrefix = pParameter->pPrefix == NULL ? "" : pParameter->pPrefix;
+    const int32_t outputPathLength = string_get_length_excl_null_terminator( pOutputPath );
+    const int32_t filePrefixLength = string_get_length_excl_null_terminator( pFilePrefix );
+
+    //FK: +2 for file extension (.c/.h) +1 for null terminator
+    char* pHeaderFileName = string_allocator_allocate( pStringAllocator, outputPathLength + filePrefixLength + classNameLength + 2 + 1 );
+    char* pSourceFileName = string_allocator_allocate( pStringAllocator, outputPathLength + filePrefixLength + classNameLength + 2 + 1 );
+
+    sprintf( pHeaderFileName, "%s%s%s.h", pOutputPath, pFilePrefix, className.pNameLower );
+    sprintf( pSourceFileName, "%s%s%s.c", pOutputPath, pFilePrefix, className.pNameLower );
+
+    //FK: In header-only mode the implementation is written into the header
+    FILE* pHeaderFileHandle = pParameter->fopen( pHeaderFileName, "w" );
+    FILE* pSourceFileHandle = pParameter->headerOnly ? pHeaderFileHandle : pParameter->fopen( pSourceFileName, "w" );
+
+    if( pSourceFileHandle == NULL )
+    {
+        printf_stderr( "[error] Couldn't open '%s' for writing.\n", pSourceFileName );
+        return 0u;
+    }
+
+    if( pHeaderFileName == NULL )
+    {
+        printf_stderr( "[error] Couldn't open '%s' for writing.\n", pHeaderFileName );
+        return 0u;
+    }
+
+    const c_ocoa_class_family classFamily = objc_find_class_family( pClass );
+
+    file_write_c_header_prefix( pHeaderFileHandle, &className );
+    if( pParameter->headerOnly )
+    {
+        file_write_c_implementation_prefix( pHeaderFileHandle );
+        fprintf( pHeaderFileHandle, "\n" );
+    }
+    else
+    {
+        file_write_c_source_prefix( pSourceFileHandle, pHeaderFileName, &className );
+    }
+
+    if( className.pFrameworkIdentifier != NULL )
+    {
+        fprintf( pSourceFileHandle, "#include \"c_ocoa_frameworks.h\"\n\n" );
+    }
+
+    if( ( classFamily != ClassFamily_None || pParameter->registry ) && !pParameter->headerOnly )
+    {
+        //FK: The class family helpers and the registry use types of the runtime header (eg: c_ocoa_collection_iterator_t)
+        fprintf( pHeaderFileHandle, "#include \"c_ocoa_runtime.h\"\n\n" );
+    }
+
+    FILE* pCppHeaderFileHandle = NULL;
+    if( pParameter->cppBackend )
+    {
+        //FK: +4 for file extension (.hpp) +1 for null terminator
+        char* pCppHeaderFileName = string_allocator_allocate( pStringAllocator, outputPathLength + filePrefixLength + classNameLength + 4 + 1 );
+        sprintf( pCppHeaderFileName, "%s%s%s.hpp", pOutputPath, pFilePrefix, className.pNameLower );
+
+        pCppHeaderFileHandle = pParameter->fopen( pCppHeaderFileName, "w" );
+        if( pCppHeaderFileHandle == NULL )
+        {
+            printf_stderr( "[error] Couldn't open '%s' for writing.\n", pCppHeaderFileName );
+            return 0u;
+        }
+
+        file_write_cpp_header_prefix( pCppHeaderFileHandle, &className );
+    }
+
+    c_ocoa_source_code_generator_input codeGenInput;
+    codeGenInput.pParameter             = pParameter;
+    codeGenInput.pHeaderFileHandle      = pHeaderFileHandle;
+    codeGenInput.pSourceFileHandle      = pSourceFileHandle;
+    codeGenInput.pCppHeaderFileHandle   = pCppHeaderFileHandle;
+    codeGenInput.pStringAllocator       = pStringAllocator;
+    codeGenInput.pTypeDict              = pTypeDict;
+    codeGenInput.pFunctionCollection    = pFunctionCollection;
+    codeGenInput.pClassName             = &className;
+
+    c_ocoa_registry_builder registryBuilder = {};
+    codeGenInput.pRegistryBuilder       = pParameter->registry ? &registryBuilder : NULL;
+    c_ocoa_create_source_code_for_objc_method_collection( &c_ocoa_class_method_collection, &codeGenInput );
+
+    if( pParameter->ivarAccessors )
+    {
+        c_ocoa_create_source_code_for_objc_ivar_accessors( &codeGenInput, pClass );
+    }
+
+    if( pParameter->snapshotSpecificationCount > 0u )
+    {
+        c_ocoa_create_source_code_for_objc_snapshot( &codeGenInput, pClass );
+    }
+
+    if( pParameter->registry )
+    {
+        file_write_c_registry( &codeGenInput );
+        registry_builder_free( &registryBuilder );
+    }
+
+    if( classFamily != ClassFamily_None )
+    {
+        file_write_c_class_family_helper_declarations( pHeaderFileHandle, pParameter, classFamily, &className );
+        file_write_c_class_family_helper_implementations( pSourceFileHandle, pParameter, classFamily, &className );
+    }
+    
+    file_write_c_header_suffix( pHeaderFileHandle );
+
+    if( pCppHeaderFileHandle != NULL )
+    {
+        file_write_cpp_header_suffix( pCppHeaderFileHandle );
+        pParameter->fclose( pCppHeaderFileHandle );
+    }
+    
+    pParameter->fclose( pHeaderFileHandle );
+    if( !pParameter->headerOnly )
+    {
+        pParameter->fclose( pSourceFileHandle );
+    }
+
+    return 1u;
+};
+
+//FK: '--snapshot' only applies to classes that get exported, a spec for a class that the class name filter
+//    doesn't match would silently do nothing
+void c_ocoa_warn_about_filtered_snapshot_classes( const c_ocoa_code_generator_parameter* pParameter )
+{
+    for( uint8_t specificationIndex = 0u; specificationIndex < pParameter->snapshotSpecificationCount; ++specificationIndex )
+    {
+        const char* pSpecification = pParameter->pSnapshotSpecifications[ specificationIndex ];
+        const char* pClassNameEnd = strchr( pSpecification, '=' );
+        if( pClassNameEnd == NULL )
+        {
+            printf_stderr( "[warning] Ignoring '--snapshot %s', expected '<class>=<property>,<property>,...'.\n", pSpecification );
+            continue;
+        }
+
+        char className[ 256 ];
+        const int32_t classNameLength = cast_size_to_int32( pClassNameEnd - pSpecification );
+        if( classNameLength >= (int32_t)sizeof( className ) )
+        {
+            continue;
+        }
+
+        memory_copy_non_overlapping( className, pSpecification, classNameLength );
+        className[ classNameLength ] = 0;
+
+        if( pParameter->pClassNameFilter != NULL && !string_name_matches_filter( className, pParameter->pClassNameFilter ) )
+        {
+            printf_stderr( "[warning] '--snapshot %s' has no effect, class '%s' doesn't match the class name filter '%s'.\n", pSpecification, className, pParameter->pClassNameFilter );
+        }
+    }
+}
+
+int c_ocoa_create_classes_api( const c_ocoa_code_generator_parameter* pCodeGeneratorParameter, c_ocoa_code_gen_context* pContext )
+{
+    c_ocoa_warn_about_filtered_snapshot_classes( pCodeGeneratorParameter );
+
+    const int totalClassCount = objc_getClassList( NULL, 0 );
+    const size_t totalClassBufferSizeInBytes = totalClassCount * sizeof( Class );
+    Class* ppClasses = ( Class* )malloc( totalClassBufferSizeInBytes );
+    if( ppClasses == NULL )
+    {
+        printf_stderr( "Out of memory - Couldn't allocate %.3fkB.", (float)totalClassBufferSizeInBytes/1024.f );
+        return 2;
+    }
+    
+    objc_getClassList(ppClasses, totalClassCount);
+
+    c_ocoa_framework_collection* pFrameworkCollection = pCodeGeneratorParameter->lazyFrameworks ? &pContext->frameworkCollection : NULL;
+    
+    const uint32_t maxClasses = totalClassCount;
+    for( uint32_t classIndex = 0u; classIndex < maxClasses; ++classIndex )
+    {
+        Class pClass = ppClasses[ classIndex ];
+        const char* pClassName = class_getName( pClass );
+        const int32_t classNameLength = string_get_length_incl_null_terminator( pClassName );
+
+        c_ocoa_create_source_code_for_objc_class( pCodeGeneratorParameter, &pContext->typeDict, &pContext->functionCollection, pFrameworkCollection, &pContext->stringAllocator, pClass, pClassName, classNameLength );
+        string_allocator_reset( &pContext->stringAllocator );
+    }
+
+    free( ppClasses );
+
+    if( pCodeGeneratorParameter->pProtocolNameFilter != NULL )
+    {
+        c_ocoa_create_protocols_api( pCodeGeneratorParameter, pContext );
+    }
+
+    c_ocoa_create_runtime_files( pCodeGeneratorParameter, &pContext->stringAllocator );
+    string_allocator_reset( &pContext->stringAllocator );
+
+    if( pFrameworkCollection != NULL )
+    {
+        c_ocoa_create_framework_files( pCodeGeneratorParameter, pFrameworkCollection, &pContext->stringAllocator );
+        string_allocator_reset( &pContext->stringAllocator );
+    }
+
+    FILE* pTypesFileHandle = pCodeGeneratorParameter->fopen( "c_ocoa_types.h", "w" );
+    if( pTypesFileHandle == NULL )
+    {
+        printf_stderr( "Could not open '%s' for writing.", "c_ocoa_types.h" );
+        return 0;
+    }
+
+    objc_type_dict_resolve_struct_types( &pContext->typeDict, pTypesFileHandle, pCodeGeneratorParameter->exportTypes );
+    
+    pCodeGeneratorParameter->fflush( pTypesFileHandle );
+    pCodeGeneratorParameter->fclose( pTypesFileHandle );
+    
+    return 0;
+}
+
+
+boolean8_t objc_function_collection_contains_function( const c_ocoa_objc_function_collection* pFunctionCollection, const c_ocoa_objc_class_name* pClassName, const char* pFunctionName, const int32_t functionNameLength )
+{
+    //FK: Skip the 'classname_' part of the function name (to save an allocation in the calling code)
+    //    eg: 'nsapplication_shutdown' -> skip 'nsapplication_'
+    const int32_t functionCharSkipCount = pClassName->length;
+
+    for( uint32_t functionIndex = 0u; functionIndex < pFunctionCollection->size; ++functionIndex )
+    {
+        const c_ocoa_objc_function_collection_entry* pFunctionNameEntry   = pFunctionCollection->pEntries + functionIndex;
+        const int32_t functionBaseNameLength                    = pFunctionNameEntry->functionNameLength - functionCharSkipCount;
+        assert_runtime( functionBaseNameLength > 0u );
+
+        if( functionBaseNameLength == functionNameLength )
+        {
+            const char* pFunctionBaseName = pFunctionNameEntry->pFunctionName + functionCharSkipCount;
+            if( string_is_equal( pFunctionBaseName, pFunctionName, functionNameLength ) )
+            {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void objc_function_collection_resize( c_ocoa_objc_function_collection* pFunctionCollection )
+{
+    const uint32_t newSize = pFunctionCollection->capacity * 2;
+    c_ocoa_objc_function_collection_entry* pNewEntries = ( c_ocoa_objc_function_collection_entry* )malloc( sizeof( c_ocoa_objc_function_collection_entry ) * newSize );
+    if( pNewEntries == NULL )
+    {
+        //FK: TODO: Error handling
+        return;
+    }
+
+    memory_copy_non_overlapping( pNewEntries, pFunctionCollection->pEntries, pFunctionCollection->capacity * sizeof( c_ocoa_objc_function_collection_entry ) );
+    pFunctionCollection->capacity = newSize;
+
+    free( pFunctionCollection->pEntries );
+    pFunctionCollection->pEntries = pNewEntries;
+}
+
+void objc_function_collection_add( c_ocoa_objc_function_collection* pFunctionCollection, const char* pFunctionName, const int32_t functionNameLength )
+{
+    const boolean8_t isFunctionCollectionFull = pFunctionCollection->capacity == pFunctionCollection->size;
+    if( isFunctionCollectionFull )
+    {
+        objc_function_collection_resize( pFunctionCollection );
+    }
+
+    const uint32_t entryIndex = pFunctionCollection->size;
+    pFunctionCollection->size++;
+
+    pFunctionCollection->pEntries[ entryIndex ].pFunctionName       = pFunctionName;
+    pFunctionCollection->pEntries[ entryIndex ].functionNameLength  = functionNameLength;
+}
+
+boolean8_t objc_class_uses_root_new( const c_ocoa_objc_class_name* pClassName )
+{
+    //FK: '+new' is only equivalent to '[[cls alloc] init]' as long as no class in the hierarchy overrides it
+    Class pClass = (Class)objc_getClass( pClassName->pName );
+    if( pClass == NULL )
+    {
+        return 0;
+    }
+
+    Class pRootClass = pClass;
+    while( class_getSuperclass( pRootClass ) != NULL )
+    {
+        pRootClass = class_getSuperclass( pRootClass );
+    }
+
+    SEL pNewSelector = sel_registerName( "new" );
+    return class_getMethodImplementation( object_getClass( (id)pClass ), pNewSelector ) == class_getMethodImplementation( object_getClass( (id)pRootClass ), pNewSelector );
+}
+
+const char* objc_find_direct_runtime_function( const c_ocoa_objc_class_name* pClassName, const char* pSelectorName, c_ocoa_method_type methodType, uint8_t argumentCount )
+{
+    if( argumentCount > 0u )
+    {
+        return NULL;
+    }
+
+    if( methodType == MethodType_Instance )
+    {
+        if( strcmp( pSelectorName, "retain" ) == 0 )
+        {
+            return "c_ocoa_retain";
+        }
+        else if( strcmp( pSelectorName, "release" ) == 0 )
+        {
+            return "c_ocoa_release";
+        }
+        else if( strcmp( pSelectorName, "autorelease" ) == 0 )
+        {
+            return "c_ocoa_autorelease";
+        }
+    }
+    else
+    {
+        if( strcmp( pSelectorName, "alloc" ) == 0 )
+        {
+            return "c_ocoa_alloc";
+        }
+        else if( strcmp( pSelectorName, "new" ) == 0 && objc_class_uses_root_new( pClassName ) )
+        {
+            return "c_ocoa_alloc_init";
+        }
+    }
+
+    return NULL;
+}
+
+boolean8_t objc_type_is_large_struct( const c_ocoa_objc_type_resolve_result* pTypeResolveResult )
+{
+    //FK: Structs larger than two registers are passed and returned in memory on all supported platforms
+    return !pTypeResolveResult->isReference && !pTypeResolveResult->isBaseType && pTypeResolveResult->typeSizeInBits > 128u;
+}
+
+c_ocoa_convert_result objc_parse_result_convert_to_function_definition( c_ocoa_string_allocator* pStringAllocator, c_ocoa_objc_function_resolve_result* pOutFunctionResolveResult, c_ocoa_objc_function_collection* pFunctionCollection, c_ocoa_objc_type_dictionary* pDict, c_ocoa_parse_result* pParseResult, const c_ocoa_objc_class_name* pClassName )
+{
+    if( !function_name_is_valid( pParseResult->pFunctionName ) )
+    {
+        //FK: Add log here?
+        return ConvertResult_InvalidFunctionName;
+    }
+
+    int32_t functionNameLength = pParseResult->functionNameLength;
+    const char* pFunctionNameColonPosition = string_find_next_char_position( pParseResult->pFunctionName, ':' );
+    if( pFunctionNameColonPosition != NULL )
+    {
+        functionNameLength = cast_size_to_int32( pFunctionNameColonPosition - pParseResult->pFunctionName );
+    }
+
+    if( objc_function_collection_contains_function( pFunctionCollection, pClassName, pParseResult->pFunctionName, functionNameLength ) )
+    {
+        return ConvertResult_AlreadyKnown;
+    }
+
+    const int32_t resolvedFunctionNameLength = functionNameLength + pClassName->length;
+    char* pResolvedFunctionName = (char*)malloc( resolvedFunctionNameLength + 1u );
+    if( pResolvedFunctionName == NULL )
+    {
+        return ConvertResult_OutOfMemory;
+    }
+
+    sprintf( pResolvedFunctionName, "%s_%.*s", pClassName->pNameLower, functionNameLength, pParseResult->pFunctionName );
+
+    //FK: Will take ownership of pResolvedFunctionName
+    objc_function_collection_add( pFunctionCollection, pResolvedFunctionName, resolvedFunctionNameLength );
+
+    c_ocoa_objc_function_resolve_result resolveResult = {};
+    resolveResult.pOriginalReturnType          = string_allocate_copy_with_allocator( pStringAllocator, pParseResult->pReturnType, pParseResult->returnTypeLength );
+    resolveResult.pOriginalArgumentTypes       = string_allocate_copy_with_allocator( pStringAllocator, pParseResult->pArguments, pParseResult->argumentLength );
+    resolveResult.pOriginalFunctionName        = string_allocate_copy_with_allocator( pStringAllocator, pParseResult->pFunctionName, pParseResult->functionNameLength );
+    resolveResult.pResolvedFunctionName        = pResolvedFunctionName;
+
+    c_ocoa_objc_type_resolve_result returnTypeResolveResult = {};
+    if( !objc_resolve_c_type_name( &returnTypeResolveResult, pDict, pParseResult->pReturnType, pParseResult->returnTypeLength ) )
+    {
+        printf_stderr( "[error] Couldn't resolve return type '%.*s' of function '%s'.\n", pParseResult->returnTypeLength, pParseResult->pReturnType, resolveResult.pResolvedFunctionName );
+        return ConvertResult_UnknownReturnType;
+    }
+
+    resolveResult.pResolvedReturnType = returnTypeResolveResult.pResolvedType;
+    resolveResult.pClassName          = pClassName;
+
+    const char* pArguments = pParseResult->pArguments;
+    uint8_t argumentCount = 0u;
+    const uint8_t maxArgumentCount = array_count( resolveResult.pResolvedArgumentTypes );
+    const uint8_t argumentsToSkip = 2; //FK: Skip first two arguments since these are always the object + the selector.
+
+    while( *pArguments )
+    {
+        const char* pArgumentStart = pArguments;
+        const char* pArgumentEnd = whitespace_find_next( pArgumentStart );
+        const int32_t argumentLength = cast_size_to_int32( pArgumentEnd - pArgumentStart );
+
+        if( argumentCount >= argumentsToSkip )
+        {
+            const uint8_t argumentIndex = argumentCount - argumentsToSkip;
+            assert_runtime( argumentIndex < maxArgumentCount );
+
+            c_ocoa_objc_type_resolve_result argumentResolveResult = {};
+            if( !objc_resolve_c_type_name( &argumentResolveResult, pDict, pArgumentStart, argumentLength ) )
+            {
+                printf_stderr( "[error] Couldn't resolve %d. argument type name '%.*s' of function '%s'.\n", argumentCount, argumentLength, pArgumentStart, resolveResult.pResolvedFunctionName );
+                return ConvertResult_UnknownArgumentType;
+            }
+
+            resolveResult.pResolvedArgumentTypes[ argumentIndex ] = argumentResolveResult.pResolvedType;
+            if( objc_type_is_large_struct( &argumentResolveResult ) )
+            {
+                resolveResult.largeStructArgumentMask |= 1u << argumentIndex;
+            }
+        }
+
+        ++argumentCount;
+        if( *pArgumentEnd == 0 )
+        {
+            break;
+        }
+
+        pArguments = pArgumentEnd + 1;
+    }
+
+    resolveResult.argumentCount         = argumentCount < argumentsToSkip ? 0 : argumentCount - argumentsToSkip;
+    resolveResult.isVoidFunction        = !returnTypeResolveResult.isReference && string_is_equal( resolveResult.pResolvedReturnType, "void", 5u );
+    resolveResult.isAllocFunction       = strcmp( resolveResult.pOriginalFunctionName, "alloc" ) == 0u;
+    resolveResult.pDirectRuntimeFunction = objc_find_direct_runtime_function( pClassName, resolveResult.pOriginalFunctionName, pParseResult->c_ocoa_method_type, resolveResult.argumentCount );
+    resolveResult.hasStructReturnValue  = !returnTypeResolveResult.isReference && !returnTypeResolveResult.isBaseType;
+    resolveResult.hasLargeStructReturnValue = objc_type_is_large_struct( &returnTypeResolveResult );
+    resolveResult.returnValueSizeInBits = returnTypeResolveResult.typeSizeInBits;
+    resolveResult.hasFloatReturnValue   = returnTypeResolveResult.isFloatingType;
+    resolveResult.methodType            = pParseResult->c_ocoa_method_type;
+
+    *pOutFunctionResolveResult = resolveResult;
+
+    return ConvertResult_Success;
+}
+
+const char* cfunction_get_linkage( const c_ocoa_code_generator_parameter* pParameter )
+{
+    //FK: In header-only mode the definitions live in the header, so they have to be 'static inline'
+    return pParameter->headerOnly ? "static inline " : "";
+}
+
+void cfunction_write_signature( FILE* pResultFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    //FK: Function name
+    fprintf( pResultFileHandle, "%s(", pFunctionDefinition->pResolvedFunctionName );
+
+    //FK: Special handling for init functions - don't pass class object (will be passed internally for better API usage)
+    if( pFunctionDefinition->methodType == MethodType_Instance && !pFunctionDefinition->isAllocFunction)
+    {
+        //FK: add object as first parameter instance methods
+        fprintf( pResultFileHandle, " %s_t object", pFunctionDefinition->pClassName->pNameLower );
+
+        for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionDefinition->argumentCount; ++argumentIndex )
+        {
+            fprintf( pResultFileHandle, ", %s arg%u", pFunctionDefinition->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
+        }
+    }
+    else
+    {
+        if( pFunctionDefinition->argumentCount > 0u )
+        {
+            fprintf( pResultFileHandle, " %s arg%u", pFunctionDefinition->pResolvedArgumentTypes[ 0 ], 0 );
+
+            for( uint8_t argumentIndex = 1u; argumentIndex < pFunctionDefinition->argumentCount; ++argumentIndex )
+            {   
+                fprintf( pResultFileHandle, ", %s arg%u", pFunctionDefinition->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
+            }
+        }
+    }
+
+    fprintf( pResultFileHandle, " )");
+}
+
+void cfunction_write_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{   
+    //FK: "guess" maximum tab count for nice formatting
+    //    getting the correct tab count for the longest
+    //    return type name would be too involved since
+    //    we currently run on a function by function basis
+    //    and thus don't know the maximum type name length
+    //    beforehand
+    const int32_t maxTabCount = 5u;
+    int32_t returnTypeLength = 0u;
+
+    fprintf(pResultFileHandle, "// Signature from Objective-C Runtime: %s %s %s\n", pFunctionDefinition->pOriginalReturnType, pFunctionDefinition->pOriginalFunctionName, pFunctionDefinition->pOriginalArgumentTypes );
+    fprintf( pResultFileHandle, "%s", cfunction_get_linkage( pParameter ) );
+
+    if( pFunctionDefinition->isAllocFunction )
+    {
+        //FK: little syntactic sugar, return correct type for init function(s)
+        returnTypeLength = fprintf( pResultFileHandle, "%s_t ", pFunctionDefinition->pClassName->pNameLower );
+    }
+    else
+    {
+        returnTypeLength = fprintf( pResultFileHandle, "%s ", pFunctionDefinition->pResolvedReturnType );
+    }
+
+    const int32_t spacesForTab = 4u;
+    const int32_t tabCountForReturnType = get_max( 0u, maxTabCount - ( returnTypeLength / spacesForTab ) );
+    for( int32_t tabIndex = 0u; tabIndex < tabCountForReturnType; ++tabIndex )
+    {
+        fprintf( pResultFileHandle, "\t" );
+    }
+
+    cfunction_write_signature( pResultFileHandle, pFunctionDefinition );
+
+    fprintf( pResultFileHandle, ";\n\n" );
+    fflush( pResultFileHandle );
+}
+
+const char* objc_find_msgsend_call( const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    //FK: This is sort of handwavy after some trial & error
+    if( pFunctionResolveResult->hasFloatReturnValue )
+    {
+        return "abi_objc_msgSend_fpret";
+    }
+    if( pFunctionResolveResult->hasLargeStructReturnValue )
+    {
+        return "abi_objc_msgSend_stret";
+    }
+
+    return "objc_msgSend";
+}
+
+void file_write_c_function_pointer_type( FILE* pSourceFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    fprintf( pSourceFileHandle, "(%s (*)( id, SEL", pFunctionResolveResult->pResolvedReturnType );
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+    {
+        const char* pArgumentType = pFunctionResolveResult->pResolvedArgumentTypes[ argumentIndex ];
+        fprintf( pSourceFileHandle, ", %s", pArgumentType );
+    }
+    fprintf( pSourceFileHandle, " ))" );
+}
+
+void file_write_c_function_call_arguments( FILE* pSourceFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+    {
+        fprintf( pSourceFileHandle, ", arg%hhu", argumentIndex );
+    }
+}
+
+const char* objc_find_receiver_expression( const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    return pFunctionResolveResult->methodType == MethodType_Class ? "(id)internalClassObject" : "(id)object";
+}
+
+void file_write_c_function_profile_scope( FILE* pSourceFileHandle, const char* pFunctionName, const char* pFunctionNameSuffix )
+{
+    //FK: Expands to nothing unless C_OCOA_PROFILE is defined (see c_ocoa_runtime.h)
+    fprintf( pSourceFileHandle, "\tC_OCOA_PROFILE_SCOPE( \"%s%s\" );\n", pFunctionName, pFunctionNameSuffix );
+}
+
+void file_write_c_class_lookup( FILE* pSourceFileHandle, const c_ocoa_objc_class_name* pClassName )
+{
+    //FK: With '--lazy-frameworks' the framework of the class gets loaded on first use
+    if( pClassName->pFrameworkIdentifier != NULL )
+    {
+        fprintf( pSourceFileHandle, "c_ocoa_framework_get_class( &c_ocoa_framework_%s, \"%s\" )", pClassName->pFrameworkIdentifier, pClassName->pName );
+    }
+    else
+    {
+        fprintf( pSourceFileHandle, "objc_getClass( \"%s\" )", pClassName->pName );
+    }
+}
+
+void file_write_c_function_cached_class_lookup( FILE* pSourceFileHandle, const c_ocoa_objc_class_name* pClassName )
+{
+    fprintf( pSourceFileHandle, "\tstatic Class internalClassObject = NULL;\n" );
+    fprintf( pSourceFileHandle, "\tif( internalClassObject == NULL )\n\t{\n" );
+    fprintf( pSourceFileHandle, "\t\tinternalClassObject = " );
+    file_write_c_class_lookup( pSourceFileHandle, pClassName );
+    fprintf( pSourceFileHandle, ";\n" );
+    fprintf( pSourceFileHandle, "\t}\n" );
+}
+
+void file_write_c_function_cached_lookups( FILE* pSourceFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName )
+{
+    //FK: Selectors and classes never go away once registered, so it's safe to look them up only once
+    fprintf( pSourceFileHandle, "\tstatic SEL methodSelector = NULL;\n" );
+    fprintf( pSourceFileHandle, "\tif( methodSelector == NULL )\n\t{\n" );
+    fprintf( pSourceFileHandle, "\t\tmethodSelector = sel_registerName( \"%s\" );\n", pFunctionResolveResult->pOriginalFunctionName );
+    fprintf( pSourceFileHandle, "\t}\n" );
+
+    if( pFunctionResolveResult->methodType == MethodType_Class )
+    {
+        file_write_c_function_cached_class_lookup( pSourceFileHandle, pClassName );
+    }
+}
+
+void file_write_c_function_lookups( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName )
+{
+    //FK: In header-only mode the lookup is done once per translation unit instead of once per call
+    if( pParameter->impCache || pParameter->headerOnly )
+    {
+        file_write_c_function_cached_lookups( pSourceFileHandle, pFunctionResolveResult, pClassName );
+        return;
+    }
+
+    fprintf( pSourceFileHandle, "\tSEL methodSelector = sel_registerName( \"%s\" );\n", pFunctionResolveResult->pOriginalFunctionName );
+
+    if( pFunctionResolveResult->methodType == MethodType_Class )
+    {
+        fprintf( pSourceFileHandle, "\tClass internalClassObject = " );
+        file_write_c_class_lookup( pSourceFileHandle, pClassName );
+        fprintf( pSourceFileHandle, ";\n" );
+    }
+}
+
+void file_write_c_function_direct_runtime_call( FILE* pSourceFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName )
+{
+    if( pFunctionResolveResult->methodType == MethodType_Class )
+    {
+        file_write_c_function_cached_class_lookup( pSourceFileHandle, pClassName );
+    }
+
+    fprintf( pSourceFileHandle, "\t" );
+    if( !pFunctionResolveResult->isVoidFunction )
+    {
+        fprintf( pSourceFileHandle, "return " );
+    }
+
+    const char* pReceiver = pFunctionResolveResult->methodType == MethodType_Class ? "internalClassObject" : "(id)object";
+    fprintf( pSourceFileHandle, "%s( %s );\n", pFunctionResolveResult->pDirectRuntimeFunction, pReceiver );
+}
+
+void file_write_c_function_imp_cache_call( FILE* pSourceFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    const char* pReceiver = objc_find_receiver_expression( pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "\tstatic c_ocoa_imp_cache_t impCache;\n" );
+    fprintf( pSourceFileHandle, "\tIMP cachedImp = c_ocoa_imp_cache_lookup( &impCache, %s, methodSelector );\n", pReceiver );
+    fprintf( pSourceFileHandle, "\tif( cachedImp != NULL )\n\t{\n\t\t" );
+
+    const boolean8_t hasReturnValue = !pFunctionResolveResult->isVoidFunction;
+    if( hasReturnValue )
+    {
+        fprintf( pSourceFileHandle, "return " );
+    }
+
+    //FK: The IMP is a plain C function, so no stret/fpret variant is needed here
+    fprintf( pSourceFileHandle, "(" );
+    file_write_c_function_pointer_type( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "cachedImp)( %s, methodSelector", pReceiver );
+    file_write_c_function_call_arguments( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, " );\n" );
+
+    if( !hasReturnValue )
+    {
+        fprintf( pSourceFileHandle, "\t\treturn;\n" );
+    }
+    fprintf( pSourceFileHandle, "\t}\n" );
+}
+
+boolean8_t cfunction_has_available_variant( const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    //FK: alloc and the direct runtime entry points (retain/release/...) are implemented by every root class
+    return !pFunctionDefinition->isAllocFunction && pFunctionDefinition->pDirectRuntimeFunction == NULL;
+}
+
+void cfunction_write_available_signature( FILE* pResultFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    //FK: Class methods always go to the same class, so there's nothing to pass
+    if( pFunctionDefinition->methodType == MethodType_Class )
+    {
+        fprintf( pResultFileHandle, "%s_available( void )", pFunctionDefinition->pResolvedFunctionName );
+    }
+    else
+    {
+        fprintf( pResultFileHandle, "%s_available( %s_t object )", pFunctionDefinition->pResolvedFunctionName, pFunctionDefinition->pClassName->pNameLower );
+    }
+}
+
+void cfunction_write_available_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    fprintf( pResultFileHandle, "// Returns 1 if the %s responds to '%s', the result gets cached per class.\n", pFunctionDefinition->methodType == MethodType_Class ? "class" : "object", pFunctionDefinition->pOriginalFunctionName );
+    fprintf( pResultFileHandle, "%sint \t\t\t\t", cfunction_get_linkage( pParameter ) );
+    cfunction_write_available_signature( pResultFileHandle, pFunctionDefinition );
+    fprintf( pResultFileHandle, ";\n\n" );
+    fflush( pResultFileHandle );
+}
+
+void file_write_c_function_available_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName )
+{
+    fprintf( pSourceFileHandle, "%sint ", cfunction_get_linkage( pParameter ) );
+    cfunction_write_available_signature( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "\n{\n" );
+
+    //FK: For class methods the class object is the receiver, so its metaclass gets checked.
+    //    A class that doesn't exist at all on this OS version yields 0.
+    file_write_c_function_cached_lookups( pSourceFileHandle, pFunctionResolveResult, pClassName );
+    fprintf( pSourceFileHandle, "\tstatic c_ocoa_availability_cache_t availabilityCache;\n" );
+    fprintf( pSourceFileHandle, "\treturn c_ocoa_availability_cache_lookup( &availabilityCache, %s, methodSelector );\n", objc_find_receiver_expression( pFunctionResolveResult ) );
+    fprintf( pSourceFileHandle, "}\n\n" );
+
+    fflush( pSourceFileHandle );
+}
+
+void file_write_c_function_availability_check( FILE* pSourceFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, boolean8_t writesResultToPointer )
+{
+    //FK: Unavailable methods are skipped and return a zeroed result instead of raising 'unrecognized selector'
+    fprintf( pSourceFileHandle, "#ifdef C_OCOA_CHECKED_CALLS\n" );
+    if( pFunctionResolveResult->methodType == MethodType_Class )
+    {
+        fprintf( pSourceFileHandle, "\tif( !%s_available() )\n\t{\n", pFunctionResolveResult->pResolvedFunctionName );
+    }
+    else
+    {
+        fprintf( pSourceFileHandle, "\tif( !%s_available( object ) )\n\t{\n", pFunctionResolveResult->pResolvedFunctionName );
+    }
+
+    if( pFunctionResolveResult->isVoidFunction )
+    {
+        fprintf( pSourceFileHandle, "\t\treturn;\n" );
+    }
+    else if( writesResultToPointer )
+    {
+        fprintf( pSourceFileHandle, "\t\tconst %s unavailableResult = { 0 };\n", pFunctionResolveResult->pResolvedReturnType );
+        fprintf( pSourceFileHandle, "\t\t*pResult = unavailableResult;\n" );
+        fprintf( pSourceFileHandle, "\t\treturn;\n" );
+    }
+    else
+    {
+        fprintf( pSourceFileHandle, "\t\t%s unavailableResult = { 0 };\n", pFunctionResolveResult->pResolvedReturnType );
+        fprintf( pSourceFileHandle, "\t\treturn unavailableResult;\n" );
+    }
+    fprintf( pSourceFileHandle, "\t}\n" );
+    fprintf( pSourceFileHandle, "#endif\n" );
+}
+
+void file_write_c_function_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName )
+{   
+    fprintf( pSourceFileHandle, "%s", cfunction_get_linkage( pParameter ) );
+
+    size_t returnTypeLength = 0u;
+    if( pFunctionResolveResult->isAllocFunction )
+    {
+        //FK: little syntactic sugar, return correct type for init function(s)
+        returnTypeLength = fprintf( pSourceFileHandle, "%s_t ", pClassName->pNameLower );
+    }
+    else
+    {
+        returnTypeLength = fprintf( pSourceFileHandle, "%s ", pFunctionResolveResult->pResolvedReturnType );
+    }
+
+    cfunction_write_signature( pSourceFileHandle, pFunctionResolveResult );
+
+    fprintf( pSourceFileHandle, "\n{\n" );
+    file_write_c_function_profile_scope( pSourceFileHandle, pFunctionResolveResult->pResolvedFunctionName, "" );
+
+    if( pParameter->availabilityChecks && cfunction_has_available_variant( pFunctionResolveResult ) )
+    {
+        file_write_c_function_availability_check( pSourceFileHandle, pFunctionResolveResult, 0 );
+    }
+
+    //FK: retain/release/autorelease/alloc/new have dedicated (faster) runtime entry points
+    if( pFunctionResolveResult->pDirectRuntimeFunction != NULL )
+    {
+        file_write_c_function_direct_runtime_call( pSourceFileHandle, pFunctionResolveResult, pClassName );
+        fprintf( pSourceFileHandle, "}\n\n");
+
+        fflush( pSourceFileHandle );
+        return;
+    }
+
+    file_write_c_function_lookups( pSourceFileHandle, pParameter, pFunctionResolveResult, pClassName );
+
+    fprintf( pSourceFileHandle, "\t#define %s_call( obj, selector", pFunctionResolveResult->pResolvedFunctionName );
+    file_write_c_function_call_arguments( pSourceFileHandle, pFunctionResolveResult );
+
+    fprintf( pSourceFileHandle, " ) (" );
+    file_write_c_function_pointer_type( pSourceFileHandle, pFunctionResolveResult );
+
+    const char* msgSendCall = objc_find_msgsend_call( pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "%s) ( obj, selector", msgSendCall );
+    file_write_c_function_call_arguments( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, " )\n");
+
+    if( pParameter->impCache )
+    {
+        file_write_c_function_imp_cache_call( pSourceFileHandle, pFunctionResolveResult );
+    }
+
+    fprintf( pSourceFileHandle, "\t" );
+    const boolean8_t hasReturnValue = !pFunctionResolveResult->isVoidFunction;
+    if( hasReturnValue )
+    {
+        fprintf( pSourceFileHandle, "return " );
+    }
+
+    fprintf( pSourceFileHandle, "%s_call( %s, methodSelector", pFunctionResolveResult->pResolvedFunctionName, objc_find_receiver_expression( pFunctionResolveResult ) );
+    file_write_c_function_call_arguments( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, " );\n" );
+    fprintf( pSourceFileHandle, "\t#undef %s_call\n", pFunctionResolveResult->pResolvedFunctionName );
+    fprintf( pSourceFileHandle, "}\n\n");
+    
+    fflush( pSourceFileHandle );
+}
+
+boolean8_t cfunction_has_batch_variant( const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    //FK: Batches only make sense for instance methods, class methods always have the same receiver
+    return pFunctionDefinition->methodType == MethodType_Instance && !pFunctionDefinition->isAllocFunction;
+}
+
+void cfunction_write_batch_signature( FILE* pResultFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    fprintf( pResultFileHandle, "%s_batch( const %s_t* objects, size_t count", pFunctionDefinition->pResolvedFunctionName, pFunctionDefinition->pClassName->pNameLower );
+
+    //FK: One argument per receiver
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionDefinition->argumentCount; ++argumentIndex )
+    {
+        //FK: 'T const*' instead of 'const T*' since T might be a pointer type itself
+        fprintf( pResultFileHandle, ", %s const* arg%u", pFunctionDefinition->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
+    }
+
+    if( !pFunctionDefinition->isVoidFunction )
+    {
+        fprintf( pResultFileHandle, ", %s* results", pFunctionDefinition->pResolvedReturnType );
+    }
+
+    fprintf( pResultFileHandle, " )" );
+}
+
+void cfunction_write_batch_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    fprintf( pResultFileHandle, "// Sends '%s' to 'count' receivers, 'arg*' and 'results' (may be NULL) hold one element per receiver.\n", pFunctionDefinition->pOriginalFunctionName );
+    fprintf( pResultFileHandle, "%svoid \t\t\t\t", cfunction_get_linkage( pParameter ) );
+    cfunction_write_batch_signature( pResultFileHandle, pFunctionDefinition );
+    fprintf( pResultFileHandle, ";\n\n" );
+    fflush( pResultFileHandle );
+}
+
+void file_write_c_function_batch_call_arguments( FILE* pSourceFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+    {
+        fprintf( pSourceFileHandle, ", arg%hhu[ objectIndex ]", argumentIndex );
+    }
+}
+
+void file_write_c_function_batch_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName )
+{
+    fprintf( pSourceFileHandle, "%svoid ", cfunction_get_linkage( pParameter ) );
+    cfunction_write_batch_signature( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "\n{\n" );
+    file_write_c_function_profile_scope( pSourceFileHandle, pFunctionResolveResult->pResolvedFunctionName, "_batch" );
+
+    file_write_c_function_cached_lookups( pSourceFileHandle, pFunctionResolveResult, pClassName );
+
+    //FK: Resolve the IMP only when the receiver class changes, receivers of mixed classes are fine but
+    //    arrays of receivers that share the same class amortize the lookup over the whole batch.
+    fprintf( pSourceFileHandle, "\tClass lastClass = NULL;\n" );
+    fprintf( pSourceFileHandle, "\tIMP lastImp = NULL;\n" );
+    fprintf( pSourceFileHandle, "\tfor( size_t objectIndex = 0u; objectIndex < count; ++objectIndex )\n\t{\n" );
+    fprintf( pSourceFileHandle, "\t\tid object = (id)objects[ objectIndex ];\n" );
+    fprintf( pSourceFileHandle, "\t\tClass objectClass = object == NULL ? NULL : object_getClass( object );\n" );
+    fprintf( pSourceFileHandle, "\t\tif( objectClass != lastClass )\n\t\t{\n" );
+    fprintf( pSourceFileHandle, "\t\t\tlastClass = objectClass;\n" );
+    fprintf( pSourceFileHandle, "\t\t\tlastImp = c_ocoa_resolve_imp( objectClass, methodSelector );\n" );
+    fprintf( pSourceFileHandle, "\t\t}\n\n" );
+
+    const boolean8_t hasReturnValue = !pFunctionResolveResult->isVoidFunction;
+
+    //FK: Direct IMP call
+    fprintf( pSourceFileHandle, "\t\tif( lastImp != NULL )\n\t\t{\n\t\t\t" );
+    if( hasReturnValue )
+    {
+        fprintf( pSourceFileHandle, "%s result = ", pFunctionResolveResult->pResolvedReturnType );
+    }
+    fprintf( pSourceFileHandle, "(" );
+    file_write_c_function_pointer_type( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "lastImp)( object, methodSelector" );
+    file_write_c_function_batch_call_arguments( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, " );\n" );
+    if( hasReturnValue )
+    {
+        fprintf( pSourceFileHandle, "\t\t\tif( results != NULL )\n\t\t\t{\n\t\t\t\tresults[ objectIndex ] = result;\n\t\t\t}\n" );
+    }
+    fprintf( pSourceFileHandle, "\t\t}\n" );
+
+    //FK: nil receivers and forwarded messages go through the regular wrapper
+    fprintf( pSourceFileHandle, "\t\telse\n\t\t{\n\t\t\t" );
+    if( hasReturnValue )
+    {
+        fprintf( pSourceFileHandle, "%s result = ", pFunctionResolveResult->pResolvedReturnType );
+    }
+    fprintf( pSourceFileHandle, "%s( objects[ objectIndex ]", pFunctionResolveResult->pResolvedFunctionName );
+    file_write_c_function_batch_call_arguments( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, " );\n" );
+    if( hasReturnValue )
+    {
+        fprintf( pSourceFileHandle, "\t\t\tif( results != NULL )\n\t\t\t{\n\t\t\t\tresults[ objectIndex ] = result;\n\t\t\t}\n" );
+    }
+    fprintf( pSourceFileHandle, "\t\t}\n" );
+
+    fprintf( pSourceFileHandle, "\t}\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+
+    fflush( pSourceFileHandle );
+}
+
+boolean8_t cpp_name_is_reserved( const char* pName, const c_ocoa_objc_class_name* pClassName )
+{
+    //FK: C++ keywords that are also valid Objective-C selector names + names used by the generated classes
+    static const char* pReservedNames[] = {
+        "alignas", "alignof", "and", "and_eq", "asm", "bitand", "bitor", "bool", "catch", "char16_t", "char32_t",
+        "class", "compl", "const_cast", "constexpr", "decltype", "delete", "dynamic_cast", "explicit", "export",
+        "false", "friend", "inline", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr",
+        "operator", "or", "or_eq", "private", "protected", "public", "reinterpret_cast", "static_assert",
+        "static_cast", "template", "this", "thread_local", "throw", "true", "try", "typeid", "typename",
+        "using", "virtual", "wchar_t", "xor", "xor_eq", "object", "send", "class_object", "pObject"
+    };
+
+    for( size_t nameIndex = 0u; nameIndex < array_count( pReservedNames ); ++nameIndex )
+    {
+        if( strcmp( pName, pReservedNames[ nameIndex ] ) == 0 )
+        {
+            return 1u;
+        }
+    }
+
+    //FK: A member with the name of the class would be a constructor
+    return strcmp( pName, pClassName->pNameLower ) == 0;
+}
+
+void file_write_cpp_header_prefix( FILE* pCppHeaderFileHandle, const c_ocoa_objc_class_name* pClassName )
+{
+    file_write_generated_comment( pCppHeaderFileHandle );
+
+    fprintf( pCppHeaderFileHandle, "#ifndef SHIMMER_C_OCOA_%s_HPP\n#define SHIMMER_C_OCOA_%s_HPP\n\n", pClassName->pNameUpper, pClassName->pNameUpper );
+    fprintf( pCppHeaderFileHandle, "#include \"c_ocoa_runtime.hpp\"\n" );
+    if( pClassName->pFrameworkIdentifier != NULL )
+    {
+        fprintf( pCppHeaderFileHandle, "#include \"c_ocoa_frameworks.h\"\n" );
+    }
+    fprintf( pCppHeaderFileHandle, "\n" );
+    fprintf( pCppHeaderFileHandle, "namespace c_ocoa\n{\n" );
+    fprintf( pCppHeaderFileHandle, "\tstruct %s : object\n\t{\n", pClassName->pNameLower );
+    fprintf( pCppHeaderFileHandle, "\t\tusing object::object;\n\n" );
+
+    //FK: With '--lazy-frameworks' the class can't be looked up during static initialization
+    //    since that would load the framework at startup, look it up on first use instead
+    if( pClassName->pFrameworkIdentifier != NULL )
+    {
+        fprintf( pCppHeaderFileHandle, "\t\tstatic Class class_object()\n\t\t{\n" );
+        fprintf( pCppHeaderFileHandle, "\t\t\tstatic const Class internalClassObject = (Class)" );
+        file_write_c_class_lookup( pCppHeaderFileHandle, pClassName );
+        fprintf( pCppHeaderFileHandle, ";\n\t\t\treturn internalClassObject;\n\t\t}\n\n" );
+        return;
+    }
+
+    fprintf( pCppHeaderFileHandle, "\t\tstatic inline const Class class_object = (Class)objc_getClass( \"%s\" );\n\n", pClassName->pName );
+}
+
+void file_write_cpp_header_suffix( FILE* pCppHeaderFileHandle )
+{
+    fprintf( pCppHeaderFileHandle, "\t};\n}\n\n#endif" );
+}
+
+void file_write_cpp_member_function( FILE* pCppHeaderFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName )
+{
+    //FK: The C function name is '<class>_<selector>', the member only needs the selector part
+    const char* pMemberName = pFunctionResolveResult->pResolvedFunctionName + string_get_length_excl_null_terminator( pClassName->pNameLower ) + 1;
+    const char* pMemberNameSuffix = cpp_name_is_reserved( pMemberName, pClassName ) ? "_" : "";
+    const boolean8_t isClassMethod = pFunctionResolveResult->methodType == MethodType_Class;
+
+    //FK: alloc and init* return instancetype, so return the typed handle for these
+    const boolean8_t returnsInstance = pFunctionResolveResult->isAllocFunction || 
+        ( strncmp( pFunctionResolveResult->pOriginalFunctionName, "init", 4 ) == 0 && strcmp( pFunctionResolveResult->pResolvedReturnType, "nsobject_t" ) == 0 );
+
+    fprintf( pCppHeaderFileHandle, "\t\t// Signature from Objective-C Runtime: %s %s %s\n", pFunctionResolveResult->pOriginalReturnType, pFunctionResolveResult->pOriginalFunctionName, pFunctionResolveResult->pOriginalArgumentTypes );
+    if( pFunctionResolveResult->pDirectRuntimeFunction == NULL )
+    {
+        fprintf( pCppHeaderFileHandle, "\t\tstatic inline const SEL sel_%s%s = sel_registerName( \"%s\" );\n", pMemberName, pMemberNameSuffix, pFunctionResolveResult->pOriginalFunctionName );
+    }
+
+    fprintf( pCppHeaderFileHandle, "\t\t%s%s %s%s(", isClassMethod ? "static " : "", returnsInstance ? pClassName->pNameLower : pFunctionResolveResult->pResolvedReturnType, pMemberName, pMemberNameSuffix );
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+    {
+        fprintf( pCppHeaderFileHandle, "%s %s arg%hhu", argumentIndex == 0u ? "" : ",", pFunctionResolveResult->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
+    }
+    fprintf( pCppHeaderFileHandle, " )%s\n\t\t{\n", isClassMethod ? "" : " const" );
+    fprintf( pCppHeaderFileHandle, "\t\t\tC_OCOA_PROFILE_SCOPE( \"%s::%s\" );\n", pClassName->pNameLower, pMemberName );
+    fprintf( pCppHeaderFileHandle, "\t\t\treturn " );
+
+    if( returnsInstance )
+    {
+        fprintf( pCppHeaderFileHandle, "%s( ", pClassName->pNameLower );
+    }
+
+    const char* pClassObject = pClassName->pFrameworkIdentifier != NULL ? "class_object()" : "class_object";
+    if( pFunctionResolveResult->pDirectRuntimeFunction != NULL )
+    {
+        fprintf( pCppHeaderFileHandle, "%s( %s )", pFunctionResolveResult->pDirectRuntimeFunction, isClassMethod ? pClassObject : "pObject" );
+    }
+    else
+    {
+        fprintf( pCppHeaderFileHandle, "send<%s>( %s%s, sel_%s%s", returnsInstance ? "id" : pFunctionResolveResult->pResolvedReturnType, isClassMethod ? "(id)" : "", isClassMethod ? pClassObject : "pObject", pMemberName, pMemberNameSuffix );
+        file_write_c_function_call_arguments( pCppHeaderFileHandle, pFunctionResolveResult );
+        fprintf( pCppHeaderFileHandle, " )" );
+    }
+
+    if( returnsInstance )
+    {
+        fprintf( pCppHeaderFileHandle, " )" );
+    }
+    fprintf( pCppHeaderFileHandle, ";\n\t\t}\n\n" );
+}
+
+void cfunction_write_super_signature( FILE* pResultFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    //FK: '<class>_<method>' -> '<class>_super_<method>'
+    const char* pClassNameLower = pFunctionDefinition->pClassName->pNameLower;
+    const char* pMethodName = pFunctionDefinition->pResolvedFunctionName + string_get_length_excl_null_terminator( pClassNameLower ) + 1;
+    fprintf( pResultFileHandle, "%s_super_%s( nsclass_t cls, %s_t object", pClassNameLower, pMethodName, pClassNameLower );
+
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionDefinition->argumentCount; ++argumentIndex )
+    {
+        fprintf( pResultFileHandle, ", %s arg%u", pFunctionDefinition->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
+    }
+
+    fprintf( pResultFileHandle, " )" );
+}
+
+void cfunction_write_super_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    fprintf( pResultFileHandle, "// Calls the superclass implementation of '%s', 'cls' is the class that implements the calling override.\n", pFunctionDefinition->pOriginalFunctionName );
+    fprintf( pResultFileHandle, "%s%s \t\t\t\t", cfunction_get_linkage( pParameter ), pFunctionDefinition->pResolvedReturnType );
+    cfunction_write_super_signature( pResultFileHandle, pFunctionDefinition );
+    fprintf( pResultFileHandle, ";\n\n" );
+    fflush( pResultFileHandle );
+}
+
+static inline boolean8_t cfunction_is_block_argument( const c_ocoa_objc_function_resolve_result* pFunctionDefinition, uint8_t argumentIndex )
+{
+    return strcmp( pFunctionDefinition->pResolvedArgumentTypes[ argumentIndex ], "nsblock_t" ) == 0;
+}
+
+//FK: Returns the extended block signature of a block argument (eg: 'v@?@Q^B' of '@?<v@?@Q^B>'), NULL if the runtime didn't report it
+const char* cfunction_find_block_signature( const c_ocoa_objc_function_resolve_result* pFunctionDefinition, uint8_t argumentIndex, int32_t* pOutSignatureLength )
+{
+    //FK: The original argument types start with object + selector
+    const char* pArgument = pFunctionDefinition->pOriginalArgumentTypes;
+    for( uint8_t typeIndex = 0u; typeIndex < argumentIndex + 2u; ++typeIndex )
+    {
+        const char* pArgumentEnd = whitespace_find_next( pArgument );
+        if( *pArgumentEnd == 0 )
+        {
+            return NULL;
+        }
+
+        pArgument = pArgumentEnd + 1;
+    }
+
+    while( objc_is_method_type_qualifier( *pArgument ) || *pArgument == 'r' )
+    {
+        ++pArgument;
+    }
+
+    if( pArgument[0] != '@' || pArgument[1] != '?' || pArgument[2] != '<' )
+    {
+        return NULL;
+    }
+
+    //FK: Block signatures may contain block arguments with signatures themselves (eg: '@?<v@?@?<v@?>>')
+    const char* pSignature = pArgument + 3;
+    const char* pSignatureEnd = pSignature;
+    uint32_t depth = 1u;
+    while( *pSignatureEnd != 0 )
+    {
+        if( *pSignatureEnd == '<' )
+        {
+            ++depth;
+        }
+        else if( *pSignatureEnd == '>' && --depth == 0u )
+        {
+            break;
+        }
+
+        ++pSignatureEnd;
+    }
+
+    if( depth != 0u || pSignatureEnd == pSignature )
+    {
+        return NULL;
+    }
+
+    *pOutSignatureLength = cast_size_to_int32( pSignatureEnd - pSignature );
+    return pSignature;
+}
+
+boolean8_t cfunction_has_callback_variant( const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionDefinition->argumentCount; ++argumentIndex )
+    {
+        if( cfunction_is_block_argument( pFunctionDefinition, argumentIndex ) )
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static inline boolean8_t cfunction_takes_object( const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    //FK: Same rule as in cfunction_write_signature()
+    return pFunctionDefinition->methodType == MethodType_Instance && !pFunctionDefinition->isAllocFunction;
+}
+
+void cfunction_write_callback_signature( FILE* pResultFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    //FK: Every block argument 'argN' gets replaced by 'pInvokeN' + 'pContextN'
+    fprintf( pResultFileHandle, "%s_callback(", pFunctionDefinition->pResolvedFunctionName );
+
+    const char* pSeparator = " ";
+    if( cfunction_takes_object( pFunctionDefinition ) )
+    {
+        fprintf( pResultFileHandle, " %s_t object", pFunctionDefinition->pClassName->pNameLower );
+        pSeparator = ", ";
+    }
+
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionDefinition->argumentCount; ++argumentIndex )
+    {
+        if( cfunction_is_block_argument( pFunctionDefinition, argumentIndex ) )
+        {
+            fprintf( pResultFileHandle, "%sc_ocoa_block_invoke_fn pInvoke%u, void* pContext%u", pSeparator, argumentIndex, argumentIndex );
+        }
+        else
+        {
+            fprintf( pResultFileHandle, "%s%s arg%u", pSeparator, pFunctionDefinition->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
+        }
+        pSeparator = ", ";
+    }
+
+    fprintf( pResultFileHandle, " )" );
+}
+
+void cfunction_write_callback_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    fprintf( pResultFileHandle, "// Same as '%s' but takes C callbacks + context instead of blocks, the blocks are built on the stack (see c_ocoa_block_t).\n", pFunctionDefinition->pResolvedFunctionName );
+    fprintf( pResultFileHandle, "%s%s \t\t\t\t", cfunction_get_linkage( pParameter ), pFunctionDefinition->pResolvedReturnType );
+    cfunction_write_callback_signature( pResultFileHandle, pFunctionDefinition );
+    fprintf( pResultFileHandle, ";\n\n" );
+    fflush( pResultFileHandle );
+}
+
+void file_write_c_function_callback_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    fprintf( pSourceFileHandle, "%s%s ", cfunction_get_linkage( pParameter ), pFunctionResolveResult->pResolvedReturnType );
+    cfunction_write_callback_signature( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "\n{\n" );
+
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+    {
+        if( cfunction_is_block_argument( pFunctionResolveResult, argumentIndex ) )
+        {
+            fprintf( pSourceFileHandle, "\tc_ocoa_block_t block%u;\n", argumentIndex );
+
+            int32_t signatureLength = 0;
+            const char* pSignature = cfunction_find_block_signature( pFunctionResolveResult, argumentIndex, &signatureLength );
+            if( pSignature == NULL )
+            {
+                fprintf( pSourceFileHandle, "\tc_ocoa_block_init( &block%u, pInvoke%u, pContext%u );\n", argumentIndex, argumentIndex, argumentIndex );
+                continue;
+            }
+
+            //FK: Class names are dropped from the signature, so that it can be written as string literal
+            fprintf( pSourceFileHandle, "\tstatic const c_ocoa_block_descriptor_t blockDescriptor%u = { 0u, sizeof( c_ocoa_block_t ), \"", argumentIndex );
+            file_write_objc_type_encoding_without_names( pSourceFileHandle, pSignature, signatureLength );
+            fprintf( pSourceFileHandle, "\" };\n" );
+            fprintf( pSourceFileHandle, "\tc_ocoa_block_init_with_descriptor( &block%u, pInvoke%u, pContext%u, &blockDescriptor%u );\n", argumentIndex, argumentIndex, argumentIndex, argumentIndex );
+        }
+    }
+
+    fprintf( pSourceFileHandle, "\t%s%s(", pFunctionResolveResult->isVoidFunction ? "" : "return ", pFunctionResolveResult->pResolvedFunctionName );
+
+    const char* pSeparator = " ";
+    if( cfunction_takes_object( pFunctionResolveResult ) )
+    {
+        fprintf( pSourceFileHandle, " object" );
+        pSeparator = ", ";
+    }
+
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+    {
+        if( cfunction_is_block_argument( pFunctionResolveResult, argumentIndex ) )
+        {
+            fprintf( pSourceFileHandle, "%s(nsblock_t)&block%u", pSeparator, argumentIndex );
+        }
+        else
+        {
+            fprintf( pSourceFileHandle, "%sarg%u", pSeparator, argumentIndex );
+        }
+        pSeparator = ", ";
+    }
+
+    fprintf( pSourceFileHandle, " );\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+}
+
+boolean8_t cfunction_has_on_main_variant( const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    //FK: The call is executed later on, so there's no result to return. Blocks are skipped since they
+    //    might live on the stack of the calling thread
+    return pFunctionDefinition->isVoidFunction && !pFunctionDefinition->isAllocFunction && !cfunction_has_callback_variant( pFunctionDefinition );
+}
+
+static inline boolean8_t cfunction_has_on_main_arguments( const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    return cfunction_takes_object( pFunctionDefinition ) || pFunctionDefinition->argumentCount > 0u;
+}
+
+void cfunction_write_on_main_signature( FILE* pResultFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    fprintf( pResultFileHandle, "%s_on_main(", pFunctionDefinition->pResolvedFunctionName );
+
+    const char* pSeparator = " ";
+    if( cfunction_takes_object( pFunctionDefinition ) )
+    {
+        fprintf( pResultFileHandle, " %s_t object", pFunctionDefinition->pClassName->pNameLower );
+        pSeparator = ", ";
+    }
+
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionDefinition->argumentCount; ++argumentIndex )
+    {
+        fprintf( pResultFileHandle, "%s%s arg%u", pSeparator, pFunctionDefinition->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
+        pSeparator = ", ";
+    }
+
+    fprintf( pResultFileHandle, pFunctionDefinition->argumentCount > 0u || cfunction_takes_object( pFunctionDefinition ) ? " )" : " void )" );
+}
+
+void cfunction_write_on_main_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    fprintf( pResultFileHandle, "// Enqueues '%s' for the main thread and returns immediately, the call is sent by c_ocoa_main_queue_drain().\n", pFunctionDefinition->pOriginalFunctionName );
+    fprintf( pResultFileHandle, "%svoid \t\t\t\t", cfunction_get_linkage( pParameter ) );
+    cfunction_write_on_main_signature( pResultFileHandle, pFunctionDefinition );
+    fprintf( pResultFileHandle, ";\n\n" );
+    fflush( pResultFileHandle );
+}
+
+void file_write_c_function_on_main_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    const char* pFunctionName = pFunctionResolveResult->pResolvedFunctionName;
+    const boolean8_t hasArguments = cfunction_has_on_main_arguments( pFunctionResolveResult );
+
+    //FK: The arguments get copied into the queue as one packed struct
+    if( hasArguments )
+    {
+        fprintf( pSourceFileHandle, "typedef struct\n{\n" );
+        if( cfunction_takes_object( pFunctionResolveResult ) )
+        {
+            fprintf( pSourceFileHandle, "\t%s_t object;\n", pFunctionResolveResult->pClassName->pNameLower );
+        }
+
+        for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+        {
+            fprintf( pSourceFileHandle, "\t%s arg%u;\n", pFunctionResolveResult->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
+        }
+        fprintf( pSourceFileHandle, "} %s_on_main_arguments_t;\n\n", pFunctionName );
+    }
+
+    fprintf( pSourceFileHandle, "static void %s_on_main_call( void* pArguments )\n{\n", pFunctionName );
+    if( hasArguments )
+    {
+        fprintf( pSourceFileHandle, "\tconst %s_on_main_arguments_t* pCallArguments = (const %s_on_main_arguments_t*)pArguments;\n", pFunctionName, pFunctionName );
+    }
+    else
+    {
+        fprintf( pSourceFileHandle, "\t(void)pArguments;\n" );
+    }
+
+    fprintf( pSourceFileHandle, "\t%s(", pFunctionName );
+    const char* pSeparator = " ";
+    if( cfunction_takes_object( pFunctionResolveResult ) )
+    {
+        fprintf( pSourceFileHandle, " pCallArguments->object" );
+        pSeparator = ", ";
+    }
+
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+    {
+        fprintf( pSourceFileHandle, "%spCallArguments->arg%u", pSeparator, argumentIndex );
+        pSeparator = ", ";
+    }
+    fprintf( pSourceFileHandle, hasArguments ? " );\n}\n\n" : ");\n}\n\n" );
+
+    fprintf( pSourceFileHandle, "%svoid ", cfunction_get_linkage( pParameter ) );
+    cfunction_write_on_main_signature( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "\n{\n" );
+    if( hasArguments )
+    {
+        fprintf( pSourceFileHandle, "\tconst %s_on_main_arguments_t arguments = {", pFunctionName );
+        pSeparator = " ";
+        if( cfunction_takes_object( pFunctionResolveResult ) )
+        {
+            fprintf( pSourceFileHandle, " object" );
+            pSeparator = ", ";
+        }
+
+        for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+        {
+            fprintf( pSourceFileHandle, "%sarg%u", pSeparator, argumentIndex );
+            pSeparator = ", ";
+        }
+        fprintf( pSourceFileHandle, " };\n" );
+        fprintf( pSourceFileHandle, "\tc_ocoa_main_queue_push_wait( %s_on_main_call, &arguments, sizeof( arguments ) );\n", pFunctionName );
+    }
+    else
+    {
+        fprintf( pSourceFileHandle, "\tc_ocoa_main_queue_push_wait( %s_on_main_call, NULL, 0u );\n", pFunctionName );
+    }
+    fprintf( pSourceFileHandle, "}\n\n" );
+}
+
+boolean8_t cfunction_has_by_pointer_variant( const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    if( pFunctionDefinition->isAllocFunction || pFunctionDefinition->pDirectRuntimeFunction != NULL )
+    {
+        return 0;
+    }
+
+    return pFunctionDefinition->hasLargeStructReturnValue || pFunctionDefinition->largeStructArgumentMask != 0u;
+}
+
+static inline boolean8_t cfunction_is_large_struct_argument( const c_ocoa_objc_function_resolve_result* pFunctionDefinition, uint8_t argumentIndex )
+{
+    return ( pFunctionDefinition->largeStructArgumentMask & ( 1u << argumentIndex ) ) != 0u;
+}
+
+const char* cfunction_get_by_pointer_suffix( const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    //FK: '_into' writes the result to caller storage, '_ref' only takes the struct arguments by pointer
+    return pFunctionDefinition->hasLargeStructReturnValue ? "_into" : "_ref";
+}
+
+void cfunction_write_by_pointer_signature( FILE* pResultFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    fprintf( pResultFileHandle, "%s%s(", pFunctionDefinition->pResolvedFunctionName, cfunction_get_by_pointer_suffix( pFunctionDefinition ) );
+
+    const char* pSeparator = " ";
+    if( cfunction_takes_object( pFunctionDefinition ) )
+    {
+        fprintf( pResultFileHandle, " %s_t object", pFunctionDefinition->pClassName->pNameLower );
+        pSeparator = ", ";
+    }
+
+    if( pFunctionDefinition->hasLargeStructReturnValue )
+    {
+        fprintf( pResultFileHandle, "%s%s* pResult", pSeparator, pFunctionDefinition->pResolvedReturnType );
+        pSeparator = ", ";
+    }
+
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionDefinition->argumentCount; ++argumentIndex )
+    {
+        const char* pArgumentType = pFunctionDefinition->pResolvedArgumentTypes[ argumentIndex ];
+        if( cfunction_is_large_struct_argument( pFunctionDefinition, argumentIndex ) )
+        {
+            fprintf( pResultFileHandle, "%sconst %s* arg%u", pSeparator, pArgumentType, argumentIndex );
+        }
+        else
+        {
+            fprintf( pResultFileHandle, "%s%s arg%u", pSeparator, pArgumentType, argumentIndex );
+        }
+        pSeparator = ", ";
+    }
+
+    fprintf( pResultFileHandle, pSeparator[0] == ',' ? " )" : " void )" );
+}
+
+void cfunction_write_by_pointer_declaration( FILE* pResultFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+{
+    if( pFunctionDefinition->hasLargeStructReturnValue )
+    {
+        fprintf( pResultFileHandle, "// Same as %s() but writes the result directly to 'pResult', structs that don't fit into registers are passed by pointer.\n", pFunctionDefinition->pResolvedFunctionName );
+        fprintf( pResultFileHandle, "%svoid \t\t\t\t", cfunction_get_linkage( pParameter ) );
+    }
+    else
+    {
+        fprintf( pResultFileHandle, "// Same as %s() but structs that don't fit into registers are passed by pointer.\n", pFunctionDefinition->pResolvedFunctionName );
+        fprintf( pResultFileHandle, "%s%s \t\t\t\t", cfunction_get_linkage( pParameter ), pFunctionDefinition->pResolvedReturnType );
+    }
+
+    cfunction_write_by_pointer_signature( pResultFileHandle, pFunctionDefinition );
+    fprintf( pResultFileHandle, ";\n\n" );
+    fflush( pResultFileHandle );
+}
+
+void file_write_c_function_by_pointer_call_arguments( FILE* pSourceFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+    {
+        fprintf( pSourceFileHandle, cfunction_is_large_struct_argument( pFunctionResolveResult, argumentIndex ) ? ", *arg%hhu" : ", arg%hhu", argumentIndex );
+    }
+}
+
+void file_write_c_function_by_pointer_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName )
+{
+    const boolean8_t writesResultToPointer = pFunctionResolveResult->hasLargeStructReturnValue;
+    const char* pReceiver = objc_find_receiver_expression( pFunctionResolveResult );
+
+    fprintf( pSourceFileHandle, "%s%s ", cfunction_get_linkage( pParameter ), writesResultToPointer ? "void" : pFunctionResolveResult->pResolvedReturnType );
+    cfunction_write_by_pointer_signature( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "\n{\n" );
+    file_write_c_function_profile_scope( pSourceFileHandle, pFunctionResolveResult->pResolvedFunctionName, cfunction_get_by_pointer_suffix( pFunctionResolveResult ) );
+
+    if( pParameter->availabilityChecks && cfunction_has_available_variant( pFunctionResolveResult ) )
+    {
+        file_write_c_function_availability_check( pSourceFileHandle, pFunctionResolveResult, writesResultToPointer );
+    }
+
+    file_write_c_function_lookups( pSourceFileHandle, pParameter, pFunctionResolveResult, pClassName );
+
+    const char* pMsgSendCall = objc_find_msgsend_call( pFunctionResolveResult );
+    if( pParameter->impCache )
+    {
+        fprintf( pSourceFileHandle, "\tstatic c_ocoa_imp_cache_t impCache;\n" );
+        fprintf( pSourceFileHandle, "\tIMP pImp = c_ocoa_imp_cache_lookup( &impCache, %s, methodSelector );\n", pReceiver );
+        fprintf( pSourceFileHandle, "\tif( pImp == NULL )\n\t{\n" );
+        fprintf( pSourceFileHandle, "\t\tpImp = (IMP)%s;\n", pMsgSendCall );
+        fprintf( pSourceFileHandle, "\t}\n" );
+    }
+    else
+    {
+        fprintf( pSourceFileHandle, "\tIMP pImp = (IMP)%s;\n", pMsgSendCall );
+    }
+
+    if( writesResultToPointer )
+    {
+        //FK: Where the ABI allows it the callee writes the result straight into 'pResult',
+        //    otherwise the compiler may go through a temporary
+        fprintf( pSourceFileHandle, "#ifdef abi_stret_address_is_first_argument\n" );
+        fprintf( pSourceFileHandle, "\t((void (*)( %s*, id, SEL", pFunctionResolveResult->pResolvedReturnType );
+        for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+        {
+            fprintf( pSourceFileHandle, ", %s", pFunctionResolveResult->pResolvedArgumentTypes[ argumentIndex ] );
+        }
+        fprintf( pSourceFileHandle, " ))pImp)( pResult, %s, methodSelector", pReceiver );
+        file_write_c_function_by_pointer_call_arguments( pSourceFileHandle, pFunctionResolveResult );
+        fprintf( pSourceFileHandle, " );\n" );
+        fprintf( pSourceFileHandle, "#else\n" );
+        fprintf( pSourceFileHandle, "\t*pResult = " );
+    }
+    else
+    {
+        fprintf( pSourceFileHandle, pFunctionResolveResult->isVoidFunction ? "\t" : "\treturn " );
+    }
+
+    fprintf( pSourceFileHandle, "(" );
+    file_write_c_function_pointer_type( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "pImp)( %s, methodSelector", pReceiver );
+    file_write_c_function_by_pointer_call_arguments( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, " );\n" );
+
+    if( writesResultToPointer )
+    {
+        fprintf( pSourceFileHandle, "#endif\n" );
+    }
+    fprintf( pSourceFileHandle, "}\n\n" );
+
+    fflush( pSourceFileHandle );
+}
+
+const char* objc_find_msgsend_super_call( const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    //FK: There's no objc_msgSendSuper_fpret, only struct returns need a different entry point
+    if( pFunctionResolveResult->hasLargeStructReturnValue )
+    {
+        return "abi_objc_msgSendSuper_stret";
+    }
+
+    return "objc_msgSendSuper";
+}
+
+void file_write_c_function_super_implementation( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName )
+{
+    fprintf( pSourceFileHandle, "%s%s ", cfunction_get_linkage( pParameter ), pFunctionResolveResult->pResolvedReturnType );
+    cfunction_write_super_signature( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "\n{\n" );
+
+    char superFunctionPrefix[ 256 ];
+    snprintf( superFunctionPrefix, sizeof( superFunctionPrefix ), "%s_super_", pClassName->pNameLower );
+    file_write_c_function_profile_scope( pSourceFileHandle, superFunctionPrefix, pFunctionResolveResult->pResolvedFunctionName + string_get_length_excl_null_terminator( pClassName->pNameLower ) + 1 );
+
+    fprintf( pSourceFileHandle, "\tstatic SEL methodSelector = NULL;\n" );
+    fprintf( pSourceFileHandle, "\tif( methodSelector == NULL )\n\t{\n" );
+    fprintf( pSourceFileHandle, "\t\tmethodSelector = sel_registerName( \"%s\" );\n", pFunctionResolveResult->pOriginalFunctionName );
+    fprintf( pSourceFileHandle, "\t}\n\n" );
+
+    //FK: Keyed by 'cls' and not by the class of the receiver, otherwise overrides in subclasses
+    //    of 'cls' would end up calling themselves. Holds a few entries since every override in a
+    //    class hierarchy calls this wrapper with its own 'cls'
+    fprintf( pSourceFileHandle, "\tstatic c_ocoa_super_imp_cache_t superImpCache;\n" );
+    fprintf( pSourceFileHandle, "\tIMP superImp = c_ocoa_super_imp_cache_lookup( &superImpCache, (Class)cls, methodSelector );\n" );
+    fprintf( pSourceFileHandle, "\tif( superImp != NULL )\n\t{\n\t\t" );
+
+    const boolean8_t hasReturnValue = !pFunctionResolveResult->isVoidFunction;
+    if( hasReturnValue )
+    {
+        fprintf( pSourceFileHandle, "return " );
+    }
+
+    fprintf( pSourceFileHandle, "(" );
+    file_write_c_function_pointer_type( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, "superImp)( (id)object, methodSelector" );
+    file_write_c_function_call_arguments( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, " );\n" );
+    if( !hasReturnValue )
+    {
+        fprintf( pSourceFileHandle, "\t\treturn;\n" );
+    }
+    fprintf( pSourceFileHandle, "\t}\n\n" );
+
+    //FK: Superclass doesn't implement the method itself (eg: forwarded messages), let the runtime handle it
+    fprintf( pSourceFileHandle, "\tstruct objc_super superReceiver = { (id)object, class_getSuperclass( (Class)cls ) };\n" );
+    fprintf( pSourceFileHandle, "\t" );
+    if( hasReturnValue )
+    {
+        fprintf( pSourceFileHandle, "return " );
+    }
+
+    fprintf( pSourceFileHandle, "((%s (*)( struct objc_super*, SEL", pFunctionResolveResult->pResolvedReturnType );
+    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+    {
+        fprintf( pSourceFileHandle, ", %s", pFunctionResolveResult->pResolvedArgumentTypes[ argumentIndex ] );
+    }
+    fprintf( pSourceFileHandle, " ))%s)( &superReceiver, methodSelector", objc_find_msgsend_super_call( pFunctionResolveResult ) );
+    file_write_c_function_call_arguments( pSourceFileHandle, pFunctionResolveResult );
+    fprintf( pSourceFileHandle, " );\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+
+    fflush( pSourceFileHandle );
+}
+
+c_ocoa_class_family objc_find_class_family( Class pClass )
+{
+    //FK: Also catches the mutable variants and the private class clusters (eg: __NSArrayI)
+    while( pClass != NULL )
+    {
+        const char* pClassName = class_getName( pClass );
+        if( strcmp( pClassName, "NSArray" ) == 0 )
+        {
+            return ClassFamily_Array;
+        }
+        else if( strcmp( pClassName, "NSSet" ) == 0 )
+        {
+            return ClassFamily_Set;
+        }
+        else if( strcmp( pClassName, "NSDictionary" ) == 0 )
+        {
+            return ClassFamily_Dictionary;
+        }
+        else if( strcmp( pClassName, "NSString" ) == 0 )
+        {
+            return ClassFamily_String;
+        }
+        else if( strcmp( pClassName, "NSMutableData" ) == 0 )
+        {
+            return ClassFamily_MutableData;
+        }
+        else if( strcmp( pClassName, "NSData" ) == 0 )
+        {
+            return ClassFamily_Data;
+        }
+
+        pClass = class_getSuperclass( pClass );
+    }
+
+    return ClassFamily_None;
+}
+
+void file_write_c_collection_helper_declarations( FILE* pHeaderFileHandle, const c_ocoa_code_generator_parameter* pParameter, c_ocoa_class_family classFamily, const c_ocoa_objc_class_name* pClassName )
+{
+    const char* pLinkage = cfunction_get_linkage( pParameter );
+    const char* pClassNameLower = pClassName->pNameLower;
+    fprintf( pHeaderFileHandle, "// Collection helpers, iterate using 'c_ocoa_collection_iterator_next( &iterator, &object )'\n" );
+    switch( classFamily )
+    {
+        case ClassFamily_Array:
+        case ClassFamily_Set:
+            fprintf( pHeaderFileHandle, "%svoid \t\t\t\t%s_iterator_begin( c_ocoa_collection_iterator_t* pIterator, %s_t object );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+            break;
+
+        case ClassFamily_Dictionary:
+            fprintf( pHeaderFileHandle, "%svoid \t\t\t\t%s_key_iterator_begin( c_ocoa_collection_iterator_t* pIterator, %s_t object );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+            break;
+
+        default:
+            code_path_invalid();
+    }
+
+    if( classFamily == ClassFamily_Array )
+    {
+        fprintf( pHeaderFileHandle, "// Copies 'length' objects starting at 'location' into 'pOutObjects' using a single message send\n" );
+        fprintf( pHeaderFileHandle, "%svoid \t\t\t\t%s_get_objects( %s_t object, size_t location, size_t length, nsobject_t* pOutObjects );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+    }
+    else if( classFamily == ClassFamily_Dictionary )
+    {
+        fprintf( pHeaderFileHandle, "// Copies up to 'count' objects and their keys using a single message send, 'pOutObjects' or 'pOutKeys' may be NULL\n" );
+        fprintf( pHeaderFileHandle, "%svoid \t\t\t\t%s_get_objects_and_keys( %s_t object, nsobject_t* pOutObjects, nsobject_t* pOutKeys, size_t count );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+    }
+}
+
+void file_write_c_collection_helper_implementations( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, c_ocoa_class_family classFamily, const c_ocoa_objc_class_name* pClassName )
+{
+    const char* pLinkage = cfunction_get_linkage( pParameter );
+    const char* pClassNameLower = pClassName->pNameLower;
+    const char* pIteratorFunctionName = classFamily == ClassFamily_Dictionary ? "key_iterator_begin" : "iterator_begin";
+    fprintf( pSourceFileHandle, "%svoid %s_%s( c_ocoa_collection_iterator_t* pIterator, %s_t object )\n", pLinkage, pClassNameLower, pIteratorFunctionName, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    fprintf( pSourceFileHandle, "\tc_ocoa_collection_iterator_begin( pIterator, (id)object );\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+
+    if( classFamily == ClassFamily_Array )
+    {
+        fprintf( pSourceFileHandle, "%svoid %s_get_objects( %s_t object, size_t location, size_t length, nsobject_t* pOutObjects )\n", pLinkage, pClassNameLower, pClassNameLower );
+        fprintf( pSourceFileHandle, "{\n" );
+        fprintf( pSourceFileHandle, "\tc_ocoa_array_get_objects( (id)object, location, length, pOutObjects );\n" );
+        fprintf( pSourceFileHandle, "}\n\n" );
+    }
+    else if( classFamily == ClassFamily_Dictionary )
+    {
+        fprintf( pSourceFileHandle, "%svoid %s_get_objects_and_keys( %s_t object, nsobject_t* pOutObjects, nsobject_t* pOutKeys, size_t count )\n", pLinkage, pClassNameLower, pClassNameLower );
+        fprintf( pSourceFileHandle, "{\n" );
+        fprintf( pSourceFileHandle, "\tc_ocoa_dictionary_get_objects_and_keys( (id)object, pOutObjects, pOutKeys, count );\n" );
+        fprintf( pSourceFileHandle, "}\n\n" );
+    }
+}
+
+void file_write_c_string_helper_declarations( FILE* pHeaderFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_class_name* pClassName )
+{
+    const char* pLinkage = cfunction_get_linkage( pParameter );
+    const char* pClassNameLower = pClassName->pNameLower;
+    fprintf( pHeaderFileHandle, "// String helpers, wraps 'pUTF8String' without copying. The buffer has to outlive the string unless 'freeWhenDone'\n" );
+    fprintf( pHeaderFileHandle, "// is set, in which case the string frees the buffer using free(). Returns a retained (+1) string.\n" );
+    fprintf( pHeaderFileHandle, "%s%s_t \t\t\t%s_create_no_copy( const char* pUTF8String, size_t length, bool freeWhenDone );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pHeaderFileHandle, "// Copies the string as null terminated UTF-8 into 'pBuffer', returns false if 'bufferSize' is too small\n" );
+    fprintf( pHeaderFileHandle, "%sbool \t\t\t\t%s_get_utf8( %s_t object, char* pBuffer, size_t bufferSize );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pHeaderFileHandle, "// Converts the first 'length' UTF-16 code units to UTF-8 (not null terminated), returns the number of bytes written\n" );
+    fprintf( pHeaderFileHandle, "%ssize_t \t\t\t\t%s_get_utf8_bytes( %s_t object, size_t length, char* pBuffer, size_t bufferSize );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pHeaderFileHandle, "// Copies 'length' UTF-16 code units starting at 'location' into 'pOutCharacters'\n" );
+    fprintf( pHeaderFileHandle, "%svoid \t\t\t\t%s_get_utf16( %s_t object, size_t location, size_t length, uint16_t* pOutCharacters );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+}
+
+void file_write_c_string_helper_implementations( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_class_name* pClassName )
+{
+    const char* pLinkage = cfunction_get_linkage( pParameter );
+    const char* pClassNameLower = pClassName->pNameLower;
+    fprintf( pSourceFileHandle, "%s%s_t %s_create_no_copy( const char* pUTF8String, size_t length, bool freeWhenDone )\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    file_write_c_function_cached_class_lookup( pSourceFileHandle, pClassName );
+    fprintf( pSourceFileHandle, "\treturn c_ocoa_string_create_no_copy( internalClassObject, pUTF8String, length, freeWhenDone );\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+
+    fprintf( pSourceFileHandle, "%sbool %s_get_utf8( %s_t object, char* pBuffer, size_t bufferSize )\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    fprintf( pSourceFileHandle, "\treturn c_ocoa_string_get_utf8( (id)object, pBuffer, bufferSize ) != 0;\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+
+    fprintf( pSourceFileHandle, "%ssize_t %s_get_utf8_bytes( %s_t object, size_t length, char* pBuffer, size_t bufferSize )\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    fprintf( pSourceFileHandle, "\treturn c_ocoa_string_get_utf8_bytes( (id)object, length, pBuffer, bufferSize );\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+
+    fprintf( pSourceFileHandle, "%svoid %s_get_utf16( %s_t object, size_t location, size_t length, uint16_t* pOutCharacters )\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    fprintf( pSourceFileHandle, "\tc_ocoa_string_get_utf16( (id)object, location, length, pOutCharacters );\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+}
+
+void file_write_c_data_helper_declarations( FILE* pHeaderFileHandle, const c_ocoa_code_generator_parameter* pParameter, c_ocoa_class_family classFamily, const c_ocoa_objc_class_name* pClassName )
+{
+    const char* pLinkage = cfunction_get_linkage( pParameter );
+    const char* pClassNameLower = pClassName->pNameLower;
+    fprintf( pHeaderFileHandle, "// Data helpers, references 'pBytes' without copying. 'pDeallocator' is called once the data object\n" );
+    fprintf( pHeaderFileHandle, "// doesn't need 'pBytes' anymore, if it is NULL 'pBytes' has to outlive the data object. Returns a retained (+1) object.\n" );
+    fprintf( pHeaderFileHandle, "%s%s_t \t\t\t%s_create_no_copy( void* pBytes, size_t length, c_ocoa_data_deallocator_fn pDeallocator, void* pUserData );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pHeaderFileHandle, "// Returns 'bytes' and 'length' in one call\n" );
+    fprintf( pHeaderFileHandle, "%sc_ocoa_data_view_t \t%s_get_view( %s_t object );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+    if( classFamily == ClassFamily_MutableData )
+    {
+        fprintf( pHeaderFileHandle, "// Returns 'mutableBytes' and 'length' in one call\n" );
+        fprintf( pHeaderFileHandle, "%sc_ocoa_mutable_data_view_t \t%s_get_mutable_view( %s_t object );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+    }
+    fprintf( pHeaderFileHandle, "// Copies 'length' bytes starting at 'location' into 'pOutBytes'\n" );
+    fprintf( pHeaderFileHandle, "%svoid \t\t\t\t%s_get_bytes( %s_t object, size_t location, size_t length, void* pOutBytes );\n\n", pLinkage, pClassNameLower, pClassNameLower );
+}
+
+void file_write_c_data_helper_implementations( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, c_ocoa_class_family classFamily, const c_ocoa_objc_class_name* pClassName )
+{
+    const char* pLinkage = cfunction_get_linkage( pParameter );
+    const char* pClassNameLower = pClassName->pNameLower;
+    fprintf( pSourceFileHandle, "%s%s_t %s_create_no_copy( void* pBytes, size_t length, c_ocoa_data_deallocator_fn pDeallocator, void* pUserData )\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    file_write_c_function_cached_class_lookup( pSourceFileHandle, pClassName );
+    fprintf( pSourceFileHandle, "\treturn c_ocoa_data_create_no_copy( internalClassObject, pBytes, length, pDeallocator, pUserData );\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+
+    fprintf( pSourceFileHandle, "%sc_ocoa_data_view_t %s_get_view( %s_t object )\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    fprintf( pSourceFileHandle, "\treturn c_ocoa_data_get_view( (id)object );\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+
+    if( classFamily == ClassFamily_MutableData )
+    {
+        fprintf( pSourceFileHandle, "%sc_ocoa_mutable_data_view_t %s_get_mutable_view( %s_t object )\n", pLinkage, pClassNameLower, pClassNameLower );
+        fprintf( pSourceFileHandle, "{\n" );
+        fprintf( pSourceFileHandle, "\treturn c_ocoa_mutable_data_get_view( (id)object );\n" );
+        fprintf( pSourceFileHandle, "}\n\n" );
+    }
+
+    fprintf( pSourceFileHandle, "%svoid %s_get_bytes( %s_t object, size_t location, size_t length, void* pOutBytes )\n", pLinkage, pClassNameLower, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    fprintf( pSourceFileHandle, "\tc_ocoa_data_get_bytes( (id)object, location, length, pOutBytes );\n" );
+    fprintf( pSourceFileHandle, "}\n\n" );
+}
+
+void file_write_c_class_family_helper_declarations( FILE* pHeaderFileHandle, const c_ocoa_code_generator_parameter* pParameter, c_ocoa_class_family classFamily, const c_ocoa_objc_class_name* pClassName )
+{
+    switch( classFamily )
+    {
+        case ClassFamily_Array:
+        case ClassFamily_Set:
+        case ClassFamily_Dictionary:
+            file_write_c_collection_helper_declarations( pHeaderFileHandle, pParameter, classFamily, pClassName );
+            break;
+
+        case ClassFamily_String:
+            file_write_c_string_helper_declarations( pHeaderFileHandle, pParameter, pClassName );
+            break;
+
+        case ClassFamily_Data:
+        case ClassFamily_MutableData:
+            file_write_c_data_helper_declarations( pHeaderFileHandle, pParameter, classFamily, pClassName );
+            break;
+
+        default:
+            break;
+    }
+}
+
+void file_write_c_class_family_helper_implementations( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, c_ocoa_class_family classFamily, const c_ocoa_objc_class_name* pClassName )
+{
+    switch( classFamily )
+    {
+        case ClassFamily_Array:
+        case ClassFamily_Set:
+        case ClassFamily_Dictionary:
+            file_write_c_collection_helper_implementations( pSourceFileHandle, pParameter, classFamily, pClassName );
+            break;
+
+        case ClassFamily_String:
+            file_write_c_string_helper_implementations( pSourceFileHandle, pParameter, pClassName );
+            break;
+
+        case ClassFamily_Data:
+        case ClassFamily_MutableData:
+            file_write_c_data_helper_implementations( pSourceFileHandle, pParameter, classFamily, pClassName );
+            break;
+
+        default:
+            break;
+    }
+}
+
+//FK: Returns the value of the property attribute 'attribute' (eg: 'V' for the name of the backing ivar) or NULL
+//    if the property doesn't have this attribute. See "Declared Properties" of the objc runtime programming guide.
+const char* objc_property_find_attribute( const char* pAttributes, char attribute, int32_t* pOutValueLength )
+{
+    const char* pCurrentAttribute = pAttributes;
+    while( *pCurrentAttribute )
+    {
+        const char* pAttributeEnd = strchr( pCurrentAttribute, ',' );
+        if( pAttributeEnd == NULL )
+        {
+            pAttributeEnd = pCurrentAttribute + strlen( pCurrentAttribute );
+        }
+
+        if( *pCurrentAttribute == attribute )
+        {
+            *pOutValueLength = cast_size_to_int32( pAttributeEnd - pCurrentAttribute - 1 );
+            return pCurrentAttribute + 1;
+        }
+
+        if( *pAttributeEnd == 0 )
+        {
+            break;
+        }
+
+        pCurrentAttribute = pAttributeEnd + 1;
+    }
+
+    return NULL;
+}
+
+//FK: Compares two type encodings while ignoring quoted names. Ivar encodings may contain the names
+//    of struct members (eg: '{CGPoint="x"d"y"d}') while property encodings don't.
+boolean8_t objc_type_encoding_is_equal( const char* pTypeA, int32_t typeALength, const char* pTypeB, int32_t typeBLength )
+{
+    const char* pTypeAEnd = pTypeA + typeALength;
+    const char* pTypeBEnd = pTypeB + typeBLength;
+    while( 1 )
+    {
+        while( pTypeA < pTypeAEnd && *pTypeA == '"' )
+        {
+            const char* pNameEnd = (const char*)memchr( pTypeA + 1, '"', pTypeAEnd - pTypeA - 1 );
+            pTypeA = pNameEnd == NULL ? pTypeAEnd : pNameEnd + 1;
+        }
+
+        while( pTypeB < pTypeBEnd && *pTypeB == '"' )
+        {
+            const char* pNameEnd = (const char*)memchr( pTypeB + 1, '"', pTypeBEnd - pTypeB - 1 );
+            pTypeB = pNameEnd == NULL ? pTypeBEnd : pNameEnd + 1;
+        }
+
+        if( pTypeA == pTypeAEnd || pTypeB == pTypeBEnd )
+        {
+            return pTypeA == pTypeAEnd && pTypeB == pTypeBEnd;
+        }
+
+        if( *pTypeA++ != *pTypeB++ )
+        {
+            return 0;
+        }
+    }
+}
+
+//FK: Only plain ivars are supported, bitfields ('b'), unions and arrays are skipped.
+boolean8_t objc_is_ivar_accessor_type( const char* pTypeName, int32_t typeNameLength )
+{
+    return typeNameLength == 1 || pTypeName[0] == '@' || pTypeName[0] == '^' || objc_is_struct_type( pTypeName );
+}
+
+//FK: Writes the type encoding without quoted names, so that it can be embedded into a C string literal as is
+void file_write_objc_type_encoding_without_names( FILE* pFileHandle, const char* pTypeEncoding, int32_t typeEncodingLength )
+{
+    const char* pTypeEncodingEnd = pTypeEncoding + typeEncodingLength;
+    while( pTypeEncoding < pTypeEncodingEnd )
+    {
+        if( *pTypeEncoding == '"' )
+        {
+            const char* pNameEnd = (const char*)memchr( pTypeEncoding + 1, '"', pTypeEncodingEnd - pTypeEncoding - 1 );
+            pTypeEncoding = pNameEnd == NULL ? pTypeEncodingEnd : pNameEnd + 1;
+            continue;
+        }
+
+        fputc( *pTypeEncoding++, pFileHandle );
+    }
+}
+
+void file_write_c_ivar_accessor( const c_ocoa_source_code_generator_input* pInput, const char* pPropertyName, const char* pIvarName, const char* pTypeEncoding, int32_t typeEncodingLength, const char* pResolvedType )
+{
+    const char* pLinkage = cfunction_get_linkage( pInput->pParameter );
+    const char* pClassNameLower = pInput->pClassName->pNameLower;
+
+    fprintf( pInput->pHeaderFileHandle, "%s%s* \t\t\t%s_ivar_%s_ptr( %s_t object );\n", pLinkage, pResolvedType, pClassNameLower, pPropertyName, pClassNameLower );
+
+    FILE* pSourceFileHandle = pInput->pSourceFileHandle;
+    fprintf( pSourceFileHandle, "%s%s* %s_ivar_%s_ptr( %s_t object )\n", pLinkage, pResolvedType, pClassNameLower, pPropertyName, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    fprintf( pSourceFileHandle, "\t//FK: -1 = not looked up yet, 0 = ivar doesn't exist (anymore) or has a different type (offset 0 is always 'isa')\n" );
+    fprintf( pSourceFileHandle, "\tstatic ptrdiff_t ivarOffset = -1;\n" );
+    fprintf( pSourceFileHandle, "\tif( ivarOffset == -1 )\n\t{\n" );
+    fprintf( pSourceFileHandle, "\t\tivarOffset = c_ocoa_find_ivar_offset( objc_getClass( \"%s\" ), \"%s\", \"", pInput->pClassName->pName, pIvarName );
+    file_write_objc_type_encoding_without_names( pSourceFileHandle, pTypeEncoding, typeEncodingLength );
+    fprintf( pSourceFileHandle, "\" );\n" );
+    fprintf( pSourceFileHandle, "\t}\n\n" );
+    fprintf( pSourceFileHandle, "\tif( object == NULL || ivarOffset == 0 )\n\t{\n" );
+    fprintf( pSourceFileHandle, "\t\treturn NULL;\n" );
+    fprintf( pSourceFileHandle, "\t}\n\n" );
+    fprintf( pSourceFileHandle, "\treturn (%s*)( (char*)object + ivarOffset );\n", pResolvedType );
+    fprintf( pSourceFileHandle, "}\n\n" );
+}
+
+//FK: Emits '<class>_ivar_<property>_ptr()' for every property declared by pClass that is backed by an ivar
+//    of the same type. Properties that are weak, dynamic or computed (no 'V' attribute) are skipped.
+void c_ocoa_create_source_code_for_objc_ivar_accessors( const c_ocoa_source_code_generator_input* pInput, Class pClass )
+{
+    uint32_t propertyCount = 0u;
+    objc_property_t* pProperties = class_copyPropertyList( pClass, &propertyCount );
+    if( pProperties == NULL )
+    {
+        return;
+    }
+
+    boolean8_t wroteWarning = 0;
+    for( uint32_t propertyIndex = 0u; propertyIndex < propertyCount; ++propertyIndex )
+    {
+        const char* pPropertyName = property_getName( pProperties[ propertyIndex ] );
+        const char* pAttributes = property_getAttributes( pProperties[ propertyIndex ] );
+
+        int32_t typeLength = 0;
+        int32_t ivarNameLength = 0;
+        int32_t weakLength = 0;
+        const char* pType = objc_property_find_attribute( pAttributes, 'T', &typeLength );
+        const char* pIvarName = objc_property_find_attribute( pAttributes, 'V', &ivarNameLength );
+        if( pType == NULL || pIvarName == NULL || ivarNameLength == 0 || objc_property_find_attribute( pAttributes, 'W', &weakLength ) != NULL )
+        {
+            continue;
+        }
+
+        if( !objc_is_ivar_accessor_type( pType, typeLength ) )
+        {
+            continue;
+        }
+
+        char ivarName[ 256 ];
+        if( ivarNameLength >= (int32_t)sizeof( ivarName ) )
+        {
+            continue;
+        }
+
+        memory_copy_non_overlapping( ivarName, pIvarName, ivarNameLength );
+        ivarName[ ivarNameLength ] = 0;
+
+        //FK: Verify that the ivar really exists and has the type of the property
+        Ivar pIvar = class_getInstanceVariable( pClass, ivarName );
+        if( pIvar == NULL )
+        {
+            continue;
+        }
+
+        const char* pIvarType = ivar_getTypeEncoding( pIvar );
+        if( pIvarType == NULL || !objc_type_encoding_is_equal( pType, typeLength, pIvarType, string_get_length_excl_null_terminator( pIvarType ) ) )
+        {
+            continue;
+        }
+
+        c_ocoa_objc_type_resolve_result typeResolveResult = {};
+        if( !objc_resolve_c_type_name_of_type_encoding( &typeResolveResult, pInput->pTypeDict, pType, typeLength ) )
+        {
+            continue;
+        }
+
+        if( !wroteWarning )
+        {
+            fprintf( pInput->pHeaderFileHandle, "\n// WARNING: Direct ivar access. These bypass the getters/setters (no KVO, no atomicity, no lazy\n" );
+            fprintf( pInput->pHeaderFileHandle, "// initialization, no subclass overrides) and depend on private implementation details that may\n" );
+            fprintf( pInput->pHeaderFileHandle, "// change with any OS update. The offset is looked up at runtime, the ivar itself is not part of the API.\n" );
+            fprintf( pInput->pHeaderFileHandle, "// NULL is returned for nil and if the ivar doesn't exist (anymore) or has a different type at runtime.\n" );
+            wroteWarning = 1;
+        }
+
+        file_write_c_ivar_accessor( pInput, pPropertyName, ivarName, pIvarType, string_get_length_excl_null_terminator( pIvarType ), typeResolveResult.pResolvedType );
+    }
+
+    if( wroteWarning )
+    {
+        fprintf( pInput->pHeaderFileHandle, "\n" );
+    }
+
+    free( pProperties );
+}
+
+//FK: Returns the property list of the first spec of '--snapshot' that names pClass (the part after '='), NULL if there's none
+const char* objc_find_snapshot_property_list( const c_ocoa_code_generator_parameter* pParameter, Class pClass )
+{
+    const char* pClassName = class_getName( pClass );
+    const size_t classNameLength = strlen( pClassName );
+    for( uint8_t specificationIndex = 0u; specificationIndex < pParameter->snapshotSpecificationCount; ++specificationIndex )
+    {
+        const char* pSpecification = pParameter->pSnapshotSpecifications[ specificationIndex ];
+        if( strncmp( pSpecification, pClassName, classNameLength ) == 0 && pSpecification[ classNameLength ] == '=' )
+        {
+            return pSpecification + classNameLength + 1;
+        }
+    }
+
+    return NULL;
+}
+
+//FK: Searches the property lists of pClass and its superclasses (eg: 'frame' of NSWindow subclasses)
+objc_property_t objc_find_property( Class pClass, const char* pPropertyName, int32_t propertyNameLength )
+{
+    for( Class pCurrentClass = pClass; pCurrentClass != NULL; pCurrentClass = class_getSuperclass( pCurrentClass ) )
+    {
+        uint32_t propertyCount = 0u;
+        objc_property_t* pProperties = class_copyPropertyList( pCurrentClass, &propertyCount );
+        if( pProperties == NULL )
+        {
+            continue;
+        }
 
-boolean8_t objc_function_collection_contains_function( const c_ocoa_objc_function_collection* pFunctionCollection, const c_ocoa_objc_class_name* pClassName, const char* pFunctionName, const int32_t functionNameLength )
+        objc_property_t pFoundProperty = NULL;
+        for( uint32_t propertyIndex = 0u; propertyIndex < propertyCount; ++propertyIndex )
+        {
+            const char* pName = property_getName( pProperties[ propertyIndex ] );
+            if( strncmp( pName, pPropertyName, propertyNameLength ) == 0 && pName[ propertyNameLength ] == 0 )
+            {
+                pFoundProperty = pProperties[ propertyIndex ];
+                break;
+            }
+        }
+
+        free( pProperties );
+        if( pFoundProperty != NULL )
+        {
+            return pFoundProperty;
+        }
+    }
+
+    return NULL;
+}
+
+typedef struct
 {
-    //FK: Skip the 'classname_' part of the function name (to save an allocation in the calling code)
-    //    eg: 'nsapplication_shutdown' -> skip 'nsapplication_'
-    const int32_t functionCharSkipCount = pClassName->length;
+    const char*                         pPropertyName;
+    char*                               pGetterName;
+    c_ocoa_objc_function_resolve_result getter;     //FK: only the return value related fields are set
+} c_ocoa_snapshot_property;
 
-    for( uint32_t functionIndex = 0u; functionIndex < pFunctionCollection->size; ++functionIndex )
+boolean8_t objc_resolve_snapshot_property( c_ocoa_snapshot_property* pOutProperty, const c_ocoa_source_code_generator_input* pInput, objc_property_t pProperty )
+{
+    const char* pAttributes = property_getAttributes( pProperty );
+
+    int32_t typeLength = 0;
+    const char* pType = objc_property_find_attribute( pAttributes, 'T', &typeLength );
+    if( pType == NULL || typeLength == 0 || objc_is_block_type( pType, typeLength ) )
     {
-        const c_ocoa_objc_function_collection_entry* pFunctionNameEntry   = pFunctionCollection->pEntries + functionIndex;
-        const int32_t functionBaseNameLength                    = pFunctionNameEntry->functionNameLength - functionCharSkipCount;
-        assert_runtime( functionBaseNameLength > 0u );
+        return 0;
+    }
+
+    c_ocoa_objc_type_resolve_result typeResolveResult = {};
+    if( !objc_resolve_c_type_name_of_type_encoding( &typeResolveResult, pInput->pTypeDict, pType, typeLength ) )
+    {
+        return 0;
+    }
+
+    //FK: Custom getter name (eg: 'isVisible' for 'visible')
+    int32_t getterNameLength = 0;
+    const char* pGetterName = objc_property_find_attribute( pAttributes, 'G', &getterNameLength );
+    if( pGetterName == NULL )
+    {
+        pGetterName = property_getName( pProperty );
+        getterNameLength = string_get_length_excl_null_terminator( pGetterName );
+    }
+
+    pOutProperty->pPropertyName = property_getName( pProperty );
+    pOutProperty->pGetterName   = string_allocate_copy_with_allocator( pInput->pStringAllocator, pGetterName, getterNameLength );
+
+    c_ocoa_objc_function_resolve_result getter = {};
+    getter.pResolvedReturnType          = typeResolveResult.pResolvedType;
+    getter.returnValueSizeInBits        = typeResolveResult.typeSizeInBits;
+    getter.hasStructReturnValue         = !typeResolveResult.isReference && !typeResolveResult.isBaseType;
+    getter.hasLargeStructReturnValue    = objc_type_is_large_struct( &typeResolveResult );
+    getter.hasFloatReturnValue          = typeResolveResult.isFloatingType;
+    getter.methodType                   = MethodType_Instance;
+    pOutProperty->getter = getter;
+    return 1;
+}
+
+void file_write_c_snapshot( const c_ocoa_source_code_generator_input* pInput, const c_ocoa_snapshot_property* pProperties, uint32_t propertyCount )
+{
+    const char* pLinkage = cfunction_get_linkage( pInput->pParameter );
+    const char* pClassNameLower = pInput->pClassName->pNameLower;
+
+    FILE* pHeaderFileHandle = pInput->pHeaderFileHandle;
+    fprintf( pHeaderFileHandle, "// Property values that get read by %s_snapshot().\n", pClassNameLower );
+    fprintf( pHeaderFileHandle, "typedef struct\n{\n" );
+    for( uint32_t propertyIndex = 0u; propertyIndex < propertyCount; ++propertyIndex )
+    {
+        fprintf( pHeaderFileHandle, "\t%s %s;\n", pProperties[ propertyIndex ].getter.pResolvedReturnType, pProperties[ propertyIndex ].pPropertyName );
+    }
+    fprintf( pHeaderFileHandle, "} %s_state_t;\n\n", pClassNameLower );
+    fprintf( pHeaderFileHandle, "// Reads all properties of %s_state_t in one call, a nil object yields a zeroed state.\n", pClassNameLower );
+    fprintf( pHeaderFileHandle, "%svoid \t\t\t\t%s_snapshot( %s_t object, %s_state_t* pOutState );\n\n", pLinkage, pClassNameLower, pClassNameLower, pClassNameLower );
+
+    FILE* pSourceFileHandle = pInput->pSourceFileHandle;
+    fprintf( pSourceFileHandle, "%svoid %s_snapshot( %s_t object, %s_state_t* pOutState )\n", pLinkage, pClassNameLower, pClassNameLower, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    file_write_c_function_profile_scope( pSourceFileHandle, pClassNameLower, "_snapshot" );
+    fprintf( pSourceFileHandle, "\tif( object == NULL )\n\t{\n" );
+    fprintf( pSourceFileHandle, "\t\tconst %s_state_t emptyState = { 0 };\n", pClassNameLower );
+    fprintf( pSourceFileHandle, "\t\t*pOutState = emptyState;\n" );
+    fprintf( pSourceFileHandle, "\t\treturn;\n" );
+    fprintf( pSourceFileHandle, "\t}\n" );
+
+    //FK: One selector and one (Class, IMP) cache per property, so subsequent snapshots of objects of
+    //    the same class call the getters directly
+    for( uint32_t propertyIndex = 0u; propertyIndex < propertyCount; ++propertyIndex )
+    {
+        const c_ocoa_snapshot_property* pProperty = pProperties + propertyIndex;
+        fprintf( pSourceFileHandle, "\n\tstatic SEL selector%u = NULL;\n", propertyIndex );
+        fprintf( pSourceFileHandle, "\tstatic c_ocoa_imp_cache_t impCache%u;\n", propertyIndex );
+        fprintf( pSourceFileHandle, "\tif( selector%u == NULL )\n\t{\n", propertyIndex );
+        fprintf( pSourceFileHandle, "\t\tselector%u = sel_registerName( \"%s\" );\n", propertyIndex, pProperty->pGetterName );
+        fprintf( pSourceFileHandle, "\t}\n" );
+        fprintf( pSourceFileHandle, "\tIMP imp%u = c_ocoa_imp_cache_lookup( &impCache%u, (id)object, selector%u );\n", propertyIndex, propertyIndex, propertyIndex );
+        fprintf( pSourceFileHandle, "\tif( imp%u == NULL )\n\t{\n", propertyIndex );
+        fprintf( pSourceFileHandle, "\t\timp%u = (IMP)%s;\n", propertyIndex, objc_find_msgsend_call( &pProperty->getter ) );
+        fprintf( pSourceFileHandle, "\t}\n" );
+        fprintf( pSourceFileHandle, "\tpOutState->%s = (", pProperty->pPropertyName );
+        file_write_c_function_pointer_type( pSourceFileHandle, &pProperty->getter );
+        fprintf( pSourceFileHandle, "imp%u)( (id)object, selector%u );\n", propertyIndex, propertyIndex );
+    }
+
+    fprintf( pSourceFileHandle, "}\n\n" );
+    fflush( pSourceFileHandle );
+}
+
+//FK: The state struct gets one member per property, listing a property twice would emit the member twice
+boolean8_t objc_snapshot_contains_property( const c_ocoa_snapshot_property* pProperties, uint32_t propertyCount, const char* pPropertyName )
+{
+    for( uint32_t propertyIndex = 0u; propertyIndex < propertyCount; ++propertyIndex )
+    {
+        if( strcmp( pProperties[ propertyIndex ].pPropertyName, pPropertyName ) == 0 )
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//FK: Emits '<class>_state_t' and '<class>_snapshot()' for the properties listed via '--snapshot <class>=...'
+void c_ocoa_create_source_code_for_objc_snapshot( const c_ocoa_source_code_generator_input* pInput, Class pClass )
+{
+    const char* pPropertyList = objc_find_snapshot_property_list( pInput->pParameter, pClass );
+    if( pPropertyList == NULL )
+    {
+        return;
+    }
+
+    c_ocoa_snapshot_property properties[ 64 ];
+    uint32_t propertyCount = 0u;
+
+    const char* pPropertyName = pPropertyList;
+    while( *pPropertyName != 0 )
+    {
+        const char* pPropertyNameEnd = strchr( pPropertyName, ',' );
+        if( pPropertyNameEnd == NULL )
+        {
+            pPropertyNameEnd = pPropertyName + strlen( pPropertyName );
+        }
+
+        const int32_t propertyNameLength = cast_size_to_int32( pPropertyNameEnd - pPropertyName );
+        if( propertyNameLength == 0 )
+        {
+            //FK: Empty entry (eg: trailing ',')
+        }
+        else if( propertyCount == array_count( properties ) )
+        {
+            printf_stderr( "[error] Skipping snapshot property '%.*s' of class '%s', only %d properties are supported.\n", propertyNameLength, pPropertyName, class_getName( pClass ), (int)array_count( properties ) );
+        }
+        else
+        {
+            objc_property_t pProperty = objc_find_property( pClass, pPropertyName, propertyNameLength );
+            if( pProperty == NULL || !objc_resolve_snapshot_property( properties + propertyCount, pInput, pProperty ) )
+            {
+                printf_stderr( "[error] Skipping snapshot property '%.*s' of class '%s' because it doesn't exist or has an unsupported type.\n", propertyNameLength, pPropertyName, class_getName( pClass ) );
+            }
+            else if( objc_snapshot_contains_property( properties, propertyCount, properties[ propertyCount ].pPropertyName ) )
+            {
+                printf_stderr( "[error] Skipping snapshot property '%.*s' of class '%s' because it's listed more than once.\n", propertyNameLength, pPropertyName, class_getName( pClass ) );
+            }
+            else
+            {
+                ++propertyCount;
+            }
+        }
+
+        pPropertyName = *pPropertyNameEnd == ',' ? pPropertyNameEnd + 1 : pPropertyNameEnd;
+    }
+
+    if( propertyCount > 0u )
+    {
+        file_write_c_snapshot( pInput, properties, propertyCount );
+    }
+}
+
+//FK: Returns the end of the first type of a method type encoding (the stack offset that follows it isn't part of the type)
+//    eg: 'c24@0:8@16' -> '24@0:8@16'
+const char* objc_type_encoding_find_type_end( const char* pTypeEncoding )
+{
+    while( *pTypeEncoding == 'r' || objc_is_method_type_qualifier( *pTypeEncoding ) )
+    {
+        ++pTypeEncoding;
+    }
+
+    switch( *pTypeEncoding )
+    {
+        case 0:
+            return pTypeEncoding;
+
+        case '^':
+            return objc_type_encoding_find_type_end( pTypeEncoding + 1 );
+
+        case '@':
+            ++pTypeEncoding;
+            if( *pTypeEncoding == '?' )
+            {
+                //FK: Block, optionally followed by the extended block signature (eg: '@?<v@?@>')
+                ++pTypeEncoding;
+                if( *pTypeEncoding == '<' )
+                {
+                    while( *pTypeEncoding != 0 && *pTypeEncoding++ != '>' );
+                }
+            }
+            else if( *pTypeEncoding == '"' )
+            {
+                //FK: Class name of extended type encodings (eg: '@"NSString"')
+                ++pTypeEncoding;
+                while( *pTypeEncoding != 0 && *pTypeEncoding++ != '"' );
+            }
+            return pTypeEncoding;
+
+        case '{':
+        case '(':
+        case '[':
+        {
+            int32_t depth = 0;
+            do
+            {
+                const char character = *pTypeEncoding++;
+                if( character == '{' || character == '(' || character == '[' )
+                {
+                    ++depth;
+                }
+                else if( character == '}' || character == ')' || character == ']' )
+                {
+                    --depth;
+                }
+                else if( character == '"' )
+                {
+                    //FK: Member names of extended type encodings may contain anything
+                    while( *pTypeEncoding != 0 && *pTypeEncoding++ != '"' );
+                }
+            } while( depth > 0 && *pTypeEncoding != 0 );
+            return pTypeEncoding;
+        }
+
+        case 'b':
+            //FK: Bitfield, followed by the bit count
+            ++pTypeEncoding;
+            while( *pTypeEncoding >= '0' && *pTypeEncoding <= '9' )
+            {
+                ++pTypeEncoding;
+            }
+            return pTypeEncoding;
+
+        default:
+            return pTypeEncoding + 1;
+    }
+}
+
+const char* objc_type_encoding_skip_offset( const char* pTypeEncoding )
+{
+    while( *pTypeEncoding == '-' || ( *pTypeEncoding >= '0' && *pTypeEncoding <= '9' ) )
+    {
+        ++pTypeEncoding;
+    }
+
+    return pTypeEncoding;
+}
+
+typedef struct
+{
+    const char* pSelectorName;
+    const char* pTypeEncoding;
+    char*       pMemberName;    //FK: selector with ':' replaced by '_', eg: 'application_openFile' for 'application:openFile:'
+    const char* pResolvedReturnType;
+    const char* pResolvedArgumentTypes[32];
+    uint8_t     argumentCount;
+    boolean8_t  isRequired;
+} c_ocoa_protocol_method;
+
+boolean8_t objc_resolve_protocol_method( c_ocoa_protocol_method* pOutMethod, c_ocoa_string_allocator* pStringAllocator, c_ocoa_objc_type_dictionary* pTypeDict, const struct objc_method_description* pMethodDescription, boolean8_t isRequired )
+{
+    if( pMethodDescription->name == NULL || pMethodDescription->types == NULL )
+    {
+        return 0;
+    }
+
+    const char* pSelectorName = sel_getName( pMethodDescription->name );
+    const char* pTypeEncoding = pMethodDescription->types;
+    const int32_t selectorNameLength = string_get_length_excl_null_terminator( pSelectorName );
+
+    c_ocoa_protocol_method method = {};
+    method.pSelectorName = pSelectorName;
+    method.pTypeEncoding = pTypeEncoding;
+    method.isRequired    = isRequired;
+    method.pMemberName   = string_allocate_copy_with_allocator( pStringAllocator, pSelectorName, selectorNameLength );
+    for( int32_t charIndex = 0; charIndex < selectorNameLength; ++charIndex )
+    {
+        if( method.pMemberName[ charIndex ] == ':' )
+        {
+            //FK: The last colon just gets dropped ('windowWillClose:' -> 'windowWillClose')
+            method.pMemberName[ charIndex ] = charIndex + 1 == selectorNameLength ? 0 : '_';
+        }
+    }
+
+    //FK: Return type, self, _cmd and then the arguments
+    const uint8_t argumentsToSkip = 2;
+    uint8_t typeIndex = 0u;
+    const char* pType = pTypeEncoding;
+    while( *pType != 0 )
+    {
+        const char* pTypeEnd = objc_type_encoding_find_type_end( pType );
+        const int32_t typeLength = cast_size_to_int32( pTypeEnd - pType );
+
+        if( typeIndex == 0u || typeIndex > argumentsToSkip )
+        {
+            if( typeIndex > argumentsToSkip && method.argumentCount == array_count( method.pResolvedArgumentTypes ) )
+            {
+                return 0;
+            }
+
+            c_ocoa_objc_type_resolve_result typeResolveResult = {};
+            if( !objc_resolve_c_type_name_of_type_encoding( &typeResolveResult, pTypeDict, pType, typeLength ) )
+            {
+                return 0;
+            }
+
+            if( typeIndex == 0u )
+            {
+                method.pResolvedReturnType = typeResolveResult.pResolvedType;
+            }
+            else
+            {
+                method.pResolvedArgumentTypes[ method.argumentCount++ ] = typeResolveResult.pResolvedType;
+            }
+        }
+
+        ++typeIndex;
+        pType = objc_type_encoding_skip_offset( pTypeEnd );
+    }
+
+    if( typeIndex <= argumentsToSkip )
+    {
+        //FK: Not even self + _cmd, something is off with this encoding
+        return 0;
+    }
+
+    *pOutMethod = method;
+    return 1;
+}
+
+//FK: Different selectors can end up with the same member name (eg: 'foo' and 'foo:' -> 'foo').
+//    Members that collide with a previous member get a '_<n>' suffix (eg: 'foo_2').
+boolean8_t objc_make_protocol_member_names_unique( c_ocoa_protocol_method* pMethods, uint32_t methodCount, c_ocoa_string_allocator* pStringAllocator, const char* pProtocolName )
+{
+    for( uint32_t methodIndex = 1u; methodIndex < methodCount; ++methodIndex )
+    {
+        c_ocoa_protocol_method* pMethod = pMethods + methodIndex;
+        const char* pMemberName = pMethod->pMemberName;
+        const int32_t memberNameLength = string_get_length_excl_null_terminator( pMemberName );
+
+        uint32_t suffix = 1u;
+        for( uint32_t previousMethodIndex = 0u; previousMethodIndex < methodIndex; ++previousMethodIndex )
+        {
+            if( strcmp( pMethods[ previousMethodIndex ].pMemberName, pMethod->pMemberName ) != 0 )
+            {
+                continue;
+            }
+
+            //FK: +1 for '_', +10 for the suffix, +1 for null terminator
+            char* pUniqueMemberName = string_allocator_allocate( pStringAllocator, memberNameLength + 12 );
+            if( pUniqueMemberName == NULL )
+            {
+                printf_stderr( "[error] Out of memory while trying to make member '%s' of protocol '%s' unique.\n", pMemberName, pProtocolName );
+                return 0;
+            }
+
+            sprintf( pUniqueMemberName, "%s_%u", pMemberName, ++suffix );
+            pMethod->pMemberName = pUniqueMemberName;
+
+            //FK: Start over, the suffixed name might collide as well
+            previousMethodIndex = UINT32_MAX;
+        }
+
+        if( suffix > 1u )
+        {
+            printf_stderr( "[warning] Member of selector '%s' of protocol '%s' is called '%s' because '%s' is already taken.\n", pMethod->pSelectorName, pProtocolName, pMethod->pMemberName, pMemberName );
+        }
+    }
+
+    return 1;
+}
+
+void file_write_c_protocol_vtable_member( FILE* pHeaderFileHandle, const c_ocoa_protocol_method* pMethod )
+{
+    fprintf( pHeaderFileHandle, "\t%s (*%s)( id self, SEL selector", pMethod->pResolvedReturnType, pMethod->pMemberName );
+    for( uint8_t argumentIndex = 0u; argumentIndex < pMethod->argumentCount; ++argumentIndex )
+    {
+        fprintf( pHeaderFileHandle, ", %s arg%u", pMethod->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
+    }
+    fprintf( pHeaderFileHandle, " );\t// %s%s\n", pMethod->pSelectorName, pMethod->isRequired ? "" : " (optional)" );
+}
+
+void file_write_c_protocol_header( FILE* pHeaderFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_class_name* pProtocolName, const c_ocoa_protocol_method* pMethods, uint32_t methodCount )
+{
+    const char* pNameLower = pProtocolName->pNameLower;
+
+    file_write_generated_comment( pHeaderFileHandle );
+    fprintf( pHeaderFileHandle, "#ifndef SHIMMER_C_OCOA_%s_PROTOCOL_HEADER\n#define SHIMMER_C_OCOA_%s_PROTOCOL_HEADER\n\n", pProtocolName->pNameUpper, pProtocolName->pNameUpper );
+    fprintf( pHeaderFileHandle, "#include \"c_ocoa_types.h\"\n" );
+    fprintf( pHeaderFileHandle, "#include \"c_ocoa_runtime.h\"\n\n" );
+
+    if( !pParameter->headerOnly )
+    {
+        fprintf( pHeaderFileHandle, "// Selectors and type encodings of the %s protocol (in the same order as the functions of %s_vtable_t).\n", pProtocolName->pName, pNameLower );
+        fprintf( pHeaderFileHandle, "extern c_ocoa_protocol_t %s_protocol;\n\n", pNameLower );
+    }
+
+    fprintf( pHeaderFileHandle, "// Implementation of the %s protocol for %s_define_class(), NULL functions don't get added to the class.\n", pProtocolName->pName, pNameLower );
+    fprintf( pHeaderFileHandle, "typedef struct\n{\n" );
+    fprintf( pHeaderFileHandle, "\tc_ocoa_protocol_t* pProtocol;\n" );
+    for( uint32_t methodIndex = 0u; methodIndex < methodCount; ++methodIndex )
+    {
+        file_write_c_protocol_vtable_member( pHeaderFileHandle, pMethods + methodIndex );
+    }
+    fprintf( pHeaderFileHandle, "} %s_vtable_t;\n\n", pNameLower );
+
+    fprintf( pHeaderFileHandle, "// eg: static const %s_vtable_t vtable = %s_vtable_init( .%s = my_function );\n", pNameLower, pNameLower, pMethods[ 0 ].pMemberName );
+    fprintf( pHeaderFileHandle, "//     %s_define_class( \"MyDelegate\", \"NSObject\", &vtable );\n", pNameLower );
+    fprintf( pHeaderFileHandle, "#define %s_vtable_init( ... ) { &%s_protocol, __VA_ARGS__ }\n\n", pNameLower, pNameLower );
+
+    fprintf( pHeaderFileHandle, "// Defines and registers the class 'pClassName' that conforms to %s and implements all non-NULL functions of pVTable.\n", pProtocolName->pName );
+    fprintf( pHeaderFileHandle, "static inline Class %s_define_class( const char* pClassName, const char* pParentClassName, const %s_vtable_t* pVTable )\n", pNameLower, pNameLower );
+    fprintf( pHeaderFileHandle, "{\n" );
+    fprintf( pHeaderFileHandle, "\treturn c_ocoa_define_delegate_class_internal( pClassName, pParentClassName, pVTable );\n" );
+    fprintf( pHeaderFileHandle, "}\n\n" );
+}
+
+void file_write_c_protocol_descriptor( FILE* pSourceFileHandle, const c_ocoa_code_generator_parameter* pParameter, const c_ocoa_objc_class_name* pProtocolName, const c_ocoa_protocol_method* pMethods, uint32_t methodCount )
+{
+    const char* pNameLower = pProtocolName->pNameLower;
+
+    fprintf( pSourceFileHandle, "static const char* const %s_selector_names[] =\n{\n", pNameLower );
+    for( uint32_t methodIndex = 0u; methodIndex < methodCount; ++methodIndex )
+    {
+        fprintf( pSourceFileHandle, "\t\"%s\",\n", pMethods[ methodIndex ].pSelectorName );
+    }
+    fprintf( pSourceFileHandle, "};\n\n" );
+
+    fprintf( pSourceFileHandle, "static const char* const %s_type_encodings[] =\n{\n", pNameLower );
+    for( uint32_t methodIndex = 0u; methodIndex < methodCount; ++methodIndex )
+    {
+        //FK: Extended type encodings may contain class names in quotes
+        fprintf( pSourceFileHandle, "\t\"" );
+        for( const char* pCharacter = pMethods[ methodIndex ].pTypeEncoding; *pCharacter != 0; ++pCharacter )
+        {
+            if( *pCharacter == '"' || *pCharacter == '\\' )
+            {
+                fputc( '\\', pSourceFileHandle );
+            }
+            fputc( *pCharacter, pSourceFileHandle );
+        }
+        fprintf( pSourceFileHandle, "\",\n" );
+    }
+    fprintf( pSourceFileHandle, "};\n\n" );
+
+    //FK: In header-only mode every translation unit gets its own descriptor (and resolves the selectors once)
+    fprintf( pSourceFileHandle, "static SEL %s_selectors[ %u ];\n\n", pNameLower, methodCount );
+    fprintf( pSourceFileHandle, "%sc_ocoa_protocol_t %s_protocol = { \"%s\", %s_selector_names, %s_type_encodings, %s_selectors, NULL, %uu, 0u };\n\n", 
+        pParameter->headerOnly ? "static " : "", pNameLower, pProtocolName->pName, pNameLower, pNameLower, pNameLower, methodCount );
+}
+
+//FK: Emits '<protocol>_vtable_t' + the protocol descriptor for the instance methods of a protocol (see '--protocols')
+boolean8_t c_ocoa_create_source_code_for_objc_protocol( const c_ocoa_code_generator_parameter* pParameter, c_ocoa_objc_type_dictionary* pTypeDict, c_ocoa_string_allocator* pStringAllocator, Protocol* pProtocol )
+{
+    const char* pProtocolName = protocol_getName( pProtocol );
+    if( pProtocolName == NULL || !string_name_matches_filter( pProtocolName, pParameter->pProtocolNameFilter ) )
+    {
+        return 0u;
+    }
+
+    //FK: Class methods are left out, delegates only get instance methods called.
+    //    Methods of adopted protocols (eg: <NSObject>) are left out as well since the parent class implements them
+    uint32_t requiredMethodCount = 0u;
+    uint32_t optionalMethodCount = 0u;
+    struct objc_method_description* pRequiredMethods = protocol_copyMethodDescriptionList( pProtocol, YES, YES, &requiredMethodCount );
+    struct objc_method_description* pOptionalMethods = protocol_copyMethodDescriptionList( pProtocol, NO, YES, &optionalMethodCount );
+
+    c_ocoa_protocol_method* pMethods = (c_ocoa_protocol_method*)malloc( sizeof( c_ocoa_protocol_method ) * ( requiredMethodCount + optionalMethodCount + 1u ) );
+    if( pMethods == NULL )
+    {
+        printf_stderr( "[error] Out of memory while trying to collect the methods of protocol '%s'.\n", pProtocolName );
+        free( pRequiredMethods );
+        free( pOptionalMethods );
+        return 0u;
+    }
+
+    uint32_t methodCount = 0u;
+    for( uint32_t methodIndex = 0u; methodIndex < requiredMethodCount + optionalMethodCount; ++methodIndex )
+    {
+        const boolean8_t isRequired = methodIndex < requiredMethodCount;
+        const struct objc_method_description* pMethodDescription = isRequired ? pRequiredMethods + methodIndex : pOptionalMethods + ( methodIndex - requiredMethodCount );
+        if( !objc_resolve_protocol_method( pMethods + methodCount, pStringAllocator, pTypeDict, pMethodDescription, isRequired ) )
+        {
+            printf_stderr( "[error] Skipping method '%s' of protocol '%s' because of unknown argument or return type.\n", pMethodDescription->name != NULL ? sel_getName( pMethodDescription->name ) : "", pProtocolName );
+            continue;
+        }
+
+        ++methodCount;
+    }
+
+    boolean8_t success = 0u;
+    c_ocoa_objc_class_name protocolName;
+    if( methodCount == 0u )
+    {
+        //FK: Nothing to implement (eg: marker protocols)
+    }
+    else if( !objc_make_protocol_member_names_unique( pMethods, methodCount, pStringAllocator, pProtocolName ) )
+    {
+        //FK: Error has been printed already
+    }
+    else if( objc_create_class_name( &protocolName, pProtocolName, string_get_length_incl_null_terminator( pProtocolName ) ) )
+    {
+        const char* pOutputPath = pParameter->pOutputPath == NULL ? "" : pParameter->pOutputPath;
+        const char* pFilePrefix = pParameter->pPrefix == NULL ? "" : pParameter->pPrefix;
+        const int32_t outputPathLength = string_get_length_excl_null_terminator( pOutputPath );
+        const int32_t filePrefixLength = string_get_length_excl_null_terminator( pFilePrefix );
+
+        //FK: '_protocol' suffix, protocols and classes may share the same name (eg: NSObject)
+        //    +9 for '_protocol' +2 for file extension (.c/.h) +1 for null terminator
+        char* pHeaderFileName = string_allocator_allocate( pStringAllocator, outputPathLength + filePrefixLength + protocolName.length + 9 + 2 + 1 );
+        char* pSourceFileName = string_allocator_allocate( pStringAllocator, outputPathLength + filePrefixLength + protocolName.length + 9 + 2 + 1 );
+
+        sprintf( pHeaderFileName, "%s%s%s_protocol.h", pOutputPath, pFilePrefix, protocolName.pNameLower );
+        sprintf( pSourceFileName, "%s%s%s_protocol.c", pOutputPath, pFilePrefix, protocolName.pNameLower );
+
+        FILE* pHeaderFileHandle = pParameter->fopen( pHeaderFileName, "w" );
+        FILE* pSourceFileHandle = pParameter->headerOnly ? pHeaderFileHandle : pParameter->fopen( pSourceFileName, "w" );
+        if( pHeaderFileHandle == NULL || pSourceFileHandle == NULL )
+        {
+            printf_stderr( "[error] Couldn't open '%s' for writing.\n", pHeaderFileHandle == NULL ? pHeaderFileName : pSourceFileName );
+            if( pHeaderFileHandle != NULL )
+            {
+                pParameter->fclose( pHeaderFileHandle );
+            }
+        }
+        else
+        {
+            file_write_c_protocol_header( pHeaderFileHandle, pParameter, &protocolName, pMethods, methodCount );
+            if( !pParameter->headerOnly )
+            {
+                file_write_generated_comment( pSourceFileHandle );
+                fprintf( pSourceFileHandle, "#include \"%s\"\n\n", pHeaderFileName );
+            }
+
+            file_write_c_protocol_descriptor( pSourceFileHandle, pParameter, &protocolName, pMethods, methodCount );
+            file_write_c_header_suffix( pHeaderFileHandle );
 
-        if( functionBaseNameLength == functionNameLength )
-        {
-            const char* pFunctionBaseName = pFunctionNameEntry->pFunctionName + functionCharSkipCount;
-            if( string_is_equal( pFunctionBaseName, pFunctionName, functionNameLength ) )
+            pParameter->fclose( pHeaderFileHandle );
+            if( !pParameter->headerOnly )
             {
-                return 1;
+                pParameter->fclose( pSourceFileHandle );
             }
+            success = 1u;
         }
+
+        free( protocolName.pName );
+        free( protocolName.pNameLower );
+        free( protocolName.pNameUpper );
     }
 
-    return 0;
+    free( pMethods );
+    free( pRequiredMethods );
+    free( pOptionalMethods );
+    return success;
 }
 
-void objc_function_collection_resize( c_ocoa_objc_function_collection* pFunctionCollection )
+void c_ocoa_create_protocols_api( const c_ocoa_code_generator_parameter* pCodeGeneratorParameter, c_ocoa_code_gen_context* pContext )
 {
-    const uint32_t newSize = pFunctionCollection->capacity * 2;
-    c_ocoa_objc_function_collection_entry* pNewEntries = ( c_ocoa_objc_function_collection_entry* )malloc( sizeof( c_ocoa_objc_function_collection_entry ) * newSize );
-    if( pNewEntries == NULL )
+    uint32_t protocolCount = 0u;
+    Protocol** ppProtocols = objc_copyProtocolList( &protocolCount );
+
+    for( uint32_t protocolIndex = 0u; protocolIndex < protocolCount; ++protocolIndex )
     {
-        //FK: TODO: Error handling
-        return;
+        c_ocoa_create_source_code_for_objc_protocol( pCodeGeneratorParameter, &pContext->typeDict, &pContext->stringAllocator, ppProtocols[ protocolIndex ] );
+        string_allocator_reset( &pContext->stringAllocator );
     }
 
-    memory_copy_non_overlapping( pNewEntries, pFunctionCollection->pEntries, pFunctionCollection->capacity * sizeof( c_ocoa_objc_function_collection_entry ) );
-    pFunctionCollection->capacity = newSize;
-
-    free( pFunctionCollection->pEntries );
-    pFunctionCollection->pEntries = pNewEntries;
+    free( ppProtocols );
 }
 
-void objc_function_collection_add( c_ocoa_objc_function_collection* pFunctionCollection, const char* pFunctionName, const int32_t functionNameLength )
+const char* objc_find_return_kind( const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
 {
-    const boolean8_t isFunctionCollectionFull = pFunctionCollection->capacity == pFunctionCollection->size;
-    if( isFunctionCollectionFull )
+    if( pFunctionResolveResult->isVoidFunction )
     {
-        objc_function_collection_resize( pFunctionCollection );
+        return "C_OCOA_RETURN_KIND_VOID";
     }
-
-    const uint32_t entryIndex = pFunctionCollection->size;
-    pFunctionCollection->size++;
-
-    pFunctionCollection->pEntries[ entryIndex ].pFunctionName       = pFunctionName;
-    pFunctionCollection->pEntries[ entryIndex ].functionNameLength  = functionNameLength;
-}
-
-c_ocoa_convert_result objc_parse_result_convert_to_function_definition( c_ocoa_string_allocator* pStringAllocator, c_ocoa_objc_function_resolve_result* pOutFunctionResolveResult, c_ocoa_objc_function_collection* pFunctionCollection, c_ocoa_objc_type_dictionary* pDict, c_ocoa_parse_result* pParseResult, const c_ocoa_objc_class_name* pClassName )
-{
-    if( !function_name_is_valid( pParseResult->pFunctionName ) )
+    else if( pFunctionResolveResult->hasStructReturnValue )
     {
-        //FK: Add log here?
-        return ConvertResult_InvalidFunctionName;
+        return "C_OCOA_RETURN_KIND_STRUCT";
     }
-
-    int32_t functionNameLength = pParseResult->functionNameLength;
-    const char* pFunctionNameColonPosition = string_find_next_char_position( pParseResult->pFunctionName, ':' );
-    if( pFunctionNameColonPosition != NULL )
+    else if( pFunctionResolveResult->hasFloatReturnValue )
     {
-        functionNameLength = cast_size_to_int32( pFunctionNameColonPosition - pParseResult->pFunctionName );
+        return "C_OCOA_RETURN_KIND_FLOAT";
     }
 
-    if( objc_function_collection_contains_function( pFunctionCollection, pClassName, pParseResult->pFunctionName, functionNameLength ) )
+    const char* pReturnType = pFunctionResolveResult->pOriginalReturnType;
+    while( objc_is_method_type_qualifier( *pReturnType ) || *pReturnType == 'r' )
     {
-        return ConvertResult_AlreadyKnown;
+        ++pReturnType;
     }
 
-    const int32_t resolvedFunctionNameLength = functionNameLength + pClassName->length;
-    char* pResolvedFunctionName = (char*)malloc( resolvedFunctionNameLength + 1u );
-    if( pResolvedFunctionName == NULL )
+    switch( *pReturnType )
     {
-        return ConvertResult_OutOfMemory;
+        case '@':
+        case '#':
+            return "C_OCOA_RETURN_KIND_OBJECT";
+        case '^':
+        case '*':
+        case ':':
+            return "C_OCOA_RETURN_KIND_POINTER";
+        default:
+            return "C_OCOA_RETURN_KIND_INTEGER";
     }
+}
 
-    sprintf( pResolvedFunctionName, "%s_%.*s", pClassName->pNameLower, functionNameLength, pParseResult->pFunctionName );
-
-    //FK: Will take ownership of pResolvedFunctionName
-    objc_function_collection_add( pFunctionCollection, pResolvedFunctionName, resolvedFunctionNameLength );
-
-    c_ocoa_objc_function_resolve_result resolveResult = {};
-    resolveResult.pOriginalReturnType          = string_allocate_copy_with_allocator( pStringAllocator, pParseResult->pReturnType, pParseResult->returnTypeLength );
-    resolveResult.pOriginalArgumentTypes       = string_allocate_copy_with_allocator( pStringAllocator, pParseResult->pArguments, pParseResult->argumentLength );
-    resolveResult.pOriginalFunctionName        = string_allocate_copy_with_allocator( pStringAllocator, pParseResult->pFunctionName, pParseResult->functionNameLength );
-    resolveResult.pResolvedFunctionName        = pResolvedFunctionName;
-
-    c_ocoa_objc_type_resolve_result returnTypeResolveResult = {};
-    if( !objc_resolve_c_type_name( &returnTypeResolveResult, pDict, pParseResult->pReturnType, pParseResult->returnTypeLength ) )
+void registry_builder_add( c_ocoa_registry_builder* pRegistryBuilder, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
+{
+    if( pRegistryBuilder->size == pRegistryBuilder->capacity )
     {
-        printf_stderr( "[error] Couldn't resolve return type '%.*s' of function '%s'.\n", pParseResult->returnTypeLength, pParseResult->pReturnType, resolveResult.pResolvedFunctionName );
-        return ConvertResult_UnknownReturnType;
+        const uint32_t newCapacity = pRegistryBuilder->capacity == 0u ? 64u : pRegistryBuilder->capacity * 2u;
+        c_ocoa_registry_builder_entry* pNewEntries = (c_ocoa_registry_builder_entry*)realloc( pRegistryBuilder->pEntries, sizeof( c_ocoa_registry_builder_entry ) * newCapacity );
+        if( pNewEntries == NULL )
+        {
+            printf_stderr( "[error] Out of memory - Couldn't add '%s' to the registry.\n", pFunctionResolveResult->pResolvedFunctionName );
+            return;
+        }
+
+        pRegistryBuilder->pEntries = pNewEntries;
+        pRegistryBuilder->capacity = newCapacity;
     }
 
-    resolveResult.pResolvedReturnType = returnTypeResolveResult.pResolvedType;
-    resolveResult.pClassName          = pClassName;
+    //FK: The resolve result lives in the string allocator which gets reset after every method, so copy what we need
+    const c_ocoa_objc_class_name* pClassName = pFunctionResolveResult->pClassName;
+    const char* pName = pFunctionResolveResult->pResolvedFunctionName + string_get_length_excl_null_terminator( pClassName->pNameLower ) + 1;
 
-    const char* pArguments = pParseResult->pArguments;
-    uint8_t argumentCount = 0u;
-    const uint8_t maxArgumentCount = array_count( resolveResult.pResolvedArgumentTypes );
-    const uint8_t argumentsToSkip = 2; //FK: Skip first two arguments since these are always the object + the selector.
+    c_ocoa_registry_builder_entry* pEntry = pRegistryBuilder->pEntries + pRegistryBuilder->size;
+    pEntry->pName           = string_allocate_copy( pName, string_get_length_excl_null_terminator( pName ) );
+    pEntry->pSelectorName   = string_allocate_copy( pFunctionResolveResult->pOriginalFunctionName, string_get_length_excl_null_terminator( pFunctionResolveResult->pOriginalFunctionName ) );
+    pEntry->pReturnKind     = objc_find_return_kind( pFunctionResolveResult );
+    pEntry->argumentCount   = pFunctionResolveResult->argumentCount;
+    pEntry->isClassMethod   = pFunctionResolveResult->methodType == MethodType_Class;
 
-    while( *pArguments )
+    if( pEntry->pName == NULL || pEntry->pSelectorName == NULL )
     {
-        const char* pArgumentStart = pArguments;
-        const char* pArgumentEnd = whitespace_find_next( pArgumentStart );
-        const int32_t argumentLength = cast_size_to_int32( pArgumentEnd - pArgumentStart );
+        free( pEntry->pName );
+        free( pEntry->pSelectorName );
+        return;
+    }
 
-        if( argumentCount >= argumentsToSkip )
+    //FK: Skip object + selector, store the first character of every argument type (after qualifiers)
+    const char* pArguments = pFunctionResolveResult->pOriginalArgumentTypes;
+    uint8_t argumentIndex = 0u;
+    uint8_t typeCount = 0u;
+    while( *pArguments && typeCount < pEntry->argumentCount )
+    {
+        const char* pArgumentEnd = whitespace_find_next( pArguments );
+        if( argumentIndex >= 2u )
         {
-            const uint8_t argumentIndex = argumentCount - argumentsToSkip;
-            assert_runtime( argumentIndex < maxArgumentCount );
-
-            c_ocoa_objc_type_resolve_result argumentResolveResult = {};
-            if( !objc_resolve_c_type_name( &argumentResolveResult, pDict, pArgumentStart, argumentLength ) )
+            const char* pType = pArguments;
+            while( pType < pArgumentEnd - 1 && ( objc_is_method_type_qualifier( *pType ) || *pType == 'r' ) )
             {
-                printf_stderr( "[error] Couldn't resolve %d. argument type name '%.*s' of function '%s'.\n", argumentCount, argumentLength, pArgumentStart, resolveResult.pResolvedFunctionName );
-                return ConvertResult_UnknownArgumentType;
+                ++pType;
             }
 
-            resolveResult.pResolvedArgumentTypes[ argumentIndex ] = argumentResolveResult.pResolvedType;
+            pEntry->argumentTypes[ typeCount++ ] = *pType;
         }
 
-        ++argumentCount;
+        ++argumentIndex;
         if( *pArgumentEnd == 0 )
         {
             break;
@@ -1868,175 +6775,197 @@ c_ocoa_convert_result objc_parse_result_convert_to_function_definition( c_ocoa_s
 
         pArguments = pArgumentEnd + 1;
     }
+    pEntry->argumentTypes[ typeCount ] = 0;
 
-    resolveResult.argumentCount         = argumentCount < argumentsToSkip ? 0 : argumentCount - argumentsToSkip;
-    resolveResult.isVoidFunction        = !returnTypeResolveResult.isReference && string_is_equal( resolveResult.pResolvedReturnType, "void", 5u );
-    resolveResult.isAllocFunction       = strcmp( resolveResult.pOriginalFunctionName, "alloc" ) == 0u;
-    resolveResult.hasStructReturnValue  = !returnTypeResolveResult.isReference && !returnTypeResolveResult.isBaseType;
-    resolveResult.returnValueSizeInBits = returnTypeResolveResult.typeSizeInBits;
-    resolveResult.hasFloatReturnValue   = returnTypeResolveResult.isFloatingType;
-    resolveResult.methodType            = pParseResult->c_ocoa_method_type;
+    ++pRegistryBuilder->size;
+}
 
-    *pOutFunctionResolveResult = resolveResult;
+void registry_builder_free( c_ocoa_registry_builder* pRegistryBuilder )
+{
+    for( uint32_t entryIndex = 0u; entryIndex < pRegistryBuilder->size; ++entryIndex )
+    {
+        free( pRegistryBuilder->pEntries[ entryIndex ].pName );
+        free( pRegistryBuilder->pEntries[ entryIndex ].pSelectorName );
+    }
 
-    return ConvertResult_Success;
+    free( pRegistryBuilder->pEntries );
+    pRegistryBuilder->pEntries  = NULL;
+    pRegistryBuilder->size      = 0u;
+    pRegistryBuilder->capacity  = 0u;
 }
 
-void cfunction_write_signature( FILE* pResultFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
+//FK: Has to match c_ocoa_registry_hash() of the generated runtime header
+uint32_t registry_hash( const char* pName, size_t nameLength, uint32_t seed )
 {
-    //FK: Function name
-    fprintf( pResultFileHandle, "%s(", pFunctionDefinition->pResolvedFunctionName );
-
-    //FK: Special handling for init functions - don't pass class object (will be passed internally for better API usage)
-    if( pFunctionDefinition->methodType == MethodType_Instance && !pFunctionDefinition->isAllocFunction)
+    uint32_t hash = 2166136261u ^ seed;
+    for( size_t charIndex = 0u; charIndex < nameLength; ++charIndex )
     {
-        //FK: add object as first parameter instance methods
-        fprintf( pResultFileHandle, " %s_t object", pFunctionDefinition->pClassName->pNameLower );
-
-        for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionDefinition->argumentCount; ++argumentIndex )
-        {
-            fprintf( pResultFileHandle, ", %s arg%u", pFunctionDefinition->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
-        }
+        hash ^= (uint8_t)pName[ charIndex ];
+        hash *= 16777619u;
     }
-    else
+
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+//FK: 'Hash, displace' minimal perfect hash. Names get distributed into buckets by their unseeded hash,
+//    then - starting with the biggest bucket - a seed gets searched per bucket that maps all names of
+//    the bucket to free slots. pOutSlotEntries receives the builder entry index of every slot.
+boolean8_t registry_builder_find_perfect_hash( const c_ocoa_registry_builder* pRegistryBuilder, uint32_t bucketCount, uint32_t* pOutSeeds, uint32_t* pOutSlotEntries )
+{
+    const uint32_t entryCount = pRegistryBuilder->size;
+    uint32_t* pEntryBuckets = (uint32_t*)malloc( sizeof( uint32_t ) * entryCount );
+    uint32_t* pBucketSizes = (uint32_t*)calloc( bucketCount, sizeof( uint32_t ) );
+    uint32_t* pBucketOrder = (uint32_t*)malloc( sizeof( uint32_t ) * bucketCount );
+    uint32_t* pBucketSlots = (uint32_t*)malloc( sizeof( uint32_t ) * entryCount );
+    boolean8_t* pSlotTaken = (boolean8_t*)calloc( entryCount, sizeof( boolean8_t ) );
+
+    boolean8_t success = pEntryBuckets != NULL && pBucketSizes != NULL && pBucketOrder != NULL && pBucketSlots != NULL && pSlotTaken != NULL;
+    if( success )
     {
-        if( pFunctionDefinition->argumentCount > 0u )
+        for( uint32_t entryIndex = 0u; entryIndex < entryCount; ++entryIndex )
         {
-            fprintf( pResultFileHandle, " %s arg%u", pFunctionDefinition->pResolvedArgumentTypes[ 0 ], 0 );
+            const char* pName = pRegistryBuilder->pEntries[ entryIndex ].pName;
+            pEntryBuckets[ entryIndex ] = registry_hash( pName, strlen( pName ), 0u ) % bucketCount;
+            ++pBucketSizes[ pEntryBuckets[ entryIndex ] ];
+        }
 
-            for( uint8_t argumentIndex = 1u; argumentIndex < pFunctionDefinition->argumentCount; ++argumentIndex )
-            {   
-                fprintf( pResultFileHandle, ", %s arg%u", pFunctionDefinition->pResolvedArgumentTypes[ argumentIndex ], argumentIndex );
+        //FK: Insertion sort by bucket size (descending), bucket counts are small
+        for( uint32_t bucketIndex = 0u; bucketIndex < bucketCount; ++bucketIndex )
+        {
+            uint32_t insertIndex = bucketIndex;
+            while( insertIndex > 0u && pBucketSizes[ pBucketOrder[ insertIndex - 1u ] ] < pBucketSizes[ bucketIndex ] )
+            {
+                pBucketOrder[ insertIndex ] = pBucketOrder[ insertIndex - 1u ];
+                --insertIndex;
             }
+            pBucketOrder[ insertIndex ] = bucketIndex;
         }
     }
 
-    fprintf( pResultFileHandle, " )");
-}
-
-void cfunction_write_declaration( FILE* pResultFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionDefinition )
-{   
-    //FK: "guess" maximum tab count for nice formatting
-    //    getting the correct tab count for the longest
-    //    return type name would be too involved since
-    //    we currently run on a function by function basis
-    //    and thus don't know the maximum type name length
-    //    beforehand
-    const int32_t maxTabCount = 5u;
-    int32_t returnTypeLength = 0u;
+    const uint32_t maxSeed = 1u << 24u;
+    for( uint32_t orderIndex = 0u; success && orderIndex < bucketCount; ++orderIndex )
+    {
+        const uint32_t bucketIndex = pBucketOrder[ orderIndex ];
+        pOutSeeds[ bucketIndex ] = 0u;
+        if( pBucketSizes[ bucketIndex ] == 0u )
+        {
+            continue;
+        }
 
-    fprintf(pResultFileHandle, "// Signature from Objective-C Runtime: %s %s %s\n", pFunctionDefinition->pOriginalReturnType, pFunctionDefinition->pOriginalFunctionName, pFunctionDefinition->pOriginalArgumentTypes );
+        boolean8_t foundSeed = 0;
+        for( uint32_t seed = 1u; seed < maxSeed && !foundSeed; ++seed )
+        {
+            uint32_t slotCount = 0u;
+            foundSeed = 1;
+            for( uint32_t entryIndex = 0u; entryIndex < entryCount && foundSeed; ++entryIndex )
+            {
+                if( pEntryBuckets[ entryIndex ] != bucketIndex )
+                {
+                    continue;
+                }
 
-    if( pFunctionDefinition->isAllocFunction )
-    {
-        //FK: little syntactic sugar, return correct type for init function(s)
-        returnTypeLength = fprintf( pResultFileHandle, "%s_t ", pFunctionDefinition->pClassName->pNameLower );
-    }
-    else
-    {
-        returnTypeLength = fprintf( pResultFileHandle, "%s ", pFunctionDefinition->pResolvedReturnType );
-    }
+                const char* pName = pRegistryBuilder->pEntries[ entryIndex ].pName;
+                const uint32_t slot = registry_hash( pName, strlen( pName ), seed ) % entryCount;
+                foundSeed = !pSlotTaken[ slot ];
+                for( uint32_t slotIndex = 0u; slotIndex < slotCount && foundSeed; ++slotIndex )
+                {
+                    foundSeed = pBucketSlots[ slotIndex ] != slot;
+                }
 
-    const int32_t spacesForTab = 4u;
-    const int32_t tabCountForReturnType = get_max( 0u, maxTabCount - ( returnTypeLength / spacesForTab ) );
-    for( int32_t tabIndex = 0u; tabIndex < tabCountForReturnType; ++tabIndex )
-    {
-        fprintf( pResultFileHandle, "\t" );
-    }
+                pBucketSlots[ slotCount++ ] = slot;
+            }
 
-    cfunction_write_signature( pResultFileHandle, pFunctionDefinition );
+            if( foundSeed )
+            {
+                pOutSeeds[ bucketIndex ] = seed;
+            }
+        }
 
-    fprintf( pResultFileHandle, ";\n\n" );
-    fflush( pResultFileHandle );
-}
+        if( !foundSeed )
+        {
+            success = 0;
+            break;
+        }
 
-const char* objc_find_msgsend_call( const c_ocoa_objc_function_resolve_result* pFunctionResolveResult )
-{
-    //FK: This is sort of handwavy after some trial & error
-    if( pFunctionResolveResult->hasFloatReturnValue )
-    {
-        return "abi_objc_msgSend_fpret";
-    }
-    if( pFunctionResolveResult->hasStructReturnValue && pFunctionResolveResult->returnValueSizeInBits > 128 )
-    {
-        return "abi_objc_msgSend_stret";
+        uint32_t slotIndex = 0u;
+        for( uint32_t entryIndex = 0u; entryIndex < entryCount; ++entryIndex )
+        {
+            if( pEntryBuckets[ entryIndex ] == bucketIndex )
+            {
+                const uint32_t slot = pBucketSlots[ slotIndex++ ];
+                pSlotTaken[ slot ] = 1;
+                pOutSlotEntries[ slot ] = entryIndex;
+            }
+        }
     }
 
-    return "objc_msgSend";
+    free( pEntryBuckets );
+    free( pBucketSizes );
+    free( pBucketOrder );
+    free( pBucketSlots );
+    free( pSlotTaken );
+    return success;
 }
 
-void file_write_c_function_implementation( FILE* pSourceFileHandle, const c_ocoa_objc_function_resolve_result* pFunctionResolveResult, const c_ocoa_objc_class_name* pClassName )
-{   
-    size_t returnTypeLength = 0u;
-    if( pFunctionResolveResult->isAllocFunction )
-    {
-        //FK: little syntactic sugar, return correct type for init function(s)
-        returnTypeLength = fprintf( pSourceFileHandle, "%s_t ", pClassName->pNameLower );
-    }
-    else
-    {
-        returnTypeLength = fprintf( pSourceFileHandle, "%s ", pFunctionResolveResult->pResolvedReturnType );
-    }
-
-    cfunction_write_signature( pSourceFileHandle, pFunctionResolveResult );
+void file_write_c_registry( const c_ocoa_source_code_generator_input* pInput )
+{
+    const c_ocoa_registry_builder* pRegistryBuilder = pInput->pRegistryBuilder;
+    const char* pLinkage = cfunction_get_linkage( pInput->pParameter );
+    const char* pClassNameLower = pInput->pClassName->pNameLower;
+    FILE* pSourceFileHandle = pInput->pSourceFileHandle;
 
-    fprintf( pSourceFileHandle, "\n{\n" );
+    fprintf( pInput->pHeaderFileHandle, "// Name -> wrapper table of all wrappers above, see c_ocoa_registry_find()\n" );
+    fprintf( pInput->pHeaderFileHandle, "%sconst c_ocoa_registry_t* \t%s_registry( void );\n\n", pLinkage, pClassNameLower );
 
-    fprintf( pSourceFileHandle, "\tSEL methodSelector = sel_registerName( \"%s\" );\n", pFunctionResolveResult->pOriginalFunctionName );
+    const uint32_t entryCount = pRegistryBuilder->size;
+    const uint32_t bucketCount = entryCount / 2u + 1u;
+    uint32_t* pSeeds = (uint32_t*)malloc( sizeof( uint32_t ) * bucketCount );
+    uint32_t* pSlotEntries = (uint32_t*)malloc( sizeof( uint32_t ) * ( entryCount + 1u ) );
 
-    if( pFunctionResolveResult->methodType == MethodType_Class )
+    boolean8_t hasTable = entryCount > 0u;
+    if( hasTable && ( pSeeds == NULL || pSlotEntries == NULL || !registry_builder_find_perfect_hash( pRegistryBuilder, bucketCount, pSeeds, pSlotEntries ) ) )
     {
-        fprintf( pSourceFileHandle, "\tClass internalClassObject = objc_getClass( \"%s\" );\n", pClassName->pName );
+        printf_stderr( "[error] Couldn't build the registry of class '%s', the registry will be empty.\n", pInput->pClassName->pName );
+        hasTable = 0;
     }
 
-    fprintf( pSourceFileHandle, "\t#define %s_call( obj, selector", pFunctionResolveResult->pResolvedFunctionName );
-    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
+    if( hasTable )
     {
-        fprintf( pSourceFileHandle, ", arg%hhu", argumentIndex );
-    }
+        fprintf( pSourceFileHandle, "static const c_ocoa_registry_entry_t %s_registry_entries[] =\n{\n", pClassNameLower );
+        for( uint32_t slotIndex = 0u; slotIndex < entryCount; ++slotIndex )
+        {
+            const c_ocoa_registry_builder_entry* pEntry = pRegistryBuilder->pEntries + pSlotEntries[ slotIndex ];
+            fprintf( pSourceFileHandle, "\t{ \"%s\", \"%s\", (c_ocoa_wrapper_fn)%s_%s, \"%s\", %uu, %uu, %s, %uu },\n",
+                pEntry->pName, pEntry->pSelectorName, pClassNameLower, pEntry->pName, pEntry->argumentTypes,
+                string_get_length_excl_null_terminator( pEntry->pName ), pEntry->argumentCount, pEntry->pReturnKind, pEntry->isClassMethod );
+        }
+        fprintf( pSourceFileHandle, "};\n\n" );
 
-    fprintf( pSourceFileHandle, " ) ((%s (*)( id, SEL", pFunctionResolveResult->pResolvedReturnType );
-    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
-    {
-        const char* pArgumentType = pFunctionResolveResult->pResolvedArgumentTypes[ argumentIndex ];
-        fprintf( pSourceFileHandle, ", %s", pArgumentType );
-    }
+        fprintf( pSourceFileHandle, "static const uint32_t %s_registry_seeds[] =\n{", pClassNameLower );
+        for( uint32_t bucketIndex = 0u; bucketIndex < bucketCount; ++bucketIndex )
+        {
+            fprintf( pSourceFileHandle, "%s%uu,", bucketIndex % 16u == 0u ? "\n\t" : " ", pSeeds[ bucketIndex ] );
+        }
+        fprintf( pSourceFileHandle, "\n};\n\n" );
 
-    const char* msgSendCall = objc_find_msgsend_call( pFunctionResolveResult );
-    fprintf( pSourceFileHandle, " ))%s) ( obj, selector", msgSendCall );
-    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
-    {
-        fprintf( pSourceFileHandle, ", arg%hhu", argumentIndex );
+        fprintf( pSourceFileHandle, "static const c_ocoa_registry_t %s_registry_table = { \"%s\", %s_registry_entries, %s_registry_seeds, %uu, %uu };\n\n",
+            pClassNameLower, pInput->pClassName->pName, pClassNameLower, pClassNameLower, entryCount, bucketCount );
     }
-    fprintf( pSourceFileHandle, " )\n");
-
-    fprintf( pSourceFileHandle, "\t" );
-    const boolean8_t hasReturnValue = !pFunctionResolveResult->isVoidFunction;
-    if( hasReturnValue )
+    else
     {
-        fprintf( pSourceFileHandle, "return " );
+        fprintf( pSourceFileHandle, "static const c_ocoa_registry_t %s_registry_table = { \"%s\", NULL, NULL, 0u, 0u };\n\n", pClassNameLower, pInput->pClassName->pName );
     }
 
-    switch( pFunctionResolveResult->methodType )
-    {
-        case MethodType_Class:
-            fprintf( pSourceFileHandle, "%s_call( (id)internalClassObject, methodSelector", pFunctionResolveResult->pResolvedFunctionName );
-            break;
-
-        case MethodType_Instance:
-            fprintf( pSourceFileHandle, "%s_call( (id)object, methodSelector", pFunctionResolveResult->pResolvedFunctionName );
-            break;
-    }
+    fprintf( pSourceFileHandle, "%sconst c_ocoa_registry_t* %s_registry( void )\n", pLinkage, pClassNameLower );
+    fprintf( pSourceFileHandle, "{\n" );
+    fprintf( pSourceFileHandle, "\treturn &%s_registry_table;\n", pClassNameLower );
+    fprintf( pSourceFileHandle, "}\n\n" );
 
-    for( uint8_t argumentIndex = 0u; argumentIndex < pFunctionResolveResult->argumentCount; ++argumentIndex )
-    {
-        fprintf( pSourceFileHandle, ", arg%hhu", argumentIndex );
-    }
-    fprintf( pSourceFileHandle, " );\n" );
-    fprintf( pSourceFileHandle, "\t#undef %s_call\n", pFunctionResolveResult->pResolvedFunctionName );
-    fprintf( pSourceFileHandle, "}\n\n");
-    
-    fflush( pSourceFileHandle );
+    free( pSeeds );
+    free( pSlotEntries );
 }
 
 boolean8_t objc_create_class_name( c_ocoa_objc_class_name* pOutClassName, const char* pClassNameStart, const int32_t classNameLength )
@@ -2045,6 +6974,7 @@ boolean8_t objc_create_class_name( c_ocoa_objc_class_name* pOutClassName, const
     pOutClassName->pName        = string_allocate_copy( pClassNameStart, classNameLength );
     pOutClassName->pNameLower   = string_allocate_copy_lower( pClassNameStart, classNameLength );
     pOutClassName->pNameUpper   = string_allocator_copy_upper( pClassNameStart, classNameLength );
+    pOutClassName->pFrameworkIdentifier = NULL;
 
     if( pOutClassName->pName == NULL || pOutClassName->pNameLower == NULL || pOutClassName->pNameUpper == NULL )
     {
@@ -2234,6 +7164,10 @@ boolean8_t c_ocoa_create_code_gen_context( c_ocoa_code_gen_context* pCodeGenCont
         return 0;
     }
 
+    pCodeGenContext->frameworkCollection.pEntries = NULL;
+    pCodeGenContext->frameworkCollection.size     = 0u;
+    pCodeGenContext->frameworkCollection.capacity = 0u;
+
     const size_t stringAllocatorSizeInBytes = 1024*1024; //FK: 1 MiB, quite a lot for a string allocator but better be safe than sorry
     if( !string_allocator_create( &pCodeGenContext->stringAllocator, stringAllocatorSizeInBytes ) )
     {
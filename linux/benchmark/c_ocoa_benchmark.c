@@ -0,0 +1,675 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <objc/runtime.h>
+#include <objc/message.h>
+
+#include "c_ocoa_benchmark_classes.h"
+
+//FK: Generated by linux/build_benchmark.sh
+#include "c_ocoa_runtime.c"
+#include "cocoabenchdefault.c"
+#include "cocoabenchimpcache.c"
+#include "cocoabenchcollection.c"
+#include "cocoabenchinline.h"
+#include "cocoabenchmainqueue.c"
+#include "cocoabenchdelegate_protocol.c"
+
+#define C_OCOA_BENCHMARK_DEFAULT_ITERATION_COUNT    10000000u
+#define C_OCOA_BENCHMARK_RUN_COUNT                  3u      //FK: fastest run is reported
+#define C_OCOA_BENCHMARK_BATCH_SIZE                 64u
+#define C_OCOA_BENCHMARK_MAX_RESULT_COUNT           96u
+#define C_OCOA_BENCHMARK_PRODUCER_COUNT             4u      //FK: worker threads that send calls to the main thread
+#define C_OCOA_BENCHMARK_MAIN_THREAD_CALL_DIVISOR   16u     //FK: performSelectorOnMainThread: is too slow for the full call count
+#define C_OCOA_BENCHMARK_DELEGATE_CLASS_COUNT       100u    //FK: delegate classes that get defined per run (startup cost)
+#define C_OCOA_BENCHMARK_AUTORELEASE_OBJECT_COUNT   1000000u
+#define C_OCOA_BENCHMARK_AUTORELEASE_OBJECT_SIZE    64u     //FK: extra bytes per autoreleased object so that leaks show up in the RSS
+
+//FK: Set by linux/build_benchmark.sh (git revision) so that results can be tracked across releases
+#ifndef C_OCOA_BENCHMARK_REVISION
+#define C_OCOA_BENCHMARK_REVISION "unknown"
+#endif
+
+typedef void(*c_ocoa_benchmark_fn)( const c_ocoa_benchmark_classes* pClasses, uint64_t iterationCount );
+
+typedef struct
+{
+    const char*         pShape;
+    const char*         pVariant;
+    c_ocoa_benchmark_fn function;
+    uint64_t            callsPerIteration;  //FK: eg: batch size for the batched variants
+} c_ocoa_benchmark_case;
+
+typedef struct
+{
+    const char* pShape;
+    const char* pVariant;
+    double      value;
+    const char* pUnit;      //FK: eg: 'ns/call'
+} c_ocoa_benchmark_result;
+
+typedef struct
+{
+    id          pObject;
+    SEL         pSelector;      //FK: only used by the performSelectorOnMainThread: variant
+    uint64_t    callCount;
+} c_ocoa_benchmark_producer_input;
+
+//FK: All results get written here so that the compiler can't remove the calls
+static volatile double c_ocoa_benchmark_sink = 0.0;
+
+static SEL c_ocoa_benchmark_void_selector           = NULL;
+static SEL c_ocoa_benchmark_scalar_selector         = NULL;
+static SEL c_ocoa_benchmark_float_selector          = NULL;
+static SEL c_ocoa_benchmark_small_struct_selector   = NULL;
+static SEL c_ocoa_benchmark_large_struct_selector   = NULL;
+
+static IMP c_ocoa_benchmark_void_imp                = NULL;
+static IMP c_ocoa_benchmark_scalar_imp              = NULL;
+static IMP c_ocoa_benchmark_float_imp               = NULL;
+static IMP c_ocoa_benchmark_small_struct_imp        = NULL;
+static IMP c_ocoa_benchmark_large_struct_imp        = NULL;
+
+static nsobject_t c_ocoa_benchmark_batch_receivers[ C_OCOA_BENCHMARK_BATCH_SIZE ];
+static int        c_ocoa_benchmark_batch_scalar_arguments[ C_OCOA_BENCHMARK_BATCH_SIZE ];
+static int        c_ocoa_benchmark_batch_scalar_results[ C_OCOA_BENCHMARK_BATCH_SIZE ];
+
+static uint32_t c_ocoa_benchmark_delegate_class_index = 0u;  //FK: classes can't be unregistered, every run needs new names
+
+static uint64_t c_ocoa_benchmark_get_time_in_nanoseconds( void )
+{
+    struct timespec time;
+    clock_gettime( CLOCK_MONOTONIC, &time );
+    return (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;
+}
+
+#define C_OCOA_BENCHMARK_DEFINE( name, body ) \
+    static void name( const c_ocoa_benchmark_classes* pClasses, uint64_t iterationCount ) \
+    { \
+        for( uint64_t iterationIndex = 0u; iterationIndex < iterationCount; ++iterationIndex ) \
+        { \
+            body; \
+        } \
+    }
+
+//FK: Lower bound, calls the method implementation directly (no dispatch at all)
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_void_imp_call,            ((void(*)( id, SEL ))c_ocoa_benchmark_void_imp)( pClasses->defaultInstance.pObject, c_ocoa_benchmark_void_selector ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_scalar_imp_call,          c_ocoa_benchmark_sink += ((int(*)( id, SEL, int ))c_ocoa_benchmark_scalar_imp)( pClasses->defaultInstance.pObject, c_ocoa_benchmark_scalar_selector, (int)iterationIndex ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_float_imp_call,           c_ocoa_benchmark_sink += ((double(*)( id, SEL, double ))c_ocoa_benchmark_float_imp)( pClasses->defaultInstance.pObject, c_ocoa_benchmark_float_selector, (double)iterationIndex ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_small_struct_imp_call,    c_ocoa_benchmark_sink += ((BenchSmallStruct(*)( id, SEL ))c_ocoa_benchmark_small_struct_imp)( pClasses->defaultInstance.pObject, c_ocoa_benchmark_small_struct_selector ).member0 )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_large_struct_imp_call,    c_ocoa_benchmark_sink += ((BenchLargeStruct(*)( id, SEL ))c_ocoa_benchmark_large_struct_imp)( pClasses->defaultInstance.pObject, c_ocoa_benchmark_large_struct_selector ).member0 )
+
+//FK: Hand written objc_msgSend cast with a cached selector, what the wrappers should compete against
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_void_msgsend,             ((void(*)( id, SEL ))objc_msgSend)( pClasses->defaultInstance.pObject, c_ocoa_benchmark_void_selector ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_scalar_msgsend,           c_ocoa_benchmark_sink += ((int(*)( id, SEL, int ))objc_msgSend)( pClasses->defaultInstance.pObject, c_ocoa_benchmark_scalar_selector, (int)iterationIndex ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_float_msgsend,            c_ocoa_benchmark_sink += ((double(*)( id, SEL, double ))abi_objc_msgSend_fpret)( pClasses->defaultInstance.pObject, c_ocoa_benchmark_float_selector, (double)iterationIndex ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_small_struct_msgsend,     c_ocoa_benchmark_sink += ((BenchSmallStruct(*)( id, SEL ))objc_msgSend)( pClasses->defaultInstance.pObject, c_ocoa_benchmark_small_struct_selector ).member0 )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_large_struct_msgsend,     c_ocoa_benchmark_sink += ((BenchLargeStruct(*)( id, SEL ))abi_objc_msgSend_stret)( pClasses->defaultInstance.pObject, c_ocoa_benchmark_large_struct_selector ).member0 )
+
+//FK: Generated wrappers (default options)
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_void_wrapper,             cocoabenchdefault_voidCall( pClasses->defaultInstance.pObject ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_scalar_wrapper,           c_ocoa_benchmark_sink += cocoabenchdefault_scalarCall( pClasses->defaultInstance.pObject, (int)iterationIndex ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_float_wrapper,            c_ocoa_benchmark_sink += cocoabenchdefault_floatCall( pClasses->defaultInstance.pObject, (double)iterationIndex ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_small_struct_wrapper,     c_ocoa_benchmark_sink += cocoabenchdefault_smallStructCall( pClasses->defaultInstance.pObject ).member0 )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_large_struct_wrapper,     c_ocoa_benchmark_sink += cocoabenchdefault_largeStructCall( pClasses->defaultInstance.pObject ).member0 )
+
+//FK: Generated wrappers (-i)
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_void_imp_cache,           cocoabenchimpcache_voidCall( pClasses->impCacheInstance.pObject ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_scalar_imp_cache,         c_ocoa_benchmark_sink += cocoabenchimpcache_scalarCall( pClasses->impCacheInstance.pObject, (int)iterationIndex ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_float_imp_cache,          c_ocoa_benchmark_sink += cocoabenchimpcache_floatCall( pClasses->impCacheInstance.pObject, (double)iterationIndex ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_small_struct_imp_cache,   c_ocoa_benchmark_sink += cocoabenchimpcache_smallStructCall( pClasses->impCacheInstance.pObject ).member0 )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_large_struct_imp_cache,   c_ocoa_benchmark_sink += cocoabenchimpcache_largeStructCall( pClasses->impCacheInstance.pObject ).member0 )
+
+//FK: Generated wrappers (--header-only)
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_void_inline,              cocoabenchinline_voidCall( pClasses->inlineInstance.pObject ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_scalar_inline,            c_ocoa_benchmark_sink += cocoabenchinline_scalarCall( pClasses->inlineInstance.pObject, (int)iterationIndex ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_float_inline,             c_ocoa_benchmark_sink += cocoabenchinline_floatCall( pClasses->inlineInstance.pObject, (double)iterationIndex ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_small_struct_inline,      c_ocoa_benchmark_sink += cocoabenchinline_smallStructCall( pClasses->inlineInstance.pObject ).member0 )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_large_struct_inline,      c_ocoa_benchmark_sink += cocoabenchinline_largeStructCall( pClasses->inlineInstance.pObject ).member0 )
+
+//FK: Generated batch variants (-i -b), one iteration = C_OCOA_BENCHMARK_BATCH_SIZE calls
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_void_batch,               (void)pClasses; cocoabenchimpcache_voidCall_batch( c_ocoa_benchmark_batch_receivers, C_OCOA_BENCHMARK_BATCH_SIZE ) )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_scalar_batch,             (void)pClasses; cocoabenchimpcache_scalarCall_batch( c_ocoa_benchmark_batch_receivers, C_OCOA_BENCHMARK_BATCH_SIZE, c_ocoa_benchmark_batch_scalar_arguments, c_ocoa_benchmark_batch_scalar_results ); c_ocoa_benchmark_sink += c_ocoa_benchmark_batch_scalar_results[ 0 ] )
+
+//FK: Iterating a collection of C_OCOA_BENCHMARK_COLLECTION_SIZE objects, one iteration = one full pass
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_iterate_object_at_index,
+    for( unsigned long long itemIndex = 0u; itemIndex < C_OCOA_BENCHMARK_COLLECTION_SIZE; ++itemIndex )
+    {
+        c_ocoa_benchmark_sink += ( cocoabenchcollection_objectAtIndex( pClasses->collectionInstance.pObject, itemIndex ) != NULL );
+    } )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_iterate_fast_enumeration,
+    c_ocoa_collection_iterator_t iterator;
+    c_ocoa_collection_iterator_begin( &iterator, pClasses->collectionInstance.pObject );
+
+    void* pItem = NULL;
+    while( c_ocoa_collection_iterator_next( &iterator, &pItem ) )
+    {
+        c_ocoa_benchmark_sink += ( pItem != NULL );
+    } )
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_iterate_fast_enumeration_copying,
+    c_ocoa_collection_iterator_t iterator;
+    c_ocoa_collection_iterator_begin( &iterator, pClasses->copyingCollectionInstance.pObject );
+
+    void* pItem = NULL;
+    while( c_ocoa_collection_iterator_next( &iterator, &pItem ) )
+    {
+        c_ocoa_benchmark_sink += ( pItem != NULL );
+    } )
+
+//FK: Generated '_on_main' variant (--on-main), enqueue + drain on the same thread
+C_OCOA_BENCHMARK_DEFINE( c_ocoa_benchmark_void_on_main,             cocoabenchmainqueue_voidCall_on_main( pClasses->mainQueueInstance.pObject ); c_ocoa_main_queue_drain( 1u ) )
+
+static const c_ocoa_benchmark_case c_ocoa_benchmark_cases[] = {
+    { "void",           "imp call (lower bound)",   c_ocoa_benchmark_void_imp_call,             1u },
+    { "void",           "objc_msgSend cast",        c_ocoa_benchmark_void_msgsend,              1u },
+    { "void",           "wrapper",                  c_ocoa_benchmark_void_wrapper,              1u },
+    { "void",           "wrapper (-i)",             c_ocoa_benchmark_void_imp_cache,            1u },
+    { "void",           "wrapper (--header-only)",  c_ocoa_benchmark_void_inline,               1u },
+    { "void",           "batch (-i -b)",            c_ocoa_benchmark_void_batch,                C_OCOA_BENCHMARK_BATCH_SIZE },
+    { "void",           "_on_main + drain",         c_ocoa_benchmark_void_on_main,              1u },
+    { "scalar",         "imp call (lower bound)",   c_ocoa_benchmark_scalar_imp_call,           1u },
+    { "scalar",         "objc_msgSend cast",        c_ocoa_benchmark_scalar_msgsend,            1u },
+    { "scalar",         "wrapper",                  c_ocoa_benchmark_scalar_wrapper,            1u },
+    { "scalar",         "wrapper (-i)",             c_ocoa_benchmark_scalar_imp_cache,          1u },
+    { "scalar",         "wrapper (--header-only)",  c_ocoa_benchmark_scalar_inline,             1u },
+    { "scalar",         "batch (-i -b)",            c_ocoa_benchmark_scalar_batch,              C_OCOA_BENCHMARK_BATCH_SIZE },
+    { "float",          "imp call (lower bound)",   c_ocoa_benchmark_float_imp_call,            1u },
+    { "float",          "objc_msgSend cast",        c_ocoa_benchmark_float_msgsend,             1u },
+    { "float",          "wrapper",                  c_ocoa_benchmark_float_wrapper,             1u },
+    { "float",          "wrapper (-i)",             c_ocoa_benchmark_float_imp_cache,           1u },
+    { "float",          "wrapper (--header-only)",  c_ocoa_benchmark_float_inline,              1u },
+    { "small struct",   "imp call (lower bound)",   c_ocoa_benchmark_small_struct_imp_call,     1u },
+    { "small struct",   "objc_msgSend cast",        c_ocoa_benchmark_small_struct_msgsend,      1u },
+    { "small struct",   "wrapper",                  c_ocoa_benchmark_small_struct_wrapper,      1u },
+    { "small struct",   "wrapper (-i)",             c_ocoa_benchmark_small_struct_imp_cache,    1u },
+    { "small struct",   "wrapper (--header-only)",  c_ocoa_benchmark_small_struct_inline,       1u },
+    { "large struct",   "imp call (lower bound)",   c_ocoa_benchmark_large_struct_imp_call,     1u },
+    { "large struct",   "objc_msgSend cast",        c_ocoa_benchmark_large_struct_msgsend,      1u },
+    { "large struct",   "wrapper",                  c_ocoa_benchmark_large_struct_wrapper,      1u },
+    { "large struct",   "wrapper (-i)",             c_ocoa_benchmark_large_struct_imp_cache,    1u },
+    { "large struct",   "wrapper (--header-only)",  c_ocoa_benchmark_large_struct_inline,       1u },
+    { "iterate",        "objectAtIndex: wrapper",   c_ocoa_benchmark_iterate_object_at_index,   C_OCOA_BENCHMARK_COLLECTION_SIZE },
+    { "iterate",        "fast enumeration",         c_ocoa_benchmark_iterate_fast_enumeration,  C_OCOA_BENCHMARK_COLLECTION_SIZE },
+    { "iterate",        "fast enumeration (copying)", c_ocoa_benchmark_iterate_fast_enumeration_copying, C_OCOA_BENCHMARK_COLLECTION_SIZE },
+};
+
+static double c_ocoa_benchmark_run_case( const c_ocoa_benchmark_classes* pClasses, const c_ocoa_benchmark_case* pCase, uint64_t callCount )
+{
+    const uint64_t iterationCount = callCount > pCase->callsPerIteration ? callCount / pCase->callsPerIteration : 1u;
+
+    //FK: Warm up caches (selector lookups, IMP caches, method caches of the runtime)
+    pCase->function( pClasses, iterationCount / 16u + 1u );
+
+    uint64_t fastestRunTime = UINT64_MAX;
+    for( uint32_t runIndex = 0u; runIndex < C_OCOA_BENCHMARK_RUN_COUNT; ++runIndex )
+    {
+        const uint64_t startTime = c_ocoa_benchmark_get_time_in_nanoseconds();
+        pCase->function( pClasses, iterationCount );
+        const uint64_t runTime = c_ocoa_benchmark_get_time_in_nanoseconds() - startTime;
+
+        fastestRunTime = runTime < fastestRunTime ? runTime : fastestRunTime;
+    }
+
+    return (double)fastestRunTime / (double)( iterationCount * pCase->callsPerIteration );
+}
+
+static void* c_ocoa_benchmark_on_main_producer( void* pArgument )
+{
+    const c_ocoa_benchmark_producer_input* pInput = (const c_ocoa_benchmark_producer_input*)pArgument;
+    for( uint64_t callIndex = 0u; callIndex < pInput->callCount; ++callIndex )
+    {
+        cocoabenchmainqueue_voidCall_on_main( pInput->pObject );
+    }
+
+    return NULL;
+}
+
+static uint64_t c_ocoa_benchmark_perform_selector_call_count = 0u;
+
+static void c_ocoa_benchmark_perform_selector_target( id pObject, SEL pSelector, id pArgument )
+{
+    (void)pObject;
+    (void)pSelector;
+    (void)pArgument;
+    ++c_ocoa_benchmark_perform_selector_call_count;
+}
+
+static void* c_ocoa_benchmark_perform_selector_producer( void* pArgument )
+{
+    const c_ocoa_benchmark_producer_input* pInput = (const c_ocoa_benchmark_producer_input*)pArgument;
+    SEL performSelector = sel_registerName( "performSelectorOnMainThread:withObject:waitUntilDone:" );
+
+    void* pPool = c_ocoa_autoreleasepool_push();
+    for( uint64_t callIndex = 0u; callIndex < pInput->callCount; ++callIndex )
+    {
+        ((void (*)( id, SEL, SEL, id, BOOL ))objc_msgSend)( pInput->pObject, performSelector, pInput->pSelector, NULL, NO );
+
+        //FK: Each call autoreleases its invocation
+        if( ( callIndex & 1023u ) == 1023u )
+        {
+            c_ocoa_autoreleasepool_pop( pPool );
+            pPool = c_ocoa_autoreleasepool_push();
+        }
+    }
+    c_ocoa_autoreleasepool_pop( pPool );
+
+    return NULL;
+}
+
+//FK: Returns ns per call from the start of the producers until the main thread executed the last call
+static double c_ocoa_benchmark_run_main_thread_calls( void* (*pProducerFunction)( void* ), c_ocoa_benchmark_producer_input* pInput, size_t (*pDrainFunction)( void* ), void* pDrainArgument )
+{
+    pthread_t producerThreads[ C_OCOA_BENCHMARK_PRODUCER_COUNT ];
+    const uint64_t totalCallCount = pInput->callCount * C_OCOA_BENCHMARK_PRODUCER_COUNT;
+
+    const uint64_t startTime = c_ocoa_benchmark_get_time_in_nanoseconds();
+    for( uint32_t producerIndex = 0u; producerIndex < C_OCOA_BENCHMARK_PRODUCER_COUNT; ++producerIndex )
+    {
+        pthread_create( producerThreads + producerIndex, NULL, pProducerFunction, pInput );
+    }
+
+    uint64_t executedCallCount = 0u;
+    while( executedCallCount < totalCallCount )
+    {
+        const size_t drainedCallCount = pDrainFunction( pDrainArgument );
+        executedCallCount += drainedCallCount;
+
+        //FK: Give the producers a chance to run on machines with few cores
+        if( drainedCallCount == 0u )
+        {
+            sched_yield();
+        }
+    }
+    const uint64_t runTime = c_ocoa_benchmark_get_time_in_nanoseconds() - startTime;
+
+    for( uint32_t producerIndex = 0u; producerIndex < C_OCOA_BENCHMARK_PRODUCER_COUNT; ++producerIndex )
+    {
+        pthread_join( producerThreads[ producerIndex ], NULL );
+    }
+
+    return (double)runTime / (double)totalCallCount;
+}
+
+static size_t c_ocoa_benchmark_drain_main_queue( void* pArgument )
+{
+    (void)pArgument;
+    return c_ocoa_main_queue_drain( 256u );
+}
+
+typedef struct
+{
+    id  pRunLoop;
+    id  pMode;
+    id  pDistantPast;
+    SEL runModeSelector;
+} c_ocoa_benchmark_run_loop;
+
+static size_t c_ocoa_benchmark_drain_run_loop( void* pArgument )
+{
+    const c_ocoa_benchmark_run_loop* pRunLoop = (const c_ocoa_benchmark_run_loop*)pArgument;
+    const uint64_t previousCallCount = c_ocoa_benchmark_perform_selector_call_count;
+
+    void* pPool = c_ocoa_autoreleasepool_push();
+    ((BOOL (*)( id, SEL, id, id ))objc_msgSend)( pRunLoop->pRunLoop, pRunLoop->runModeSelector, pRunLoop->pMode, pRunLoop->pDistantPast );
+    c_ocoa_autoreleasepool_pop( pPool );
+
+    return (size_t)( c_ocoa_benchmark_perform_selector_call_count - previousCallCount );
+}
+
+static double c_ocoa_benchmark_run_on_main( const c_ocoa_benchmark_classes* pClasses, uint64_t callCount )
+{
+    c_ocoa_benchmark_producer_input input = { pClasses->mainQueueInstance.pObject, NULL, callCount / C_OCOA_BENCHMARK_PRODUCER_COUNT + 1u };
+    return c_ocoa_benchmark_run_main_thread_calls( c_ocoa_benchmark_on_main_producer, &input, c_ocoa_benchmark_drain_main_queue, NULL );
+}
+
+//FK: Needs Foundation (GNUstep base), returns a negative value if it isn't linked
+static double c_ocoa_benchmark_run_perform_selector( uint64_t callCount )
+{
+    Class pObjectClass      = objc_getClass( "NSObject" );
+    Class pRunLoopClass     = objc_getClass( "NSRunLoop" );
+    Class pDateClass        = objc_getClass( "NSDate" );
+    Class pStringClass      = objc_getClass( "NSString" );
+    if( pObjectClass == NULL || pRunLoopClass == NULL || pDateClass == NULL || pStringClass == NULL )
+    {
+        return -1.0;
+    }
+
+    Class pTargetClass = objc_getClass( "CocoaBenchMainThreadTarget" );
+    if( pTargetClass == NULL )
+    {
+        pTargetClass = objc_allocateClassPair( pObjectClass, "CocoaBenchMainThreadTarget", 0u );
+        class_addMethod( pTargetClass, sel_registerName( "mainThreadCall:" ), (IMP)c_ocoa_benchmark_perform_selector_target, "v@:@" );
+        objc_registerClassPair( pTargetClass );
+    }
+
+    void* pPool = c_ocoa_autoreleasepool_push();
+
+    c_ocoa_benchmark_run_loop runLoop;
+    runLoop.pRunLoop        = ((id (*)( id, SEL ))objc_msgSend)( (id)pRunLoopClass, sel_registerName( "currentRunLoop" ) );
+    runLoop.pMode           = ((id (*)( id, SEL, const char* ))objc_msgSend)( (id)pStringClass, sel_registerName( "stringWithUTF8String:" ), "NSDefaultRunLoopMode" );
+    runLoop.pDistantPast    = ((id (*)( id, SEL ))objc_msgSend)( (id)pDateClass, sel_registerName( "distantPast" ) );
+    runLoop.runModeSelector = sel_registerName( "runMode:beforeDate:" );
+
+    id pTarget = ((id (*)( id, SEL ))objc_msgSend)( (id)pTargetClass, sel_registerName( "new" ) );
+    c_ocoa_benchmark_producer_input input = { pTarget, sel_registerName( "mainThreadCall:" ), callCount / C_OCOA_BENCHMARK_PRODUCER_COUNT + 1u };
+    const double nanosecondsPerCall = c_ocoa_benchmark_run_main_thread_calls( c_ocoa_benchmark_perform_selector_producer, &input, c_ocoa_benchmark_drain_run_loop, &runLoop );
+
+    c_ocoa_autoreleasepool_pop( pPool );
+    return nanosecondsPerCall;
+}
+
+//FK: Implementations of the delegate protocol, these only get added to the classes and never called
+static void c_ocoa_benchmark_delegate_notify( id pObject, SEL pSelector, nsobject_t pSender )
+{
+    (void)pObject; (void)pSelector; (void)pSender;
+}
+
+static char c_ocoa_benchmark_delegate_should_close( id pObject, SEL pSelector, nsobject_t pSender )
+{
+    (void)pObject; (void)pSelector; (void)pSender;
+    return 1;
+}
+
+static void c_ocoa_benchmark_delegate_update_value( id pObject, SEL pSelector, nsobject_t pSender, double value )
+{
+    (void)pObject; (void)pSelector; (void)pSender;
+    c_ocoa_benchmark_sink += value;
+}
+
+static void c_ocoa_benchmark_delegate_select_index( id pObject, SEL pSelector, nsobject_t pSender, long long index )
+{
+    (void)pObject; (void)pSelector; (void)pSender;
+    c_ocoa_benchmark_sink += (double)index;
+}
+
+static BenchLargeStruct c_ocoa_benchmark_delegate_frame( id pObject, SEL pSelector, nsobject_t pSender )
+{
+    (void)pObject; (void)pSelector; (void)pSender;
+    const BenchLargeStruct frame = { 1.0, 2.0, 3.0, 4.0 };
+    return frame;
+}
+
+static BenchSmallStruct c_ocoa_benchmark_delegate_size( id pObject, SEL pSelector, nsobject_t pSender )
+{
+    (void)pObject; (void)pSelector; (void)pSender;
+    const BenchSmallStruct size = { 1.0, 2.0 };
+    return size;
+}
+
+static unsigned long long c_ocoa_benchmark_delegate_count( id pObject, SEL pSelector, nsobject_t pSender )
+{
+    (void)pObject; (void)pSelector; (void)pSender;
+    return 0u;
+}
+
+static const cocoabenchdelegate_vtable_t c_ocoa_benchmark_delegate_vtable = cocoabenchdelegate_vtable_init(
+    .benchDidStart          = c_ocoa_benchmark_delegate_notify,
+    .benchWillFinish        = c_ocoa_benchmark_delegate_notify,
+    .benchShouldClose       = c_ocoa_benchmark_delegate_should_close,
+    .bench_didUpdateValue   = c_ocoa_benchmark_delegate_update_value,
+    .bench_didSelectIndex   = c_ocoa_benchmark_delegate_select_index,
+    .benchFrame             = c_ocoa_benchmark_delegate_frame,
+    .benchSize              = c_ocoa_benchmark_delegate_size,
+    .benchCount             = c_ocoa_benchmark_delegate_count );
+
+//FK: What writing a delegate by hand looks like (see AppDelegateOR in osx/test/test.c)
+static Class c_ocoa_benchmark_define_delegate_class_by_hand( const char* pClassName, const char* pParentClassName )
+{
+    const IMP implementations[ C_OCOA_BENCHMARK_DELEGATE_METHOD_COUNT ] = {
+        (IMP)c_ocoa_benchmark_delegate_notify,
+        (IMP)c_ocoa_benchmark_delegate_notify,
+        (IMP)c_ocoa_benchmark_delegate_should_close,
+        (IMP)c_ocoa_benchmark_delegate_update_value,
+        (IMP)c_ocoa_benchmark_delegate_select_index,
+        (IMP)c_ocoa_benchmark_delegate_frame,
+        (IMP)c_ocoa_benchmark_delegate_size,
+        (IMP)c_ocoa_benchmark_delegate_count
+    };
+
+    Class pClass = objc_allocateClassPair( objc_getClass( pParentClassName ), pClassName, 0u );
+    if( pClass == NULL )
+    {
+        return NULL;
+    }
+
+    class_addProtocol( pClass, objc_getProtocol( C_OCOA_BENCHMARK_DELEGATE_PROTOCOL_NAME ) );
+    for( uint32_t methodIndex = 0u; methodIndex < C_OCOA_BENCHMARK_DELEGATE_METHOD_COUNT; ++methodIndex )
+    {
+        class_addMethod( pClass, sel_registerName( c_ocoa_benchmark_delegate_selector_names[ methodIndex ] ), implementations[ methodIndex ], c_ocoa_benchmark_delegate_type_encodings[ methodIndex ] );
+    }
+    objc_registerClassPair( pClass );
+
+    return pClass;
+}
+
+//FK: Startup cost of defining C_OCOA_BENCHMARK_DELEGATE_CLASS_COUNT delegate classes, returns ns per class (negative on failure)
+static double c_ocoa_benchmark_run_define_delegate_classes( uint8_t useVTable )
+{
+    char classNames[ C_OCOA_BENCHMARK_DELEGATE_CLASS_COUNT ][ 48 ];
+
+    uint64_t fastestRunTime = UINT64_MAX;
+    for( uint32_t runIndex = 0u; runIndex < C_OCOA_BENCHMARK_RUN_COUNT; ++runIndex )
+    {
+        for( uint32_t classIndex = 0u; classIndex < C_OCOA_BENCHMARK_DELEGATE_CLASS_COUNT; ++classIndex )
+        {
+            snprintf( classNames[ classIndex ], sizeof( classNames[ classIndex ] ), "CocoaBenchDelegateClass%u", c_ocoa_benchmark_delegate_class_index++ );
+        }
+
+        const uint64_t startTime = c_ocoa_benchmark_get_time_in_nanoseconds();
+        for( uint32_t classIndex = 0u; classIndex < C_OCOA_BENCHMARK_DELEGATE_CLASS_COUNT; ++classIndex )
+        {
+            Class pClass = useVTable ? cocoabenchdelegate_define_class( classNames[ classIndex ], C_OCOA_BENCHMARK_DEFAULT_CLASS_NAME, &c_ocoa_benchmark_delegate_vtable )
+                                     : c_ocoa_benchmark_define_delegate_class_by_hand( classNames[ classIndex ], C_OCOA_BENCHMARK_DEFAULT_CLASS_NAME );
+            if( pClass == NULL )
+            {
+                return -1.0;
+            }
+        }
+        const uint64_t runTime = c_ocoa_benchmark_get_time_in_nanoseconds() - startTime;
+
+        fastestRunTime = runTime < fastestRunTime ? runTime : fastestRunTime;
+    }
+
+    return (double)fastestRunTime / (double)C_OCOA_BENCHMARK_DELEGATE_CLASS_COUNT;
+}
+
+//FK: Messages that one pass over the collection sends to it
+static double c_ocoa_benchmark_count_collection_sends( const c_ocoa_benchmark_classes* pClasses, c_ocoa_benchmark_fn pIterateFunction )
+{
+    c_ocoa_benchmark_collection_send_count = 0u;
+    pIterateFunction( pClasses, 1u );
+    return (double)c_ocoa_benchmark_collection_send_count;
+}
+
+static double c_ocoa_benchmark_get_max_rss_in_kilobytes( void )
+{
+    struct rusage usage;
+    getrusage( RUSAGE_SELF, &usage );
+    return (double)usage.ru_maxrss;
+}
+
+//FK: Autoreleases C_OCOA_BENCHMARK_AUTORELEASE_OBJECT_COUNT objects inside of one pool, either with or without
+//    a nested c_ocoa_autoreleasepool per object. Returns the max RSS in KB, which only ever grows - so the
+//    variant with the nested pool has to run first.
+static double c_ocoa_benchmark_run_autorelease( Class pClass, uint8_t usePoolPerObject )
+{
+    void* pPool = c_ocoa_autoreleasepool_push();
+    for( uint32_t objectIndex = 0u; objectIndex < C_OCOA_BENCHMARK_AUTORELEASE_OBJECT_COUNT; ++objectIndex )
+    {
+        if( usePoolPerObject )
+        {
+            c_ocoa_autoreleasepool
+            {
+                c_ocoa_autorelease( class_createInstance( pClass, C_OCOA_BENCHMARK_AUTORELEASE_OBJECT_SIZE ) );
+            }
+        }
+        else
+        {
+            c_ocoa_autorelease( class_createInstance( pClass, C_OCOA_BENCHMARK_AUTORELEASE_OBJECT_SIZE ) );
+        }
+    }
+
+    const double maxRssInKilobytes = c_ocoa_benchmark_get_max_rss_in_kilobytes();
+    c_ocoa_autoreleasepool_pop( pPool );
+    return maxRssInKilobytes;
+}
+
+static void c_ocoa_benchmark_add_result( c_ocoa_benchmark_result* pResults, uint32_t* pResultCount, const char* pShape, const char* pVariant, double value, const char* pUnit )
+{
+    if( *pResultCount == C_OCOA_BENCHMARK_MAX_RESULT_COUNT )
+    {
+        fprintf( stderr, "[error] Too many results, increase C_OCOA_BENCHMARK_MAX_RESULT_COUNT.\n" );
+        return;
+    }
+
+    c_ocoa_benchmark_result* pResult = pResults + (*pResultCount)++;
+    pResult->pShape     = pShape;
+    pResult->pVariant   = pVariant;
+    pResult->value      = value;
+    pResult->pUnit      = pUnit;
+}
+
+static void c_ocoa_benchmark_write_table( FILE* pFileHandle, const c_ocoa_benchmark_result* pResults, uint32_t resultCount )
+{
+    fprintf( pFileHandle, "%-16s %-28s %12s %s\n", "shape", "variant", "value", "unit" );
+    for( uint32_t resultIndex = 0u; resultIndex < resultCount; ++resultIndex )
+    {
+        const c_ocoa_benchmark_result* pResult = pResults + resultIndex;
+        fprintf( pFileHandle, "%-16s %-28s %12.2f %s\n", pResult->pShape, pResult->pVariant, pResult->value, pResult->pUnit );
+    }
+}
+
+static void c_ocoa_benchmark_write_json( FILE* pFileHandle, const c_ocoa_benchmark_result* pResults, uint32_t resultCount, uint64_t callCount )
+{
+    fprintf( pFileHandle, "{\n" );
+    fprintf( pFileHandle, "\t\"revision\": \"%s\",\n", C_OCOA_BENCHMARK_REVISION );
+    fprintf( pFileHandle, "\t\"calls\": %llu,\n", (unsigned long long)callCount );
+    fprintf( pFileHandle, "\t\"results\": [\n" );
+    for( uint32_t resultIndex = 0u; resultIndex < resultCount; ++resultIndex )
+    {
+        const c_ocoa_benchmark_result* pResult = pResults + resultIndex;
+        fprintf( pFileHandle, "\t\t{ \"shape\": \"%s\", \"variant\": \"%s\", \"value\": %.3f, \"unit\": \"%s\" }%s\n", pResult->pShape, pResult->pVariant, pResult->value, pResult->pUnit, resultIndex + 1u < resultCount ? "," : "" );
+    }
+    fprintf( pFileHandle, "\t]\n" );
+    fprintf( pFileHandle, "}\n" );
+}
+
+static void print_benchmark_help( void )
+{
+    printf("Usage: c_ocoa_benchmark [OPTIONS]\n\n");
+    printf("OPTIONS are:\n");
+    printf("-n {count}   number of calls per benchmark (default: %u)\n", C_OCOA_BENCHMARK_DEFAULT_ITERATION_COUNT);
+    printf("-j {path}    write results as JSON to {path} (default: JSON is written to stdout after the table)\n");
+    printf("-h           print this help text\n");
+}
+
+int main(int argc, const char** argv)
+{
+    uint64_t callCount = C_OCOA_BENCHMARK_DEFAULT_ITERATION_COUNT;
+    const char* pJsonOutputPath = NULL;
+
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc )
+        {
+            callCount = strtoull( argv[i+1], NULL, 10 );
+            ++i;
+        }
+        else if( strcmp( argv[i], "-j" ) == 0 && i + 1 < argc )
+        {
+            pJsonOutputPath = argv[i+1];
+            ++i;
+        }
+        else
+        {
+            print_benchmark_help();
+            return argv[i][0] == '-' && argv[i][1] == 'h' ? 0 : 1;
+        }
+    }
+
+    c_ocoa_benchmark_classes classes;
+    if( !c_ocoa_benchmark_register_classes( &classes ) )
+    {
+        fprintf( stderr, "[error] Couldn't register benchmark classes.\n" );
+        return 1;
+    }
+
+    c_ocoa_benchmark_void_selector          = sel_registerName( "voidCall" );
+    c_ocoa_benchmark_scalar_selector        = sel_registerName( "scalarCall:" );
+    c_ocoa_benchmark_float_selector         = sel_registerName( "floatCall:" );
+    c_ocoa_benchmark_small_struct_selector  = sel_registerName( "smallStructCall" );
+    c_ocoa_benchmark_large_struct_selector  = sel_registerName( "largeStructCall" );
+
+    c_ocoa_benchmark_void_imp               = class_getMethodImplementation( classes.defaultInstance.pClass, c_ocoa_benchmark_void_selector );
+    c_ocoa_benchmark_scalar_imp             = class_getMethodImplementation( classes.defaultInstance.pClass, c_ocoa_benchmark_scalar_selector );
+    c_ocoa_benchmark_float_imp              = class_getMethodImplementation( classes.defaultInstance.pClass, c_ocoa_benchmark_float_selector );
+    c_ocoa_benchmark_small_struct_imp       = class_getMethodImplementation( classes.defaultInstance.pClass, c_ocoa_benchmark_small_struct_selector );
+    c_ocoa_benchmark_large_struct_imp       = class_getMethodImplementation( classes.defaultInstance.pClass, c_ocoa_benchmark_large_struct_selector );
+
+    for( uint32_t receiverIndex = 0u; receiverIndex < C_OCOA_BENCHMARK_BATCH_SIZE; ++receiverIndex )
+    {
+        c_ocoa_benchmark_batch_receivers[ receiverIndex ]       = classes.impCacheInstance.pObject;
+        c_ocoa_benchmark_batch_scalar_arguments[ receiverIndex ] = (int)receiverIndex;
+    }
+
+    c_ocoa_benchmark_result results[ C_OCOA_BENCHMARK_MAX_RESULT_COUNT ];
+    uint32_t resultCount = 0u;
+    const uint32_t caseCount = sizeof( c_ocoa_benchmark_cases ) / sizeof( c_ocoa_benchmark_cases[0] );
+    for( uint32_t caseIndex = 0u; caseIndex < caseCount; ++caseIndex )
+    {
+        const c_ocoa_benchmark_case* pCase = c_ocoa_benchmark_cases + caseIndex;
+        c_ocoa_benchmark_add_result( results, &resultCount, pCase->pShape, pCase->pVariant, c_ocoa_benchmark_run_case( &classes, pCase, callCount ), "ns/call" );
+    }
+
+    c_ocoa_benchmark_add_result( results, &resultCount, "iterate sends", "objectAtIndex: wrapper", c_ocoa_benchmark_count_collection_sends( &classes, c_ocoa_benchmark_iterate_object_at_index ), "sends/pass" );
+    c_ocoa_benchmark_add_result( results, &resultCount, "iterate sends", "fast enumeration", c_ocoa_benchmark_count_collection_sends( &classes, c_ocoa_benchmark_iterate_fast_enumeration ), "sends/pass" );
+    c_ocoa_benchmark_add_result( results, &resultCount, "iterate sends", "fast enumeration (copying)", c_ocoa_benchmark_count_collection_sends( &classes, c_ocoa_benchmark_iterate_fast_enumeration_copying ), "sends/pass" );
+
+    //FK: Throughput of calls that worker threads send to the main thread
+    const uint64_t mainThreadCallCount = callCount / C_OCOA_BENCHMARK_MAIN_THREAD_CALL_DIVISOR + 1u;
+    c_ocoa_benchmark_add_result( results, &resultCount, "main thread", "_on_main", c_ocoa_benchmark_run_on_main( &classes, mainThreadCallCount ), "ns/call" );
+
+    const double performSelectorNanosecondsPerCall = c_ocoa_benchmark_run_perform_selector( mainThreadCallCount );
+    if( performSelectorNanosecondsPerCall >= 0.0 )
+    {
+        c_ocoa_benchmark_add_result( results, &resultCount, "main thread", "performSelectorOnMainThread", performSelectorNanosecondsPerCall, "ns/call" );
+    }
+    else
+    {
+        fprintf( stderr, "[info] Skipping performSelectorOnMainThread: comparison, Foundation isn't linked (C_OCOA_BENCHMARK_LIBRARIES=-lgnustep-base).\n" );
+    }
+
+    //FK: Startup cost of delegate classes (ns per defined class instead of ns per call)
+    c_ocoa_benchmark_add_result( results, &resultCount, "define class", "class_addMethod by hand", c_ocoa_benchmark_run_define_delegate_classes( 0u ), "ns/class" );
+    c_ocoa_benchmark_add_result( results, &resultCount, "define class", "delegate vtable", c_ocoa_benchmark_run_define_delegate_classes( 1u ), "ns/class" );
+
+    //FK: RSS has to stay flat when every object gets its own pool
+    c_ocoa_benchmark_add_result( results, &resultCount, "autorelease 1M", "before", c_ocoa_benchmark_get_max_rss_in_kilobytes(), "KB max RSS" );
+    c_ocoa_benchmark_add_result( results, &resultCount, "autorelease 1M", "c_ocoa_autoreleasepool each", c_ocoa_benchmark_run_autorelease( classes.autoreleaseInstance.pClass, 1u ), "KB max RSS" );
+    c_ocoa_benchmark_add_result( results, &resultCount, "autorelease 1M", "one pool around all", c_ocoa_benchmark_run_autorelease( classes.autoreleaseInstance.pClass, 0u ), "KB max RSS" );
+
+    c_ocoa_benchmark_write_table( stdout, results, resultCount );
+
+    if( pJsonOutputPath == NULL )
+    {
+        printf( "\n" );
+        c_ocoa_benchmark_write_json( stdout, results, resultCount, callCount );
+        return 0;
+    }
+
+    FILE* pJsonFileHandle = fopen( pJsonOutputPath, "w" );
+    if( pJsonFileHandle == NULL )
+    {
+        fprintf( stderr, "[error] Couldn't open '%s' for writing.\n", pJsonOutputPath );
+        return 1;
+    }
+
+    c_ocoa_benchmark_write_json( pJsonFileHandle, results, resultCount, callCount );
+    fclose( pJsonFileHandle );
+
+    return 0;
+}
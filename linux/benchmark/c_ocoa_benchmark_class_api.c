@@ -0,0 +1,295 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <objc/runtime.h>
+#include <objc/message.h>
+
+#include "c_ocoa_benchmark_classes.h"
+
+//FK: Built by linux/build_benchmark.sh with the repository root as include path
+#include "c_ocoa_class_api.c"
+
+#define C_OCOA_BENCHMARK_CLASS_API_CLASS_COUNT      256u    //FK: classes that get defined per variant
+#define C_OCOA_BENCHMARK_CLASS_API_METHOD_COUNT     16u     //FK: methods per class, twice the default capacity of a class definition
+#define C_OCOA_BENCHMARK_CLASS_API_LAZY_CLASS_COUNT 64u     //FK: classes per lazy/eager variant, all lazy variants together have to stay below C_OCOA_MAX_LAZY_CLASS_COUNT
+#define C_OCOA_BENCHMARK_CLASS_API_MAX_METHOD_COUNT 200u
+#define C_OCOA_BENCHMARK_CLASS_API_ARENA_PADDING    16u     //FK: per class, for the alignment of the arena allocations
+#define C_OCOA_BENCHMARK_CLASS_API_CLASS_NAME_SIZE  48u
+
+//FK: Every allocation of the process (including the ones of the objc runtime) goes through these.
+//    glibc only - the __libc_* functions are the allocator that malloc() would have called.
+extern void* __libc_malloc( size_t sizeInBytes );
+extern void* __libc_calloc( size_t elementCount, size_t elementSizeInBytes );
+extern void* __libc_realloc( void* pMemory, size_t sizeInBytes );
+
+static uint64_t c_ocoa_benchmark_allocation_count = 0u;
+
+void* malloc( size_t sizeInBytes )
+{
+    __atomic_fetch_add( &c_ocoa_benchmark_allocation_count, 1u, __ATOMIC_RELAXED );
+    return __libc_malloc( sizeInBytes );
+}
+
+void* calloc( size_t elementCount, size_t elementSizeInBytes )
+{
+    __atomic_fetch_add( &c_ocoa_benchmark_allocation_count, 1u, __ATOMIC_RELAXED );
+    return __libc_calloc( elementCount, elementSizeInBytes );
+}
+
+void* realloc( void* pMemory, size_t sizeInBytes )
+{
+    __atomic_fetch_add( &c_ocoa_benchmark_allocation_count, 1u, __ATOMIC_RELAXED );
+    return __libc_realloc( pMemory, sizeInBytes );
+}
+
+typedef enum
+{
+    C_OCOA_BENCHMARK_CLASS_API_DEFINITION,          //FK: c_ocoa_create_inherited_class_definition() + one c_ocoa_add_class_definition_method() per method
+    C_OCOA_BENCHMARK_CLASS_API_DEFINITION_IN_ARENA, //FK: c_ocoa_create_inherited_class_definition_in_arena() + method table
+    C_OCOA_BENCHMARK_CLASS_API_DEFINE_CLASS,        //FK: c_ocoa_define_class() + method table
+    C_OCOA_BENCHMARK_CLASS_API_EAGER_FIRST_USE,     //FK: definition with payload + method table, one instance + one call
+    C_OCOA_BENCHMARK_CLASS_API_LAZY_FIRST_USE       //FK: definition with payload + lazy method table, one instance + one call
+} c_ocoa_benchmark_class_api_variant;
+
+typedef struct
+{
+    uint64_t callCount;
+} c_ocoa_benchmark_class_api_payload_t;
+
+typedef struct
+{
+    double allocationsPerClass;
+    double nanosecondsPerClass;
+} c_ocoa_benchmark_class_api_result;
+
+static char                             c_ocoa_benchmark_class_api_method_names[ C_OCOA_BENCHMARK_CLASS_API_MAX_METHOD_COUNT ][ 32 ];
+static c_ocoa_class_definition_method_t c_ocoa_benchmark_class_api_methods[ C_OCOA_BENCHMARK_CLASS_API_MAX_METHOD_COUNT ];   //FK: sorted by name, so it can be used as lazy table
+static SEL                              c_ocoa_benchmark_class_api_first_selector = NULL;
+static uint32_t                         c_ocoa_benchmark_class_api_class_index = 0u;
+static ptrdiff_t                        c_ocoa_benchmark_class_api_payload_offset = 0;  //FK: written when a class with payload gets finished, same for all of them
+
+//FK: Only gets called on instances of classes with payload (see c_ocoa_benchmark_class_api_use_class())
+static void c_ocoa_benchmark_class_api_method( id pObject, SEL pSelector )
+{
+    (void)pSelector;
+    c_ocoa_benchmark_class_api_payload_t* pPayload = (c_ocoa_benchmark_class_api_payload_t*)c_ocoa_object_payload( pObject, c_ocoa_benchmark_class_api_payload_offset );
+    ++pPayload->callCount;
+}
+
+static uint64_t c_ocoa_benchmark_get_time_in_nanoseconds( void )
+{
+    struct timespec time;
+    clock_gettime( CLOCK_MONOTONIC, &time );
+    return (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;
+}
+
+static void c_ocoa_benchmark_class_api_create_methods( void )
+{
+    for( uint32_t methodIndex = 0u; methodIndex < C_OCOA_BENCHMARK_CLASS_API_MAX_METHOD_COUNT; ++methodIndex )
+    {
+        char* pMethodName = c_ocoa_benchmark_class_api_method_names[ methodIndex ];
+        snprintf( pMethodName, sizeof( c_ocoa_benchmark_class_api_method_names[ methodIndex ] ), "benchMethod%03u", methodIndex );
+
+        const c_ocoa_class_definition_method_t method = C_OCOA_CLASS_METHOD( pMethodName, c_ocoa_benchmark_class_api_method, "v@:" );
+        c_ocoa_benchmark_class_api_methods[ methodIndex ] = method;
+
+        //FK: Registered up front, so that the selector table doesn't show up in the allocation counts
+        sel_registerName( pMethodName );
+    }
+
+    c_ocoa_benchmark_class_api_first_selector = sel_registerName( c_ocoa_benchmark_class_api_methods[ 0 ].pName );
+}
+
+//FK: First use of a class: one instance and one call of the first method (which adds the method to lazy classes).
+//    Returns 0 if the call didn't reach the payload of the instance.
+static uint8_t c_ocoa_benchmark_class_api_use_class( const c_ocoa_class_definition_t* pClassDefinition )
+{
+    id pObject = class_createInstance( pClassDefinition->pObjcClass, 0u );
+    if( pObject == NULL )
+    {
+        return 0u;
+    }
+
+    ((void (*)( id, SEL ))objc_msgSend)( pObject, c_ocoa_benchmark_class_api_first_selector );
+
+    const c_ocoa_benchmark_class_api_payload_t* pPayload = (const c_ocoa_benchmark_class_api_payload_t*)c_ocoa_object_payload( pObject, c_ocoa_benchmark_class_api_payload_offset );
+    const uint8_t wasCalled = pPayload->callCount == 1u;
+    object_dispose( pObject );
+    return wasCalled;
+}
+
+//FK: The names stay allocated, the runtime might keep pointers to them
+static char* c_ocoa_benchmark_class_api_create_class_names( void )
+{
+    char* pClassNames = (char*)malloc( C_OCOA_BENCHMARK_CLASS_API_CLASS_NAME_SIZE * C_OCOA_BENCHMARK_CLASS_API_CLASS_COUNT );
+    if( pClassNames == NULL )
+    {
+        return NULL;
+    }
+
+    for( uint32_t classIndex = 0u; classIndex < C_OCOA_BENCHMARK_CLASS_API_CLASS_COUNT; ++classIndex )
+    {
+        snprintf( pClassNames + classIndex * C_OCOA_BENCHMARK_CLASS_API_CLASS_NAME_SIZE, C_OCOA_BENCHMARK_CLASS_API_CLASS_NAME_SIZE, "CocoaBenchClassApi%u", c_ocoa_benchmark_class_api_class_index++ );
+    }
+
+    return pClassNames;
+}
+
+static Class c_ocoa_benchmark_class_api_define_class( c_ocoa_benchmark_class_api_variant variant, c_ocoa_class_arena_t* pArena, const char* pClassName, uint32_t methodCount )
+{
+    const char* pParentClassName = C_OCOA_BENCHMARK_DEFAULT_CLASS_NAME;
+    if( variant == C_OCOA_BENCHMARK_CLASS_API_DEFINE_CLASS )
+    {
+        return c_ocoa_define_class( pClassName, pParentClassName, c_ocoa_benchmark_class_api_methods, methodCount, 0u, 0u, NULL );
+    }
+
+    c_ocoa_class_definition_t* pClassDefinition = NULL;
+    if( variant == C_OCOA_BENCHMARK_CLASS_API_DEFINITION_IN_ARENA )
+    {
+        pClassDefinition = c_ocoa_create_inherited_class_definition_in_arena( pArena, pClassName, pParentClassName, methodCount );
+        if( pClassDefinition == NULL || !c_ocoa_add_class_definition_methods( pClassDefinition, c_ocoa_benchmark_class_api_methods, methodCount ) )
+        {
+            return NULL;
+        }
+    }
+    else if( variant == C_OCOA_BENCHMARK_CLASS_API_EAGER_FIRST_USE || variant == C_OCOA_BENCHMARK_CLASS_API_LAZY_FIRST_USE )
+    {
+        pClassDefinition = c_ocoa_create_inherited_class_definition_with_payload( pClassName, pParentClassName, sizeof( c_ocoa_benchmark_class_api_payload_t ), _Alignof( c_ocoa_benchmark_class_api_payload_t ), &c_ocoa_benchmark_class_api_payload_offset );
+        const int addedMethods = pClassDefinition != NULL && ( variant == C_OCOA_BENCHMARK_CLASS_API_LAZY_FIRST_USE ? c_ocoa_set_class_definition_lazy_methods( pClassDefinition, c_ocoa_benchmark_class_api_methods, methodCount )
+                                                                                                                    : c_ocoa_add_class_definition_methods( pClassDefinition, c_ocoa_benchmark_class_api_methods, methodCount ) );
+        if( !addedMethods )
+        {
+            c_ocoa_destroy_class_definition( pClassDefinition );
+            return NULL;
+        }
+    }
+    else
+    {
+        pClassDefinition = c_ocoa_create_inherited_class_definition( pClassName, pParentClassName );
+        for( uint32_t methodIndex = 0u; pClassDefinition != NULL && methodIndex < methodCount; ++methodIndex )
+        {
+            const c_ocoa_class_definition_method_t* pMethod = c_ocoa_benchmark_class_api_methods + methodIndex;
+            if( !c_ocoa_add_class_definition_method( pClassDefinition, pMethod->pName, pMethod->pFunctionPointer, pMethod->pSignature ) )
+            {
+                c_ocoa_destroy_class_definition( pClassDefinition );
+                return NULL;
+            }
+        }
+    }
+
+    if( pClassDefinition == NULL || !c_ocoa_finish_class_definition( pClassDefinition ) )
+    {
+        c_ocoa_destroy_class_definition( pClassDefinition );
+        return NULL;
+    }
+
+    Class pClass = pClassDefinition->pObjcClass;
+    if( pClassDefinition->payloadSizeInBytes > 0u && !c_ocoa_benchmark_class_api_use_class( pClassDefinition ) )
+    {
+        fprintf( stderr, "[error] Method of class '%s' didn't reach the payload.\n", pClassName );
+        pClass = NULL;
+    }
+
+    c_ocoa_destroy_class_definition( pClassDefinition );
+    return pClass;
+}
+
+//FK: Defines classCount classes with the given variant, the allocations include the ones of the runtime
+static uint8_t c_ocoa_benchmark_class_api_run( c_ocoa_benchmark_class_api_result* pOutResult, c_ocoa_benchmark_class_api_variant variant, uint32_t classCount, uint32_t methodCount )
+{
+    char* pClassNames = c_ocoa_benchmark_class_api_create_class_names();
+
+    //FK: The arena memory is owned by the caller, so it gets allocated outside of the measurement
+    const size_t arenaSizeInBytes = classCount * ( sizeof( c_ocoa_class_definition_t ) + sizeof( c_ocoa_class_definition_method_t ) * methodCount + C_OCOA_BENCHMARK_CLASS_API_ARENA_PADDING );
+    void* pArenaMemory = malloc( arenaSizeInBytes );
+    if( pClassNames == NULL || pArenaMemory == NULL )
+    {
+        free( pClassNames );
+        free( pArenaMemory );
+        return 0u;
+    }
+
+    c_ocoa_class_arena_t arena;
+    c_ocoa_init_class_arena( &arena, pArenaMemory, arenaSizeInBytes );
+
+    const uint64_t startAllocationCount = __atomic_load_n( &c_ocoa_benchmark_allocation_count, __ATOMIC_RELAXED );
+    const uint64_t startTime = c_ocoa_benchmark_get_time_in_nanoseconds();
+    for( uint32_t classIndex = 0u; classIndex < classCount; ++classIndex )
+    {
+        const char* pClassName = pClassNames + classIndex * C_OCOA_BENCHMARK_CLASS_API_CLASS_NAME_SIZE;
+        if( c_ocoa_benchmark_class_api_define_class( variant, &arena, pClassName, methodCount ) == NULL )
+        {
+            fprintf( stderr, "[error] Couldn't define class '%s'.\n", pClassName );
+            return 0u;
+        }
+    }
+    const uint64_t runTime = c_ocoa_benchmark_get_time_in_nanoseconds() - startTime;
+    const uint64_t allocationCount = __atomic_load_n( &c_ocoa_benchmark_allocation_count, __ATOMIC_RELAXED ) - startAllocationCount;
+
+    //FK: The definitions are gone, the classes stay registered
+    free( pArenaMemory );
+
+    pOutResult->allocationsPerClass = (double)allocationCount / (double)classCount;
+    pOutResult->nanosecondsPerClass = (double)runTime / (double)classCount;
+    return 1u;
+}
+
+static void print_benchmark_class_api_help( void )
+{
+    printf( "Counts the allocations (malloc, calloc and realloc of the whole process) and ns per class that gets defined via c_ocoa_class_api.c.\n" );
+    printf( "'first use' additionally creates one instance and calls one method, which reads the payload of the instance.\n" );
+    printf( "Usage: c_ocoa_benchmark_class_api\n" );
+}
+
+int main(int argc, const char** argv)
+{
+    if( argc > 1 )
+    {
+        print_benchmark_class_api_help();
+        return argv[1][0] == '-' && argv[1][1] == 'h' ? 0 : 1;
+    }
+
+    c_ocoa_benchmark_classes classes;
+    if( !c_ocoa_benchmark_register_classes( &classes ) )
+    {
+        fprintf( stderr, "[error] Couldn't register benchmark classes.\n" );
+        return 1;
+    }
+
+    c_ocoa_benchmark_class_api_create_methods();
+
+    //FK: Lazy classes only pay for the methods that get called, so defining one should cost the same for 2 and 200 methods
+    const struct
+    {
+        const char*                         pShape;
+        const char*                         pVariant;
+        c_ocoa_benchmark_class_api_variant  variant;
+        uint32_t                            classCount;
+        uint32_t                            methodCount;
+    } variants[] = {
+        { "define",     "definition (malloc)",  C_OCOA_BENCHMARK_CLASS_API_DEFINITION,          C_OCOA_BENCHMARK_CLASS_API_CLASS_COUNT,         C_OCOA_BENCHMARK_CLASS_API_METHOD_COUNT },
+        { "define",     "definition in arena",  C_OCOA_BENCHMARK_CLASS_API_DEFINITION_IN_ARENA, C_OCOA_BENCHMARK_CLASS_API_CLASS_COUNT,         C_OCOA_BENCHMARK_CLASS_API_METHOD_COUNT },
+        { "define",     "c_ocoa_define_class",  C_OCOA_BENCHMARK_CLASS_API_DEFINE_CLASS,        C_OCOA_BENCHMARK_CLASS_API_CLASS_COUNT,         C_OCOA_BENCHMARK_CLASS_API_METHOD_COUNT },
+        { "first use",  "eager + payload",      C_OCOA_BENCHMARK_CLASS_API_EAGER_FIRST_USE,     C_OCOA_BENCHMARK_CLASS_API_LAZY_CLASS_COUNT,    2u },
+        { "first use",  "lazy + payload",       C_OCOA_BENCHMARK_CLASS_API_LAZY_FIRST_USE,      C_OCOA_BENCHMARK_CLASS_API_LAZY_CLASS_COUNT,    2u },
+        { "first use",  "eager + payload",      C_OCOA_BENCHMARK_CLASS_API_EAGER_FIRST_USE,     C_OCOA_BENCHMARK_CLASS_API_LAZY_CLASS_COUNT,    C_OCOA_BENCHMARK_CLASS_API_MAX_METHOD_COUNT },
+        { "first use",  "lazy + payload",       C_OCOA_BENCHMARK_CLASS_API_LAZY_FIRST_USE,      C_OCOA_BENCHMARK_CLASS_API_LAZY_CLASS_COUNT,    C_OCOA_BENCHMARK_CLASS_API_MAX_METHOD_COUNT },
+    };
+
+    printf( "%-24s %-28s %12s %12s\n", "shape", "variant", "allocs/class", "ns/class" );
+    for( uint32_t variantIndex = 0u; variantIndex < sizeof( variants ) / sizeof( variants[0] ); ++variantIndex )
+    {
+        c_ocoa_benchmark_class_api_result result;
+        if( !c_ocoa_benchmark_class_api_run( &result, variants[ variantIndex ].variant, variants[ variantIndex ].classCount, variants[ variantIndex ].methodCount ) )
+        {
+            return 1;
+        }
+
+        char shape[ 32 ];
+        snprintf( shape, sizeof( shape ), "%s %u methods", variants[ variantIndex ].pShape, variants[ variantIndex ].methodCount );
+        printf( "%-24s %-28s %12.2f %12.2f\n", shape, variants[ variantIndex ].pVariant, result.allocationsPerClass, result.nanosecondsPerClass );
+    }
+
+    return 0;
+}
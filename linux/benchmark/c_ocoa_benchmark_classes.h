@@ -0,0 +1,366 @@
+#ifndef C_OCOA_BENCHMARK_CLASSES_HEADER
+#define C_OCOA_BENCHMARK_CLASSES_HEADER
+
+//FK: Synthetic classes for the wrapper dispatch benchmark.
+//    They get registered at runtime via objc_allocateClassPair() so that the benchmark
+//    doesn't depend on Foundation (GNUstep base) being available.
+//    This file is included by both the benchmark generator and the benchmark itself.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <objc/runtime.h>
+#include <objc/message.h>
+
+//FK: Returned in registers on all supported platforms
+typedef struct
+{
+    double x;
+    double y;
+} c_ocoa_benchmark_small_struct_t;
+
+//FK: Returned via hidden pointer argument (objc_msgSend_stret) on x86_64
+typedef struct
+{
+    double x;
+    double y;
+    double z;
+    double w;
+} c_ocoa_benchmark_large_struct_t;
+
+//FK: Every dispatch class gets registered with the same methods but gets generated
+//    with different generator options (see linux/build_benchmark.sh)
+#define C_OCOA_BENCHMARK_DEFAULT_CLASS_NAME     "CocoaBenchDefault"     //FK: default options
+#define C_OCOA_BENCHMARK_IMP_CACHE_CLASS_NAME   "CocoaBenchImpCache"    //FK: -i -b
+#define C_OCOA_BENCHMARK_INLINE_CLASS_NAME      "CocoaBenchInline"      //FK: --header-only
+#define C_OCOA_BENCHMARK_COLLECTION_CLASS_NAME  "CocoaBenchCollection"  //FK: default options
+#define C_OCOA_BENCHMARK_COPYING_COLLECTION_CLASS_NAME "CocoaBenchCopyingCollection" //FK: not generated, only iterated
+#define C_OCOA_BENCHMARK_MAIN_QUEUE_CLASS_NAME  "CocoaBenchMainQueue"   //FK: --on-main
+#define C_OCOA_BENCHMARK_DELEGATE_PROTOCOL_NAME "CocoaBenchDelegate"    //FK: --protocols
+#define C_OCOA_BENCHMARK_AUTORELEASE_CLASS_NAME "CocoaBenchAutorelease" //FK: not generated, only gets autoreleased
+
+#define C_OCOA_BENCHMARK_COLLECTION_SIZE 1024u
+
+//FK: Methods of the delegate protocol, the first C_OCOA_BENCHMARK_DELEGATE_REQUIRED_METHOD_COUNT are required
+#define C_OCOA_BENCHMARK_DELEGATE_METHOD_COUNT          8u
+#define C_OCOA_BENCHMARK_DELEGATE_REQUIRED_METHOD_COUNT 2u
+
+static const char* const c_ocoa_benchmark_delegate_selector_names[ C_OCOA_BENCHMARK_DELEGATE_METHOD_COUNT ] = {
+    "benchDidStart:",
+    "benchWillFinish:",
+    "benchShouldClose:",
+    "bench:didUpdateValue:",
+    "bench:didSelectIndex:",
+    "benchFrame:",
+    "benchSize:",
+    "benchCount:"
+};
+
+static const char* const c_ocoa_benchmark_delegate_type_encodings[ C_OCOA_BENCHMARK_DELEGATE_METHOD_COUNT ] = {
+    "v@:@",
+    "v@:@",
+    "c@:@",
+    "v@:@d",
+    "v@:@q",
+    "{BenchLargeStruct=dddd}@:@",
+    "{BenchSmallStruct=dd}@:@",
+    "Q@:@"
+};
+
+typedef struct
+{
+    Class   pClass;
+    id      pObject;
+} c_ocoa_benchmark_instance;
+
+typedef struct
+{
+    c_ocoa_benchmark_instance defaultInstance;
+    c_ocoa_benchmark_instance impCacheInstance;
+    c_ocoa_benchmark_instance inlineInstance;
+    c_ocoa_benchmark_instance collectionInstance;
+    c_ocoa_benchmark_instance copyingCollectionInstance;
+    c_ocoa_benchmark_instance mainQueueInstance;
+    c_ocoa_benchmark_instance autoreleaseInstance;
+} c_ocoa_benchmark_classes;
+
+//FK: Same layout as NSFastEnumerationState
+typedef struct
+{
+    unsigned long   state;
+    id*             ppItems;
+    unsigned long*  pMutations;
+    unsigned long   extra[5];
+} c_ocoa_benchmark_fast_enumeration_state;
+
+static id               c_ocoa_benchmark_collection_items[ C_OCOA_BENCHMARK_COLLECTION_SIZE ];
+static unsigned long    c_ocoa_benchmark_collection_mutations = 0u;
+static uint64_t         c_ocoa_benchmark_collection_send_count = 0u;  //FK: messages that the collections received
+
+static void c_ocoa_benchmark_void_call( id pObject, SEL pSelector )
+{
+    (void)pObject;
+    (void)pSelector;
+}
+
+static int c_ocoa_benchmark_scalar_call( id pObject, SEL pSelector, int value )
+{
+    (void)pObject;
+    (void)pSelector;
+    return value + 1;
+}
+
+static double c_ocoa_benchmark_float_call( id pObject, SEL pSelector, double value )
+{
+    (void)pObject;
+    (void)pSelector;
+    return value * 0.5;
+}
+
+static c_ocoa_benchmark_small_struct_t c_ocoa_benchmark_small_struct_call( id pObject, SEL pSelector )
+{
+    (void)pObject;
+    (void)pSelector;
+
+    c_ocoa_benchmark_small_struct_t result = { 1.0, 2.0 };
+    return result;
+}
+
+static c_ocoa_benchmark_large_struct_t c_ocoa_benchmark_large_struct_call( id pObject, SEL pSelector )
+{
+    (void)pObject;
+    (void)pSelector;
+
+    c_ocoa_benchmark_large_struct_t result = { 1.0, 2.0, 3.0, 4.0 };
+    return result;
+}
+
+static unsigned long c_ocoa_benchmark_collection_count( id pObject, SEL pSelector )
+{
+    (void)pObject;
+    (void)pSelector;
+    return C_OCOA_BENCHMARK_COLLECTION_SIZE;
+}
+
+static id c_ocoa_benchmark_collection_object_at_index( id pObject, SEL pSelector, unsigned long index )
+{
+    (void)pObject;
+    (void)pSelector;
+    ++c_ocoa_benchmark_collection_send_count;
+    return c_ocoa_benchmark_collection_items[ index ];
+}
+
+static unsigned long c_ocoa_benchmark_collection_count_by_enumerating( id pObject, SEL pSelector, c_ocoa_benchmark_fast_enumeration_state* pState, id* ppBuffer, unsigned long bufferLength )
+{
+    (void)pObject;
+    (void)pSelector;
+    (void)ppBuffer;
+    (void)bufferLength;
+
+    ++c_ocoa_benchmark_collection_send_count;
+    if( pState->state != 0u )
+    {
+        return 0u;
+    }
+
+    //FK: Hand out the internal storage in one go, like NSArray does
+    pState->state       = 1u;
+    pState->ppItems     = c_ocoa_benchmark_collection_items;
+    pState->pMutations  = &c_ocoa_benchmark_collection_mutations;
+    return C_OCOA_BENCHMARK_COLLECTION_SIZE;
+}
+
+//FK: Copies into the caller's buffer, like collections without contiguous storage (eg: NSSet) do
+static unsigned long c_ocoa_benchmark_copying_collection_count_by_enumerating( id pObject, SEL pSelector, c_ocoa_benchmark_fast_enumeration_state* pState, id* ppBuffer, unsigned long bufferLength )
+{
+    (void)pObject;
+    (void)pSelector;
+
+    ++c_ocoa_benchmark_collection_send_count;
+    const unsigned long startIndex = pState->state;
+    unsigned long itemCount = C_OCOA_BENCHMARK_COLLECTION_SIZE - startIndex;
+    itemCount = itemCount < bufferLength ? itemCount : bufferLength;
+    for( unsigned long itemIndex = 0u; itemIndex < itemCount; ++itemIndex )
+    {
+        ppBuffer[ itemIndex ] = c_ocoa_benchmark_collection_items[ startIndex + itemIndex ];
+    }
+
+    pState->state       = startIndex + itemCount;
+    pState->ppItems     = ppBuffer;
+    pState->pMutations  = &c_ocoa_benchmark_collection_mutations;
+    return itemCount;
+}
+
+//FK: libobjc2 only handles retain/release/autorelease of classes that implement '_ARCCompliantRetainRelease' itself
+//    (like NSObject of GNUstep base does), everything else gets messages that a root class doesn't understand
+static void c_ocoa_benchmark_arc_compliant( id pObject, SEL pSelector )
+{
+    (void)pObject;
+    (void)pSelector;
+}
+
+static void c_ocoa_benchmark_dealloc( id pObject, SEL pSelector )
+{
+    (void)pSelector;
+    object_dispose( pObject );
+}
+
+static Class c_ocoa_benchmark_allocate_root_class( const char* pClassName )
+{
+    Class pClass = objc_getClass( pClassName );
+    if( pClass != NULL )
+    {
+        //FK: Already registered
+        return pClass;
+    }
+
+    return objc_allocateClassPair( NULL, pClassName, 0u );
+}
+
+static Class c_ocoa_benchmark_register_dispatch_class( const char* pClassName )
+{
+    Class pClass = objc_getClass( pClassName );
+    if( pClass != NULL )
+    {
+        return pClass;
+    }
+
+    pClass = c_ocoa_benchmark_allocate_root_class( pClassName );
+    if( pClass == NULL )
+    {
+        return NULL;
+    }
+
+    class_addMethod( pClass, sel_registerName( "voidCall" ),            (IMP)c_ocoa_benchmark_void_call,            "v@:" );
+    class_addMethod( pClass, sel_registerName( "scalarCall:" ),         (IMP)c_ocoa_benchmark_scalar_call,          "i@:i" );
+    class_addMethod( pClass, sel_registerName( "floatCall:" ),          (IMP)c_ocoa_benchmark_float_call,           "d@:d" );
+    class_addMethod( pClass, sel_registerName( "smallStructCall" ),     (IMP)c_ocoa_benchmark_small_struct_call,    "{BenchSmallStruct=dd}@:" );
+    class_addMethod( pClass, sel_registerName( "largeStructCall" ),     (IMP)c_ocoa_benchmark_large_struct_call,    "{BenchLargeStruct=dddd}@:" );
+    objc_registerClassPair( pClass );
+
+    return pClass;
+}
+
+static Class c_ocoa_benchmark_register_collection_class( void )
+{
+    Class pClass = objc_getClass( C_OCOA_BENCHMARK_COLLECTION_CLASS_NAME );
+    if( pClass != NULL )
+    {
+        return pClass;
+    }
+
+    pClass = c_ocoa_benchmark_allocate_root_class( C_OCOA_BENCHMARK_COLLECTION_CLASS_NAME );
+    if( pClass == NULL )
+    {
+        return NULL;
+    }
+
+    class_addMethod( pClass, sel_registerName( "count" ),          (IMP)c_ocoa_benchmark_collection_count,                 "Q@:" );
+    class_addMethod( pClass, sel_registerName( "objectAtIndex:" ), (IMP)c_ocoa_benchmark_collection_object_at_index,       "@@:Q" );
+    class_addMethod( pClass, sel_registerName( "countByEnumeratingWithState:objects:count:" ), (IMP)c_ocoa_benchmark_collection_count_by_enumerating, "Q@:^{?=Q^@^Q[5Q]}^@Q" );
+    objc_registerClassPair( pClass );
+
+    return pClass;
+}
+
+static Class c_ocoa_benchmark_register_copying_collection_class( void )
+{
+    Class pClass = objc_getClass( C_OCOA_BENCHMARK_COPYING_COLLECTION_CLASS_NAME );
+    if( pClass != NULL )
+    {
+        return pClass;
+    }
+
+    pClass = c_ocoa_benchmark_allocate_root_class( C_OCOA_BENCHMARK_COPYING_COLLECTION_CLASS_NAME );
+    if( pClass == NULL )
+    {
+        return NULL;
+    }
+
+    class_addMethod( pClass, sel_registerName( "countByEnumeratingWithState:objects:count:" ), (IMP)c_ocoa_benchmark_copying_collection_count_by_enumerating, "Q@:^{?=Q^@^Q[5Q]}^@Q" );
+    objc_registerClassPair( pClass );
+
+    return pClass;
+}
+
+static Class c_ocoa_benchmark_register_autorelease_class( void )
+{
+    Class pClass = objc_getClass( C_OCOA_BENCHMARK_AUTORELEASE_CLASS_NAME );
+    if( pClass != NULL )
+    {
+        return pClass;
+    }
+
+    pClass = c_ocoa_benchmark_allocate_root_class( C_OCOA_BENCHMARK_AUTORELEASE_CLASS_NAME );
+    if( pClass == NULL )
+    {
+        return NULL;
+    }
+
+    class_addMethod( pClass, sel_registerName( "_ARCCompliantRetainRelease" ),  (IMP)c_ocoa_benchmark_arc_compliant,    "v@:" );
+    class_addMethod( pClass, sel_registerName( "dealloc" ),                     (IMP)c_ocoa_benchmark_dealloc,          "v@:" );
+    objc_registerClassPair( pClass );
+
+    return pClass;
+}
+
+static uint8_t c_ocoa_benchmark_register_delegate_protocol( void )
+{
+    if( objc_getProtocol( C_OCOA_BENCHMARK_DELEGATE_PROTOCOL_NAME ) != NULL )
+    {
+        return 1u;
+    }
+
+    Protocol* pProtocol = objc_allocateProtocol( C_OCOA_BENCHMARK_DELEGATE_PROTOCOL_NAME );
+    if( pProtocol == NULL )
+    {
+        return 0u;
+    }
+
+    for( uint32_t methodIndex = 0u; methodIndex < C_OCOA_BENCHMARK_DELEGATE_METHOD_COUNT; ++methodIndex )
+    {
+        const BOOL isRequired = methodIndex < C_OCOA_BENCHMARK_DELEGATE_REQUIRED_METHOD_COUNT;
+        protocol_addMethodDescription( pProtocol, sel_registerName( c_ocoa_benchmark_delegate_selector_names[ methodIndex ] ), c_ocoa_benchmark_delegate_type_encodings[ methodIndex ], isRequired, YES );
+    }
+
+    objc_registerProtocol( pProtocol );
+    return 1u;
+}
+
+static uint8_t c_ocoa_benchmark_create_instance( c_ocoa_benchmark_instance* pOutInstance, Class pClass )
+{
+    if( pClass == NULL )
+    {
+        return 0u;
+    }
+
+    pOutInstance->pClass  = pClass;
+    pOutInstance->pObject = class_createInstance( pClass, 0u );
+    return pOutInstance->pObject != NULL;
+}
+
+static uint8_t c_ocoa_benchmark_register_classes( c_ocoa_benchmark_classes* pOutClasses )
+{
+    if( !c_ocoa_benchmark_create_instance( &pOutClasses->defaultInstance, c_ocoa_benchmark_register_dispatch_class( C_OCOA_BENCHMARK_DEFAULT_CLASS_NAME ) ) ||
+        !c_ocoa_benchmark_create_instance( &pOutClasses->impCacheInstance, c_ocoa_benchmark_register_dispatch_class( C_OCOA_BENCHMARK_IMP_CACHE_CLASS_NAME ) ) ||
+        !c_ocoa_benchmark_create_instance( &pOutClasses->inlineInstance, c_ocoa_benchmark_register_dispatch_class( C_OCOA_BENCHMARK_INLINE_CLASS_NAME ) ) ||
+        !c_ocoa_benchmark_create_instance( &pOutClasses->collectionInstance, c_ocoa_benchmark_register_collection_class() ) ||
+        !c_ocoa_benchmark_create_instance( &pOutClasses->copyingCollectionInstance, c_ocoa_benchmark_register_copying_collection_class() ) ||
+        !c_ocoa_benchmark_create_instance( &pOutClasses->mainQueueInstance, c_ocoa_benchmark_register_dispatch_class( C_OCOA_BENCHMARK_MAIN_QUEUE_CLASS_NAME ) ) ||
+        !c_ocoa_benchmark_create_instance( &pOutClasses->autoreleaseInstance, c_ocoa_benchmark_register_autorelease_class() ) ||
+        !c_ocoa_benchmark_register_delegate_protocol() )
+    {
+        return 0u;
+    }
+
+    for( uint32_t itemIndex = 0u; itemIndex < C_OCOA_BENCHMARK_COLLECTION_SIZE; ++itemIndex )
+    {
+        c_ocoa_benchmark_collection_items[ itemIndex ] = pOutClasses->defaultInstance.pObject;
+    }
+
+    //FK: The first message initializes the class, which is when libobjc2 checks for '_ARCCompliantRetainRelease'
+    ((void (*)( id, SEL ))objc_msgSend)( pOutClasses->autoreleaseInstance.pObject, sel_registerName( "_ARCCompliantRetainRelease" ) );
+
+    return 1u;
+}
+
+#endif
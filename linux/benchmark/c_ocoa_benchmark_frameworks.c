@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include <objc/runtime.h>
+#include <objc/message.h>
+
+//FK: Generated by linux/build_benchmark.sh with '--lazy-frameworks', CocoaBenchLazy lives in a shared library
+//    that this executable doesn't link
+#include "c_ocoa_runtime.c"
+#include "c_ocoa_frameworks.c"
+#include "cocoabenchlazy.c"
+
+#define C_OCOA_BENCHMARK_LAZY_VALUE 42  //FK: see c_ocoa_benchmark_lazy_class.m
+
+int main( void )
+{
+    printf( "Before the first call:\n" );
+    c_ocoa_frameworks_report( stdout );
+
+    const int lazyValue = cocoabenchlazy_lazyValue();
+
+    printf( "\nAfter the first call:\n" );
+    c_ocoa_frameworks_report( stdout );
+
+    if( lazyValue != C_OCOA_BENCHMARK_LAZY_VALUE )
+    {
+        fprintf( stderr, "[error] Lazily loaded class returned %d instead of %d.\n", lazyValue, C_OCOA_BENCHMARK_LAZY_VALUE );
+        return 1;
+    }
+
+    return 0;
+}
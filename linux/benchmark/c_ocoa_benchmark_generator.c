@@ -0,0 +1,24 @@
+#include "../../c_ocoa_generator.h"
+#include "c_ocoa_benchmark_classes.h"
+
+//FK: Same as the regular generator but registers the synthetic benchmark classes first
+int main(int argc, const char** argv)
+{
+    c_ocoa_benchmark_classes benchmarkClasses;
+    if( !c_ocoa_benchmark_register_classes( &benchmarkClasses ) )
+    {
+        printf_stderr( "[error] Couldn't register benchmark classes.\n" );
+        return 1;
+    }
+
+    c_ocoa_code_generator_parameter parameters = c_ocoa_default_code_generator_parameter();
+    evaluate_code_generator_argv_arguments(argc, argv, &parameters);
+
+    c_ocoa_code_gen_context context;
+    if( !c_ocoa_create_code_gen_context( &context ) )
+    {
+        return 2;
+    }
+    
+    return c_ocoa_create_classes_api( &parameters, &context );
+}
@@ -0,0 +1,18 @@
+//FK: Compiled into its own shared library by linux/build_benchmark.sh. The benchmark doesn't link it,
+//    the wrappers generated with '--lazy-frameworks' dlopen() it on first use.
+//    Classes registered at runtime (see c_ocoa_benchmark_classes.h) aren't part of any image, so this
+//    class has to be compiled.
+__attribute__((objc_root_class))
+@interface CocoaBenchLazy
+{
+    id isa;
+}
++ (int)lazyValue;
+@end
+
+@implementation CocoaBenchLazy
++ (int)lazyValue
+{
+    return 42;
+}
+@end
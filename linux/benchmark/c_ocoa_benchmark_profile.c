@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <objc/runtime.h>
+#include <objc/message.h>
+
+#include "c_ocoa_benchmark_classes.h"
+
+//FK: Generated by linux/build_benchmark.sh, this file gets compiled with C_OCOA_PROFILE defined
+#include "c_ocoa_runtime.c"
+#include "cocoabenchdefault.c"
+
+#ifndef C_OCOA_PROFILE
+#error "c_ocoa_benchmark_profile.c has to be compiled with C_OCOA_PROFILE defined"
+#endif
+
+#define C_OCOA_BENCHMARK_PROFILE_DEFAULT_CALL_COUNT 100000u //FK: per thread
+#define C_OCOA_BENCHMARK_PROFILE_THREAD_COUNT       4u
+#define C_OCOA_BENCHMARK_PROFILE_WRAPPER_NAME       "cocoabenchdefault_voidCall"
+
+typedef struct
+{
+    id          pObject;
+    uint64_t    callCount;
+} c_ocoa_benchmark_profile_thread_input;
+
+static void* c_ocoa_benchmark_profile_thread( void* pArgument )
+{
+    const c_ocoa_benchmark_profile_thread_input* pInput = (const c_ocoa_benchmark_profile_thread_input*)pArgument;
+    for( uint64_t callIndex = 0u; callIndex < pInput->callCount; ++callIndex )
+    {
+        cocoabenchdefault_voidCall( pInput->pObject );
+    }
+
+    return NULL;
+}
+
+//FK: Looks up the call count of a wrapper in the JSON written by c_ocoa_profile_dump()
+static uint8_t c_ocoa_benchmark_profile_find_call_count( const char* pJson, const char* pWrapperName, uint64_t* pOutCallCount )
+{
+    char namePattern[ 256 ];
+    snprintf( namePattern, sizeof( namePattern ), "\"name\": \"%s\", \"calls\": ", pWrapperName );
+
+    const char* pEntry = strstr( pJson, namePattern );
+    if( pEntry == NULL )
+    {
+        return 0u;
+    }
+
+    *pOutCallCount = strtoull( pEntry + strlen( namePattern ), NULL, 10 );
+    return 1u;
+}
+
+static void print_benchmark_profile_help( void )
+{
+    printf( "Checks the C_OCOA_PROFILE call counts of a wrapper that gets called from %u threads.\n", C_OCOA_BENCHMARK_PROFILE_THREAD_COUNT );
+    printf( "Usage: c_ocoa_benchmark_profile [-n <calls per thread>]\n" );
+}
+
+int main(int argc, const char** argv)
+{
+    uint64_t callCount = C_OCOA_BENCHMARK_PROFILE_DEFAULT_CALL_COUNT;
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc )
+        {
+            callCount = strtoull( argv[i+1], NULL, 10 );
+            ++i;
+        }
+        else
+        {
+            print_benchmark_profile_help();
+            return argv[i][0] == '-' && argv[i][1] == 'h' ? 0 : 1;
+        }
+    }
+
+    //FK: The counts get checked below, no need for the dump at exit
+    setenv( "C_OCOA_PROFILE_OUTPUT", "/dev/null", 0 );
+
+    c_ocoa_benchmark_classes classes;
+    if( !c_ocoa_benchmark_register_classes( &classes ) )
+    {
+        fprintf( stderr, "[error] Couldn't register benchmark classes.\n" );
+        return 1;
+    }
+
+    //FK: One call from the main thread so that the site gets registered before the threads race for it
+    cocoabenchdefault_voidCall( classes.defaultInstance.pObject );
+
+    c_ocoa_benchmark_profile_thread_input input = { classes.defaultInstance.pObject, callCount };
+    pthread_t threads[ C_OCOA_BENCHMARK_PROFILE_THREAD_COUNT ];
+    for( uint32_t threadIndex = 0u; threadIndex < C_OCOA_BENCHMARK_PROFILE_THREAD_COUNT; ++threadIndex )
+    {
+        if( pthread_create( &threads[ threadIndex ], NULL, c_ocoa_benchmark_profile_thread, &input ) != 0 )
+        {
+            fprintf( stderr, "[error] Couldn't create profile thread.\n" );
+            return 1;
+        }
+    }
+
+    for( uint32_t threadIndex = 0u; threadIndex < C_OCOA_BENCHMARK_PROFILE_THREAD_COUNT; ++threadIndex )
+    {
+        pthread_join( threads[ threadIndex ], NULL );
+    }
+
+    char* pJson = NULL;
+    size_t jsonSize = 0u;
+    FILE* pJsonFile = open_memstream( &pJson, &jsonSize );
+    if( pJsonFile == NULL )
+    {
+        fprintf( stderr, "[error] Couldn't open memory stream.\n" );
+        return 1;
+    }
+
+    c_ocoa_profile_dump( pJsonFile, C_OCOA_PROFILE_FORMAT_JSON );
+    fclose( pJsonFile );
+
+    uint64_t countedCallCount = 0u;
+    const uint8_t foundWrapper = c_ocoa_benchmark_profile_find_call_count( pJson, C_OCOA_BENCHMARK_PROFILE_WRAPPER_NAME, &countedCallCount );
+    free( pJson );
+
+    const uint64_t expectedCallCount = callCount * C_OCOA_BENCHMARK_PROFILE_THREAD_COUNT + 1u;
+    printf( "%s: %llu counted calls, %llu expected (%u threads x %llu calls + 1)\n", C_OCOA_BENCHMARK_PROFILE_WRAPPER_NAME,
+        (unsigned long long)countedCallCount, (unsigned long long)expectedCallCount, C_OCOA_BENCHMARK_PROFILE_THREAD_COUNT, (unsigned long long)callCount );
+
+    if( !foundWrapper || countedCallCount != expectedCallCount )
+    {
+        fprintf( stderr, "[error] Profile call count mismatch.\n" );
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+#!/bin/bash
+# Builds and runs the wrapper dispatch benchmark against GNUstep libobjc2.
+# Usage: build_benchmark.sh [release|debug] [benchmark arguments...]
+
+ScriptDirectory="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
+BuildConfig=$1
+shift
+
+if [ -z ${BuildConfig} ] 
+then 	
+		echo "Missing argument, assuming release build"
+		BuildConfig=release
+fi
+
+InvalidBuildConfig=1
+if [ "${BuildConfig}" == "release" -o "${BuildConfig}" == "debug" ]
+then
+	InvalidBuildConfig=0
+fi
+
+if [ ${InvalidBuildConfig} == 1 ] 
+then
+	echo "Invalid build config '${BuildConfig}'. Assuming release build"
+	BuildConfig=release
+fi
+
+BuildFolder="${ScriptDirectory}/build_${BuildConfig}"
+GeneratedFolder="${BuildFolder}/generated_files"
+if [ ! -d "${GeneratedFolder}" ] 
+then
+	mkdir -p "${GeneratedFolder}"
+fi
+
+# The '--lazy-frameworks' run gets its own folder since c_ocoa_types.h only contains the structs of the current run
+LazyGeneratedFolder="${BuildFolder}/generated_files_lazy"
+if [ ! -d "${LazyGeneratedFolder}" ] 
+then
+	mkdir -p "${LazyGeneratedFolder}"
+fi
+
+Compiler="${CC:-clang}"
+# Set C_OCOA_BENCHMARK_LIBRARIES=-lgnustep-base to compare the main thread queue against performSelectorOnMainThread:
+Libraries="-lobjc -lpthread ${C_OCOA_BENCHMARK_LIBRARIES}"
+Revision="$( git -C "${ScriptDirectory}" describe --always --dirty 2> /dev/null || echo unknown )"
+
+CompilerOptions="-fstrict-aliasing ${Libraries}"
+if [ "${BuildConfig}" == "release" ] 
+then
+	echo "Build config = release"
+	CompilerOptions="${CompilerOptions} -O3"
+fi
+
+if [ "${BuildConfig}" == "debug" ] 
+then
+	echo "Build config = debug"
+	CompilerOptions="${CompilerOptions} -g"
+fi
+
+GeneratorOutputFile="${BuildFolder}/c_ocoa_benchmark_generator"
+BenchmarkOutputFile="${BuildFolder}/c_ocoa_benchmark"
+ProfileOutputFile="${BuildFolder}/c_ocoa_benchmark_profile"
+ClassApiOutputFile="${BuildFolder}/c_ocoa_benchmark_class_api"
+FrameworksOutputFile="${BuildFolder}/c_ocoa_benchmark_frameworks"
+LazyLibraryFile="${BuildFolder}/libcocoabenchlazy.so"
+
+${Compiler} "${ScriptDirectory}/benchmark/c_ocoa_benchmark_generator.c" -o "${GeneratorOutputFile}" ${CompilerOptions} || exit 1
+
+# c_ocoa_types.h gets written to the working directory and only contains the structs of the current run,
+# so the collection class (no structs) has to be generated first.
+cd "${GeneratedFolder}" || exit 1
+"${GeneratorOutputFile}" -t CocoaBenchCollection || exit 1
+"${GeneratorOutputFile}" -t CocoaBenchDefault || exit 1
+"${GeneratorOutputFile}" -t -i -b CocoaBenchImpCache || exit 1
+"${GeneratorOutputFile}" -t --header-only CocoaBenchInline || exit 1
+# The delegate protocol uses the same structs as the dispatch classes
+"${GeneratorOutputFile}" -t --on-main --protocols CocoaBenchDelegate CocoaBenchMainQueue || exit 1
+cd - > /dev/null
+
+# CocoaBenchLazy has to be compiled (classes registered at runtime aren't part of any image), the generator sees it
+# via LD_PRELOAD and the frameworks benchmark dlopen()s it on first use
+${Compiler} "${ScriptDirectory}/benchmark/c_ocoa_benchmark_lazy_class.m" -o "${LazyLibraryFile}" -shared -fPIC -fobjc-runtime=gnustep-2.0 -lobjc || exit 1
+cd "${LazyGeneratedFolder}" || exit 1
+LD_PRELOAD="${LazyLibraryFile}" "${GeneratorOutputFile}" -t --lazy-frameworks CocoaBenchLazy || exit 1
+cd - > /dev/null
+
+${Compiler} "${ScriptDirectory}/benchmark/c_ocoa_benchmark.c" -o "${BenchmarkOutputFile}" -I"${GeneratedFolder}" -DC_OCOA_BENCHMARK_REVISION="\"${Revision}\"" ${CompilerOptions} || exit 1
+
+# Checks that C_OCOA_PROFILE counts every call of a wrapper that gets called from several threads
+${Compiler} "${ScriptDirectory}/benchmark/c_ocoa_benchmark_profile.c" -o "${ProfileOutputFile}" -I"${GeneratedFolder}" -DC_OCOA_PROFILE ${CompilerOptions} || exit 1
+"${ProfileOutputFile}" || exit 1
+
+# Counts the allocations per class that gets defined via c_ocoa_class_api.c (definition, definition in arena, c_ocoa_define_class)
+${Compiler} "${ScriptDirectory}/benchmark/c_ocoa_benchmark_class_api.c" -o "${ClassApiOutputFile}" -I"${ScriptDirectory}/.." ${CompilerOptions} || exit 1
+"${ClassApiOutputFile}" || exit 1
+
+# Prints c_ocoa_frameworks_report() before and after the first call into the lazily loaded library
+${Compiler} "${ScriptDirectory}/benchmark/c_ocoa_benchmark_frameworks.c" -o "${FrameworksOutputFile}" -I"${LazyGeneratedFolder}" ${CompilerOptions} -ldl || exit 1
+"${FrameworksOutputFile}" || exit 1
+
+"${BenchmarkOutputFile}" "$@"
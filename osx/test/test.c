@@ -5,6 +5,7 @@
 #include <objc/message.h>
 #include <objc/NSObjCRuntime.h>
 
+#include "../generated_files/c_ocoa_runtime.c"
 #include "../generated_files/nsapplication.c"
 #include "../generated_files/nswindow.c"
 #include "../generated_files/nscolor.c"
@@ -146,17 +147,27 @@ int main(int argc, char** argv)
     nsopenglcontext_makeCurrentContext( openglContextDefault );
     nsapplication_setPresentationOptions( nsapp, (1<<10) );
 
+    //FK: Selectors, the distant past date and the event buffer are set up once instead of per frame
+    c_ocoa_event_pump_t eventPump;
+    if( !c_ocoa_event_pump_create( &eventPump, nsapp, NSDefaultRunLoopMode ) )
+    {
+        return -1;
+    }
+
+    c_ocoa_event_t events[ 256 ];
     while( !terminated )
     {
-        
-        //id distantPast = ((id (*)(Class, SEL))objc_msgSend)(NSDateClass, distantPastSel);
-        id distantPast = nsdate_distantPast();
-        nsobject_t event;
-        while( ( event = nsapplication_nextEventMatchingMask( nsapp, (~0), distantPast, NSDefaultRunLoopMode, YES ) ) != NULL )
+        //FK: Drain everything that got autoreleased during this frame (events, distantPast, strings, ...)
+        void* pFramePool = c_ocoa_autoreleasepool_push();
+
+        //FK: Dequeues, decodes and forwards all pending events to sendEvent:. Unlike the old loop the events below are
+        //    handled after AppKit has already processed them (eg: the window has already been resized)
+        const size_t eventCount = c_ocoa_event_pump_drain( &eventPump, events, sizeof( events ) / sizeof( events[ 0 ] ) );
+        for( size_t eventIndex = 0u; eventIndex < eventCount; ++eventIndex )
         {
-            unsigned int eventType = nsevent_type( event );
+            const c_ocoa_event_t* pEvent = events + eventIndex;
 
-			switch(eventType)
+			switch(pEvent->type)
 			{
 				//case NSMouseMoved:
 				//case NSLeftMouseDragged:
@@ -213,9 +224,9 @@ int main(int argc, char** argv)
 				//case NSScrollWheel:
 				case 22:
 				{
-					float delta_x = nsevent_scrollingDeltaX( event );
-					float delta_y = nsevent_scrollingDeltaY( event );
-					char precision_scrolling = nsevent_hasPreciseScrollingDeltas( event );
+					float delta_x = (float)pEvent->deltaX;
+					float delta_y = (float)pEvent->deltaY;
+					char precision_scrolling = pEvent->hasPreciseScrollingDeltas;
 					if(precision_scrolling)
 					{
 						delta_x *= 0.1f; // similar to glfw
@@ -240,9 +251,10 @@ int main(int argc, char** argv)
 				case 10:
 				{
                     uint pos = 0;
-                    nsobject_t inputText = nsevent_characters( event );
-                    const char * inputTextUTF8 = nsstring_UTF8String( inputText );
-                    uint16_t keyCode = nsevent_keyCode( event );
+
+                    //FK: The event pump already copied the characters into the event
+                    const char* inputTextUTF8 = pEvent->characters;
+                    uint16_t keyCode = pEvent->keyCode;
 
                     #if 0
 					if((last_modifyer_keys & 16) && (last_modifyer_keys & 2) && keyCode == BETRAY_BUTTON_Z)
@@ -269,10 +281,7 @@ int main(int argc, char** argv)
 				//case NSKeyUp:
 				case 11:
 				{
-                    uint pos = 0;
-                    nsobject_t inputText = nsevent_characters( event );
-                    const char * inputTextUTF8 = nsstring_UTF8String( inputText );
-                    uint16_t keyCode = nsevent_keyCode( event );
+                    uint16_t keyCode = pEvent->keyCode;
                     printf("key up %u\n", keyCode);
 					break;
 				}
@@ -280,8 +289,6 @@ int main(int argc, char** argv)
 					break;
             }
 
-            nsapplication_sendEvent( nsapp, event );
-
         #if 0
 			// if user closes the window we might need to terminate asap
 			if(terminated)
@@ -289,7 +296,10 @@ int main(int argc, char** argv)
         #endif
 
 		}
+
+        c_ocoa_autoreleasepool_pop( pFramePool );
     }
 
+    c_ocoa_event_pump_destroy( &eventPump );
     return 0;
 }
\ No newline at end of file